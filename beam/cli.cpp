@@ -250,7 +250,14 @@ private:
 			s.m_Done >>= 1;
 		}
 		int p = static_cast<int>((s.m_Done * 100) / s.m_Total);
-		BEAM_LOG_INFO() << "Updating node: " << p << "% (" << s.m_Done << "/" << s.m_Total << ")";
+
+		std::ostringstream os;
+		if (s.m_HdrsPerSec)
+			os << ", " << s.m_HdrsPerSec << " hdrs/s";
+		if (s.m_BlocksPerSec)
+			os << ", " << s.m_BlocksPerSec << " blocks/s, " << (s.m_BytesPerSec / 1024) << " KB/s";
+
+		BEAM_LOG_INFO() << "Updating node: " << p << "% (" << s.m_Done << "/" << s.m_Total << ")" << os.str();
 	}
 
 	Node* m_pNode;
@@ -404,6 +411,7 @@ int main(int argc, char* argv[])
 					}
 
 					node.m_Cfg.m_VerificationThreads = vm[cli::VERIFICATION_THREADS].as<int>();
+					node.m_Cfg.m_IoThreads = vm[cli::IO_THREADS].as<uint32_t>();
 
 					node.m_Cfg.m_LogEvents = vm[cli::LOG_UTXOS].as<bool>();
 
@@ -531,6 +539,9 @@ int main(int argc, char* argv[])
 					if (vm.count(cli::VACUUM))
 						node.m_Cfg.m_ProcessorParams.m_Vacuum = vm[cli::VACUUM].as<bool>();
 
+					if (vm.count(cli::BODY_ARCHIVE))
+						node.m_Cfg.m_ProcessorParams.m_ArchiveSegment = static_cast<uint64_t>(vm[cli::BODY_ARCHIVE].as<uint32_t>()) << 20;
+
 					if (vm.count(cli::RESET_ID))
 						node.m_Cfg.m_ProcessorParams.m_ResetSelfID = vm[cli::RESET_ID].as<bool>();
 
@@ -625,6 +636,7 @@ int main(int argc, char* argv[])
 					{
 						node.m_Cfg.m_Recovery.m_sPathOutput = vm[cli::RECOVERY_AUTO_PATH].as<string>();
 						node.m_Cfg.m_Recovery.m_Granularity = vm[cli::RECOVERY_AUTO_PERIOD].as<uint32_t>();
+						node.m_Cfg.m_Recovery.m_Deltas = vm[cli::RECOVERY_AUTO_DELTAS].as<uint32_t>();
 					}
 
 					io::Timer::Ptr pCrashTimer;
@@ -108,12 +108,109 @@ namespace bvm2 {
 			}
 		};
 
-		struct Vars
+		struct Recording
+		{
+			ReadCache::Key m_Key;
+			beam::Merkle::Hash m_hvTip;
+			ReadCache::Items m_Items;
+			size_t m_Size = 0;
+		};
+
+		struct Recorder
 			:public Handler
-			,public IReadVars
 		{
 			using Handler::Handler;
 
+			std::unique_ptr<Recording> m_pRec;
+
+			void Record(const Blob& key, const Blob& val, const HeightPos& pos)
+			{
+				if (!m_pRec)
+					return;
+
+				auto& x = m_pRec->m_Items.emplace_back();
+				key.Export(x.m_Key);
+				val.Export(x.m_Val);
+				x.m_Pos = pos;
+
+				m_pRec->m_Size += ReadCache::get_Size(x);
+				if (m_pRec->m_Size > m_This.m_pReadCache->m_MaxBytes)
+					m_pRec.reset(); // too large, don't cache
+			}
+
+			void OnEnd()
+			{
+				if (m_pRec)
+				{
+					m_This.m_pReadCache->Save(m_pRec->m_Key, m_pRec->m_hvTip, std::move(m_pRec->m_Items), *m_This.m_pHist);
+					m_pRec.reset();
+				}
+			}
+		};
+
+		static bool CacheLookup(ManagerStd& x, const ReadCache::Key& key, ReadCache::ItemsPtr& pItems, std::unique_ptr<Recording>& pRec)
+		{
+			if (!x.m_pReadCache || !x.m_pHist || x.m_Context.m_pParent)
+				return false;
+
+			beam::Merkle::Hash hvTip;
+			pItems = x.m_pReadCache->Find(key, *x.m_pHist, hvTip);
+			if (pItems)
+				return true;
+
+			if (hvTip != Zero)
+			{
+				pRec = std::make_unique<Recording>();
+				pRec->m_Key = key;
+				pRec->m_hvTip = hvTip;
+			}
+
+			return false;
+		}
+
+		struct CachedVars
+			:public IReadVars
+		{
+			ReadCache::ItemsPtr m_pItems;
+			size_t m_iPos = 0;
+
+			bool MoveNext() override
+			{
+				if (m_iPos >= m_pItems->size())
+					return false;
+
+				const auto& x = (*m_pItems)[m_iPos++];
+				m_LastKey = x.m_Key;
+				m_LastVal = x.m_Val;
+				return true;
+			}
+		};
+
+		struct CachedLogs
+			:public IReadLogs
+		{
+			ReadCache::ItemsPtr m_pItems;
+			size_t m_iPos = 0;
+
+			bool MoveNext() override
+			{
+				if (m_iPos >= m_pItems->size())
+					return false;
+
+				const auto& x = (*m_pItems)[m_iPos++];
+				m_LastKey = x.m_Key;
+				m_LastVal = x.m_Val;
+				m_LastPos = x.m_Pos;
+				return true;
+			}
+		};
+
+		struct Vars
+			:public Recorder
+			,public IReadVars
+		{
+			using Recorder::Recorder;
+
 			size_t m_Consumed = 0;
 			ByteBuffer m_Buf;
 
@@ -128,7 +225,10 @@ namespace bvm2 {
 						return false;
 
 					if (r.m_Res.m_Result.empty())
+					{
+						OnEnd();
 						return false;
+					}
 
 					m_Consumed = 0;
 					m_Buf = std::move(r.m_Res.m_Result);
@@ -155,6 +255,8 @@ namespace bvm2 {
 				m_LastVal.p = pBuf + m_Consumed;
 				m_Consumed += m_LastVal.n;
 
+				Record(m_LastKey, m_LastVal, HeightPos());
+
 				if ((m_Consumed == m_Buf.size()) && r.m_Res.m_bMore)
 				{
 					r.m_Res.m_bMore = false;
@@ -172,10 +274,10 @@ namespace bvm2 {
 
 
 		struct Logs
-			:public Handler
+			:public Recorder
 			,public IReadLogs
 		{
-			using Handler::Handler;
+			using Recorder::Recorder;
 
 			size_t m_Consumed = 0;
 			ByteBuffer m_Buf;
@@ -190,7 +292,10 @@ namespace bvm2 {
 					if (!CheckDone())
 						return false;
 					if (r.m_Res.m_Result.empty())
+					{
+						OnEnd();
 						return false;
+					}
 
 					m_Consumed = 0;
 					m_Buf = std::move(r.m_Res.m_Result);
@@ -210,6 +315,7 @@ namespace bvm2 {
 				m_LastPos = clr.m_Pos;
 
 				m_Consumed = m_Buf.size() - clr.m_Inp.n;
+				Record(m_LastKey, m_LastVal, m_LastPos);
 
 				if ((m_Consumed == m_Buf.size()) && r.m_Res.m_bMore)
 				{
@@ -284,13 +390,29 @@ namespace bvm2 {
 
 	void ManagerStd::VarsEnum(const Blob& kMin, const Blob& kMax, IReadVars::Ptr& pOut)
 	{
+		ReadCache::Key key;
+		key.m_Logs = false;
+		kMin.Export(key.m_KeyMin);
+		kMax.Export(key.m_KeyMax);
+
+		ReadCache::ItemsPtr pItems;
+		std::unique_ptr<RemoteRead::Recording> pRec;
+		if (RemoteRead::CacheLookup(*this, key, pItems, pRec))
+		{
+			auto p = std::make_unique<RemoteRead::CachedVars>();
+			p->m_pItems = std::move(pItems);
+			pOut = std::move(p);
+			return;
+		}
+
 		auto p = std::make_unique<RemoteRead::Vars>(*this);
+		p->m_pRec = std::move(pRec);
 
 		boost::intrusive_ptr<proto::FlyClient::RequestContractVars> pReq(new proto::FlyClient::RequestContractVars);
 		auto& r = *pReq;
 
-		kMin.Export(r.m_Msg.m_KeyMin);
-		kMax.Export(r.m_Msg.m_KeyMax);
+		r.m_Msg.m_KeyMin = std::move(key.m_KeyMin);
+		r.m_Msg.m_KeyMax = std::move(key.m_KeyMax);
 
 		SetParentContext(r.m_pCtx);
 		p->m_pRequest = std::move(pReq);
@@ -301,21 +423,39 @@ namespace bvm2 {
 
 	void ManagerStd::LogsEnum(const Blob& kMin, const Blob& kMax, const HeightPos* pPosMin, const HeightPos* pPosMax, IReadLogs::Ptr& pOut)
 	{
-		auto p = std::make_unique<RemoteRead::Logs>(*this);
-
-		boost::intrusive_ptr<proto::FlyClient::RequestContractLogs> pReq(new proto::FlyClient::RequestContractLogs);
-		auto& r = *pReq;
-
-		kMin.Export(r.m_Msg.m_KeyMin);
-		kMax.Export(r.m_Msg.m_KeyMax);
+		ReadCache::Key key;
+		key.m_Logs = true;
+		kMin.Export(key.m_KeyMin);
+		kMax.Export(key.m_KeyMax);
 
 		if (pPosMin)
-			r.m_Msg.m_PosMin = *pPosMin;
+			key.m_PosMin = *pPosMin;
 
 		if (pPosMax)
-			r.m_Msg.m_PosMax = *pPosMax;
+			key.m_PosMax = *pPosMax;
 		else
-			r.m_Msg.m_PosMax.m_Height = MaxHeight;
+			key.m_PosMax.m_Height = MaxHeight;
+
+		ReadCache::ItemsPtr pItems;
+		std::unique_ptr<RemoteRead::Recording> pRec;
+		if (RemoteRead::CacheLookup(*this, key, pItems, pRec))
+		{
+			auto p = std::make_unique<RemoteRead::CachedLogs>();
+			p->m_pItems = std::move(pItems);
+			pOut = std::move(p);
+			return;
+		}
+
+		auto p = std::make_unique<RemoteRead::Logs>(*this);
+		p->m_pRec = std::move(pRec);
+
+		boost::intrusive_ptr<proto::FlyClient::RequestContractLogs> pReq(new proto::FlyClient::RequestContractLogs);
+		auto& r = *pReq;
+
+		r.m_Msg.m_KeyMin = std::move(key.m_KeyMin);
+		r.m_Msg.m_KeyMax = std::move(key.m_KeyMax);
+		r.m_Msg.m_PosMin = key.m_PosMin;
+		r.m_Msg.m_PosMax = key.m_PosMax;
 
 		SetParentContext(r.m_pCtx);
 		p->m_pRequest = std::move(pReq);
@@ -606,5 +746,159 @@ namespace bvm2 {
 		return false;
 	}
 
+	/////////////////////////////
+	// ReadCache
+	bool ManagerStd::ReadCache::Key::operator < (const Key& x) const
+	{
+		if (m_Logs != x.m_Logs)
+			return m_Logs < x.m_Logs;
+		if (m_KeyMin != x.m_KeyMin)
+			return m_KeyMin < x.m_KeyMin;
+		if (m_KeyMax != x.m_KeyMax)
+			return m_KeyMax < x.m_KeyMax;
+		if (m_PosMin != x.m_PosMin)
+			return m_PosMin < x.m_PosMin;
+		return m_PosMax < x.m_PosMax;
+	}
+
+	uint32_t ManagerStd::ReadCache::Stats::get_HitRate_pc() const
+	{
+		uint64_t nTotal = m_Hits + m_Misses;
+		return nTotal ? static_cast<uint32_t>(m_Hits * 100 / nTotal) : 0;
+	}
+
+	size_t ManagerStd::ReadCache::get_Size(const Item& x)
+	{
+		return sizeof(x) + x.m_Key.size() + x.m_Val.size();
+	}
+
+	ManagerStd::ReadCache& ManagerStd::ReadCache::get_Global()
+	{
+		static ReadCache s_Cache;
+		return s_Cache;
+	}
+
+	void ManagerStd::ReadCache::DeleteRaw(std::map<Key, Entry>::iterator it)
+	{
+		assert(m_Stats.m_Bytes >= it->second.m_Size);
+		m_Stats.m_Bytes -= it->second.m_Size;
+		m_Map.erase(it);
+	}
+
+	bool ManagerStd::ReadCache::OnTipRaw(Block::SystemState::IHistory& hist)
+	{
+		Block::SystemState::Full s;
+		if (!hist.get_Tip(s))
+		{
+			m_Map.clear();
+			m_Stats.m_Bytes = 0;
+			m_hvTip = Zero;
+			return false;
+		}
+
+		beam::Merkle::Hash hv;
+		s.get_Hash(hv);
+		if (hv == m_hvTip)
+			return true;
+
+		// logs up to the old tip are still valid if it's still in the active branch
+		bool bExtended = false;
+		if ((m_hvTip != Zero) && (m_hTip <= s.get_Height()))
+		{
+			Block::SystemState::Full sOld;
+			if (hist.get_At(sOld, m_hTip))
+			{
+				beam::Merkle::Hash hvOld;
+				sOld.get_Hash(hvOld);
+				bExtended = (hvOld == m_hvTip);
+			}
+		}
+
+		for (auto it = m_Map.begin(); m_Map.end() != it; )
+		{
+			auto itThis = it++;
+			const Key& key = itThis->first;
+
+			if (!bExtended || !key.m_Logs || (key.m_PosMax.m_Height > m_hTip))
+				DeleteRaw(itThis);
+		}
+
+		m_hTip = s.get_Height();
+		m_hvTip = hv;
+		return true;
+	}
+
+	ManagerStd::ReadCache::ItemsPtr ManagerStd::ReadCache::Find(const Key& key, Block::SystemState::IHistory& hist, beam::Merkle::Hash& hvTip)
+	{
+		std::unique_lock<std::mutex> scope(m_Mutex);
+
+		if (!OnTipRaw(hist))
+		{
+			hvTip = Zero;
+			return nullptr;
+		}
+
+		hvTip = m_hvTip;
+
+		auto it = m_Map.find(key);
+		if (m_Map.end() == it)
+		{
+			m_Stats.m_Misses++;
+			return nullptr;
+		}
+
+		m_Stats.m_Hits++;
+		return it->second.m_pItems;
+	}
+
+	void ManagerStd::ReadCache::Save(const Key& key, const beam::Merkle::Hash& hvTip, Items&& vItems, Block::SystemState::IHistory& hist)
+	{
+		size_t nSize = sizeof(key) + key.m_KeyMin.size() + key.m_KeyMax.size();
+		for (const auto& x : vItems)
+			nSize += get_Size(x);
+
+		if (nSize > m_MaxBytes)
+			return;
+
+		std::unique_lock<std::mutex> scope(m_Mutex);
+
+		if (!OnTipRaw(hist) || (hvTip != m_hvTip))
+			return; // tip changed meanwhile, the result may be inconsistent
+
+		if (m_Stats.m_Bytes + nSize > m_MaxBytes)
+		{
+			// simple policy: entries are short-lived anyway (vars are dropped every block)
+			m_Map.clear();
+			m_Stats.m_Bytes = 0;
+		}
+
+		auto it = m_Map.find(key);
+		if (m_Map.end() != it)
+			DeleteRaw(it);
+
+		auto& e = m_Map[key];
+		e.m_pItems = std::make_shared<const Items>(std::move(vItems));
+		e.m_Size = nSize;
+		m_Stats.m_Bytes += nSize;
+	}
+
+	ManagerStd::ReadCache::Stats ManagerStd::ReadCache::get_Stats()
+	{
+		std::unique_lock<std::mutex> scope(m_Mutex);
+
+		Stats ret = m_Stats;
+		ret.m_Entries = m_Map.size();
+		return ret;
+	}
+
+	void ManagerStd::ReadCache::Clear()
+	{
+		std::unique_lock<std::mutex> scope(m_Mutex);
+
+		m_Map.clear();
+		m_Stats = Stats();
+		m_hvTip = Zero;
+	}
+
 } // namespace bvm2
 } // namespace beam
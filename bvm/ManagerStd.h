@@ -16,6 +16,7 @@
 #include "bvm2.h"
 #include "../core/fly_client.h"
 #include "invoke_data.h"
+#include <mutex>
 
 namespace beam::bvm2 {
 	class ManagerStd
@@ -79,11 +80,78 @@ namespace beam::bvm2 {
 
 	public:
 
+		// Results of contract vars/logs enumerations, shared between managers. Valid for the current tip only.
+		// On tip change vars are dropped, logs bounded by the old tip are retained if the chain was extended.
+		class ReadCache
+		{
+		public:
+
+			struct Key
+			{
+				bool m_Logs;
+				ByteBuffer m_KeyMin;
+				ByteBuffer m_KeyMax;
+				HeightPos m_PosMin;
+				HeightPos m_PosMax;
+
+				bool operator < (const Key&) const;
+			};
+
+			struct Item
+			{
+				ByteBuffer m_Key;
+				ByteBuffer m_Val;
+				HeightPos m_Pos;
+			};
+
+			typedef std::vector<Item> Items;
+			typedef std::shared_ptr<const Items> ItemsPtr;
+
+			struct Stats
+			{
+				uint64_t m_Hits = 0;
+				uint64_t m_Misses = 0;
+				size_t m_Entries = 0;
+				size_t m_Bytes = 0;
+
+				uint32_t get_HitRate_pc() const;
+			};
+
+			size_t m_MaxBytes = 0x1000000;
+
+			static ReadCache& get_Global();
+
+			ItemsPtr Find(const Key&, Block::SystemState::IHistory&, beam::Merkle::Hash& hvTip);
+			void Save(const Key&, const beam::Merkle::Hash& hvTip, Items&&, Block::SystemState::IHistory&);
+			Stats get_Stats();
+			void Clear();
+
+			static size_t get_Size(const Item&);
+
+		private:
+
+			struct Entry
+			{
+				ItemsPtr m_pItems;
+				size_t m_Size;
+			};
+
+			std::mutex m_Mutex;
+			std::map<Key, Entry> m_Map;
+			Height m_hTip = 0;
+			beam::Merkle::Hash m_hvTip = Zero;
+			Stats m_Stats;
+
+			bool OnTipRaw(Block::SystemState::IHistory&); // returns false if no tip
+			void DeleteRaw(std::map<Key, Entry>::iterator);
+		};
+
 		ManagerStd();
 
 		// Params
 		proto::FlyClient::INetwork::Ptr m_pNetwork; // required for 'view' operations
 		Block::SystemState::IHistory* m_pHist = nullptr;
+		ReadCache* m_pReadCache = nullptr; // optional, used for non-dependent contexts
 		bool m_EnforceDependent = false;
 
 		ByteBuffer m_BodyManager; // always required
@@ -3922,6 +3922,16 @@ namespace bvm2 {
 		} cp(*this);
 
 		std::vector<ECC::Point::Native> vPts;
+		ECC::Hash::Value hv;
+		PrepareSigs(vPts, hv, pt);
+
+		Exc::Test(IsSigValid(vPts, hv, sig));
+	}
+
+	void ProcessorContract::PrepareSigs(std::vector<ECC::Point::Native>& vPts, ECC::Hash::Value& hv, const ECC::Point& pt)
+	{
+		assert(m_pSigValidate && m_pFundsIO);
+
 		vPts.reserve(m_vSigs.size() + 1);
 
 		for (const auto& pk : m_vSigs)
@@ -3934,13 +3944,17 @@ namespace bvm2 {
 		m_pFundsIO->ToCommitment(ptFunds);
 		vPts.back() += ptFunds;
 
-		ECC::Hash::Value hv;
 		(*m_pSigValidate) >> hv;
+	}
+
+	bool ProcessorContract::IsSigValid(const std::vector<ECC::Point::Native>& vPts, const ECC::Hash::Value& hv, const ECC::Signature& sig)
+	{
+		assert(!vPts.empty());
 
 		ECC::SignatureBase::Config cfg = ECC::Context::get().m_Sig.m_CfgG1; // copy
 		cfg.m_nKeys = static_cast<uint32_t>(vPts.size());
 
-		Exc::Test(Cast::Down<ECC::SignatureBase>(sig).IsValid(cfg, hv, &sig.m_k, &vPts.front()));
+		return Cast::Down<ECC::SignatureBase>(sig).IsValid(cfg, hv, &sig.m_k, &vPts.front());
 	}
 
 	/////////////////////////////////////////////
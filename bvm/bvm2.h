@@ -492,6 +492,10 @@ namespace bvm2 {
 
 		void CheckSigs(const ECC::Point& comm, const ECC::Signature&);
 
+		// split version of CheckSigs: collect the keys and the msg now, verify later (context-free)
+		void PrepareSigs(std::vector<ECC::Point::Native>&, ECC::Hash::Value&, const ECC::Point& comm);
+		static bool IsSigValid(const std::vector<ECC::Point::Native>&, const ECC::Hash::Value&, const ECC::Signature&);
+
 		void AddRemoveShader(const ContractID&, const Blob*, bool bFireEvent);
 		void AddRemoveShader(const ContractID&, const Blob*);
 
@@ -1,6 +1,20 @@
 #include <assert.h>
+#include <algorithm>
 #include "aes.h"
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#	define AES_NI_SUPPORTED
+#	include <wmmintrin.h>
+#	include <emmintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#		define AES_NI_TARGET
+#	else
+#		include <cpuid.h>
+#		define AES_NI_TARGET __attribute__((target("aes,sse2")))
+#	endif
+#endif
+
 /*
 *  FIPS-197 compliant AES implementation
 *
@@ -479,6 +493,11 @@ void AES::Encoder::Init(const uint8_t* pKey)
 		RK[14] = RK[6] ^ RK[13];
 		RK[15] = RK[7] ^ RK[14];
 	}
+
+	for (i = 0; i < (Nr + 1) * 4; i++)
+	{
+		PUT_UINT32(m_erk[i], m_pRk, i * 4);
+	}
 }
 
 void AES::Decoder::Init(const Encoder& enc)
@@ -822,8 +841,104 @@ void AES::StreamCipher::PerfXor(uint8_t* pBuf, uint32_t nSize)
 	m_nBuf -= (uint8_t) nSize;
 }
 
+bool AES::s_HwEnabled = true;
+
+#ifdef AES_NI_SUPPORTED
+
+static bool DetectAesNi()
+{
+#ifdef _MSC_VER
+	int pInfo[4];
+	__cpuid(pInfo, 1);
+	return !!(pInfo[2] & (1 << 25));
+#else
+	unsigned int a, b, c, d;
+	if (!__get_cpuid(1, &a, &b, &c, &d))
+		return false;
+	return !!(c & bit_AES);
+#endif
+}
+
+bool AES::IsHwSupported()
+{
+	static const bool s_bSupported = DetectAesNi();
+	return s_bSupported;
+}
+
+// CTR mode, many blocks per pass. The AES-NI instructions are pipelined, so that the independent blocks are processed in parallel
+AES_NI_TARGET
+static void XCryptNi(const uint8_t* pRk, beam::uintBig_t<AES::s_BlockSize>& ctr, uint8_t* pBuf, uint32_t nBlocks)
+{
+	const uint32_t nLanes = 8;
+
+	__m128i pK[AES::Nr + 1];
+	for (uint32_t i = 0; i < _countof(pK); i++)
+		pK[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRk) + i);
+
+	while (nBlocks)
+	{
+		uint32_t n = std::min(nBlocks, nLanes);
+		__m128i pX[nLanes];
+
+		for (uint32_t i = 0; i < n; i++)
+		{
+			pX[i] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctr.m_pData)), pK[0]);
+			ctr.Inc();
+		}
+
+		for (uint32_t iRound = 1; iRound < AES::Nr; iRound++)
+			for (uint32_t i = 0; i < n; i++)
+				pX[i] = _mm_aesenc_si128(pX[i], pK[iRound]);
+
+		for (uint32_t i = 0; i < n; i++)
+		{
+			__m128i* pDst = reinterpret_cast<__m128i*>(pBuf) + i;
+			pX[i] = _mm_aesenclast_si128(pX[i], pK[AES::Nr]);
+			_mm_storeu_si128(pDst, _mm_xor_si128(_mm_loadu_si128(pDst), pX[i]));
+		}
+
+		pBuf += n * AES::s_BlockSize;
+		nBlocks -= n;
+	}
+}
+
+#else // AES_NI_SUPPORTED
+
+bool AES::IsHwSupported()
+{
+	return false;
+}
+
+#endif // AES_NI_SUPPORTED
+
 void AES::StreamCipher::XCrypt(const Encoder& enc, uint8_t* pBuf, uint32_t nSize)
 {
+#ifdef AES_NI_SUPPORTED
+	if (s_HwEnabled && IsHwSupported())
+	{
+		// use the remaining cipherstream, then whole blocks
+		if (m_nBuf)
+		{
+			uint8_t n = static_cast<uint8_t>(std::min<uint32_t>(m_nBuf, nSize));
+			PerfXor(pBuf, n);
+			pBuf += n;
+			nSize -= n;
+		}
+
+		uint32_t nBlocks = nSize / s_BlockSize;
+		if (nBlocks)
+		{
+			XCryptNi(enc.m_pRk, m_Counter, pBuf, nBlocks);
+
+			pBuf += nBlocks * s_BlockSize;
+			nSize -= nBlocks * s_BlockSize;
+		}
+
+		if (!nSize)
+			return;
+	}
+#endif // AES_NI_SUPPORTED
+
 	while (true)
 	{
 		if (!m_nBuf)
@@ -8,9 +8,14 @@ struct AES
 	static const int Nr = 14; // num-rounds
 	static const int s_BlockSize = 16;
 
+	// AES-NI path for the stream cipher. Used if supported by the CPU, can be disabled (i.e. for tests)
+	static bool s_HwEnabled;
+	static bool IsHwSupported();
+
 	struct Encoder
 	{
 		uint32_t m_erk[64]; // encryption round keys. Actually needed 60, but during init extra space is used
+		uint8_t m_pRk[(Nr + 1) * s_BlockSize]; // same round keys, in byte order (for the hw path)
 		void Init(const uint8_t* pKey);
 		void Proceed(uint8_t* pDst, const uint8_t* pSrc) const;
 	};
@@ -323,6 +323,7 @@ namespace beam
 			:public Sigma::Proof
 		{
 			typedef std::unique_ptr<Proof> Ptr;
+			BEAM_POOLED_ALLOC
 
 			struct Params
 			{
@@ -778,6 +779,7 @@ namespace beam
 		:public TxElement
 	{
 		typedef std::unique_ptr<Input> Ptr;
+		BEAM_POOLED_ALLOC
 		typedef uint32_t Count; // the type for count of duplicate UTXOs in the system
 
 		struct State
@@ -835,6 +837,7 @@ namespace beam
 		:public TxElement
 	{
 		typedef std::unique_ptr<Output> Ptr;
+		BEAM_POOLED_ALLOC
 
 		bool		m_Coinbase;
 		Height		m_Incubation; // # of blocks before it's mature
@@ -1139,6 +1142,7 @@ namespace beam
 	struct TxKernel
 	{
 		typedef std::unique_ptr<TxKernel> Ptr;
+		BEAM_POOLED_ALLOC
 
 		struct Subtype
 		{
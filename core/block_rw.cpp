@@ -353,11 +353,9 @@ namespace beam
 
 	/////////////
 	// RecoveryInfo
-	void RecoveryInfo::Writer::Open(const char* sz, const Block::ChainWorkProof& cwp, Height hMax)
+	template <typename TSer>
+	void RecoveryWriteHeader(TSer& ser, const Block::ChainWorkProof& cwp, Height hMax)
 	{
-		m_Stream.Open(sz, false, true);
-		yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> ser(m_Stream);
-
 		const Rules& r = Rules::get();
 
 		uint32_t nForks = r.FindFork(hMax) + 1;
@@ -369,6 +367,25 @@ namespace beam
 		ser & cwp;
 	}
 
+	void RecoveryInfo::Writer::Open(const char* sz, const Block::ChainWorkProof& cwp, Height hMax)
+	{
+		m_Stream.Open(sz, false, true);
+		yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> ser(m_Stream);
+
+		RecoveryWriteHeader(ser, cwp, hMax);
+	}
+
+	void RecoveryInfo::Writer::WriteHeader(Serializer& ser, const Block::ChainWorkProof& cwp, Height hMax)
+	{
+		RecoveryWriteHeader(ser, cwp, hMax);
+	}
+
+	void RecoveryInfo::Writer::WriteDeltaHeader(Serializer& ser, const Block::ChainWorkProof& cwp, Height hMax, Height hPrev)
+	{
+		RecoveryWriteHeader(ser, cwp, hMax);
+		ser & hPrev;
+	}
+
 	struct RecoveryInfo::IParser::Context
 	{
 		IParser& m_Parser;
@@ -383,6 +400,12 @@ namespace beam
 		Merkle::CompactMmr m_Assets;
 		Merkle::Hash m_hvContracts;
 		Merkle::Hash m_hvKL;
+		TxoID m_ShieldedOuts = 0;
+
+		// If deltas are applied - the complete UTXO set is maintained, and carried forward from the previous file.
+		// The delta UTXO root is computed from it, the one stated in the file must match
+		std::unique_ptr<UtxoTree> m_pUtxos;
+		bool m_Delta = false;
 
 		Context(IParser& p)
 			:m_Parser(p)
@@ -391,12 +414,19 @@ namespace beam
 		}
 
 		void Open(const char*);
+		void OpenDelta(const char*, Context& ctxPrev);
 		bool Proceed();
+		bool ProceedDelta();
 		bool ProceedUtxos();
+		bool ProceedUtxosSpent();
+		bool ProceedRest();
 		bool ProceedShielded();
 		bool ProceedAssets();
 		void Finalyze();
 
+		void UtxoAdd(const UtxoTree::Key&);
+		void UtxoSpend(const UtxoTree::Key&);
+
 		bool OnProgress() {
 			return m_Parser.OnProgress(m_Total - m_Stream.get_Remaining(), m_Total);
 		}
@@ -450,7 +480,10 @@ namespace beam
 
 			bool get_Utxos(Merkle::Hash& hv) override
 			{
-				m_This.m_UtxoTree.Flush(hv);
+				if (m_This.m_Delta)
+					m_This.m_pUtxos->get_Hash(hv);
+				else
+					m_This.m_UtxoTree.Flush(hv);
 				return true;
 			}
 
@@ -496,6 +529,58 @@ namespace beam
 		}
 	}
 
+	void RecoveryInfo::IParser::Context::OpenDelta(const char* sz, Context& ctxPrev)
+	{
+		Open(sz);
+
+		Height hPrev = 0;
+		m_Der & hPrev;
+
+		if ((hPrev != ctxPrev.m_Tip.get_Height()) || (m_Tip.get_Height() <= hPrev))
+			ThrowBadData();
+
+		// shielded in/outs are appended, utxos are added and spent
+		m_Shielded = ctxPrev.m_Shielded;
+		m_ShieldedOuts = ctxPrev.m_ShieldedOuts;
+		m_pUtxos = std::move(ctxPrev.m_pUtxos);
+		m_Delta = true;
+
+		assert(m_pUtxos);
+	}
+
+	void RecoveryInfo::IParser::Context::UtxoAdd(const UtxoTree::Key& key)
+	{
+		UtxoTree::Cursor cu;
+		bool bCreate = true;
+		UtxoTree::MyLeaf* p = m_pUtxos->Find(cu, key, bCreate);
+
+		// TxoIDs are irrelevant here, only the counts
+		if (bCreate)
+			p->m_ID = 0;
+		else
+		{
+			m_pUtxos->PushID(0, *p);
+			cu.InvalidateElement();
+		}
+	}
+
+	void RecoveryInfo::IParser::Context::UtxoSpend(const UtxoTree::Key& key)
+	{
+		UtxoTree::Cursor cu;
+		bool bCreate = false;
+		UtxoTree::MyLeaf* p = m_pUtxos->Find(cu, key, bCreate);
+		if (!p)
+			ThrowBadData(); // not in the set
+
+		if (p->IsExt())
+		{
+			m_pUtxos->PopID(*p);
+			cu.InvalidateElement();
+		}
+		else
+			m_pUtxos->Delete(cu);
+	}
+
 	bool RecoveryInfo::IParser::Proceed(const char* sz)
 	{
 		Context ctx(*this);
@@ -503,6 +588,30 @@ namespace beam
 		return ctx.Proceed();
 	}
 
+	bool RecoveryInfo::IParser::Proceed(const char* szFull, const std::vector<std::string>& vDeltas)
+	{
+		std::unique_ptr<Context> pCtx = std::make_unique<Context>(*this);
+		pCtx->Open(szFull);
+
+		if (!vDeltas.empty())
+			pCtx->m_pUtxos = std::make_unique<UtxoTree>();
+
+		if (!pCtx->Proceed())
+			return false;
+
+		for (const auto& sDelta : vDeltas)
+		{
+			std::unique_ptr<Context> pNext = std::make_unique<Context>(*this);
+			pNext->OpenDelta(sDelta.c_str(), *pCtx);
+			if (!pNext->ProceedDelta())
+				return false;
+
+			pCtx = std::move(pNext);
+		}
+
+		return true;
+	}
+
 	bool RecoveryInfo::IParser::Context::Proceed()
 	{
 		std::vector<Block::SystemState::Full> vec;
@@ -513,6 +622,32 @@ namespace beam
 		if (!ProceedUtxos())
 			return false;
 
+		return ProceedRest();
+	}
+
+	bool RecoveryInfo::IParser::Context::ProceedDelta()
+	{
+		std::vector<Block::SystemState::Full> vec;
+		m_Cwp.UnpackStates(vec);
+		if (!m_Parser.OnStates(vec))
+			return false;
+
+		if (!ProceedUtxos() ||
+			!ProceedUtxosSpent())
+			return false;
+
+		Merkle::Hash hv, hvUtxos;
+		m_Der & hv;
+
+		m_pUtxos->get_Hash(hvUtxos);
+		if (hv != hvUtxos)
+			ThrowBadData();
+
+		return ProceedRest();
+	}
+
+	bool RecoveryInfo::IParser::Context::ProceedRest()
+	{
 		const Rules& r = Rules::get();
 		if (r.IsPastFork_<2>(m_Tip.get_Height()))
 		{
@@ -558,9 +693,12 @@ namespace beam
 			UtxoTree::Key key;
 			key = d;
 
-			if (!m_UtxoTree.Add(key))
+			if (!m_Delta && !m_UtxoTree.Add(key))
 				ThrowBadData();
 
+			if (m_pUtxos)
+				UtxoAdd(key);
+
 			if (!m_Parser.OnUtxo(h, outp))
 				return false;
 
@@ -568,13 +706,40 @@ namespace beam
 				return false;
 		}
 
+		return m_Parser.Flush();
+	}
+
+	bool RecoveryInfo::IParser::Context::ProceedUtxosSpent()
+	{
+		while (true)
+		{
+			Height h;
+			m_Der & h;
+
+			if (MaxHeight == h)
+				break;
+
+			UtxoTree::Key::Data d;
+			m_Der
+				& d.m_Commitment
+				& d.m_Maturity;
+
+			UtxoTree::Key key;
+			key = d;
+			UtxoSpend(key);
+
+			if (!m_Parser.OnUtxoSpent(h, d))
+				return false;
+
+			if (!OnProgress())
+				return false;
+		}
+
 		return true;
 	}
 
 	bool RecoveryInfo::IParser::Context::ProceedShielded()
 	{
-		TxoID nOuts = 0;
-
 		while (true)
 		{
 			Height h;
@@ -606,7 +771,7 @@ namespace beam
 				ShieldedTxo::DescriptionOutp dOutp;
 				dOutp.m_Commitment = txo.m_Commitment;
 				dOutp.m_SerialPub = txo.m_Ticket.m_SerialPub;
-				dOutp.m_ID = nOuts++;
+				dOutp.m_ID = m_ShieldedOuts++;
 				dOutp.m_Height = h;
 
 				if (!m_Parser.OnShieldedOut(dOutp, txo, hv, h))
@@ -620,7 +785,8 @@ namespace beam
 				m_Der & dInp.m_SpendPk;
 				dInp.m_Height = h;
 
-				if (!m_Parser.OnShieldedIn(dInp))
+				if (!m_Parser.Flush() || // the spent outputs must be reported before
+					!m_Parser.OnShieldedIn(dInp))
 					return false;
 
 				dInp.get_Hash(hv);
@@ -632,7 +798,7 @@ namespace beam
 				return false;
 		}
 
-		return true;
+		return m_Parser.Flush();
 	}
 
 	bool RecoveryInfo::IParser::Context::ProceedAssets()
@@ -684,14 +850,60 @@ namespace beam
 		}
 	}
 
+	void RecoveryInfo::IRecognizer::Recognize(PendingUtxo& x) const
+	{
+		x.m_Recognized = m_pOwner && x.m_Outp.Recover(x.m_Height, *m_pOwner, x.m_Cid, &x.m_User);
+	}
+
+	void RecoveryInfo::IRecognizer::Recognize(PendingShieldedOut& x) const
+	{
+		x.m_Recognized = false;
+
+		for (Key::Index nIdx = 0; nIdx < static_cast<Key::Index>(m_vSh.size()); nIdx++)
+		{
+			if (x.m_Pars.m_Ticket.Recover(x.m_Txo.m_Ticket, m_vSh[nIdx]))
+			{
+				ECC::Oracle oracle;
+				oracle << x.m_hvMsg;
+
+				if (x.m_Pars.m_Output.Recover(x.m_Txo, x.m_Pars.m_Ticket.m_SharedSecret, x.m_Height, oracle))
+				{
+					x.m_nIdx = nIdx;
+					x.m_Recognized = true;
+					break;
+				}
+			}
+		}
+	}
+
 	bool RecoveryInfo::IRecognizer::OnUtxo(Height h, const Output& outp)
 	{
-		if (m_pOwner)
+		if (!m_pOwner)
+			return true;
+
+		auto& x = m_vUtxos.emplace_back();
+		x.m_Height = h;
+		x.m_Outp = std::move(Cast::NotConst(outp)); // the parser doesn't need it anymore
+
+		return MaybeFlush(m_vUtxos.size());
+	}
+
+	bool RecoveryInfo::IRecognizer::OnUtxoSpent(Height h, const UtxoTree::Key::Data& d)
+	{
+		// the spent UTXO may still be pending
+		if (!Flush())
+			return false;
+
+		auto itPair = m_mapRecognized.equal_range(d.m_Commitment);
+		for (auto it = itPair.first; itPair.second != it; ++it)
 		{
-			CoinID cid;
-			Output::User user;
-			if (outp.Recover(h, *m_pOwner, cid, &user))
-				return OnUtxoRecognized(h, outp, cid, user);
+			if (it->second.first != d.m_Maturity)
+				continue;
+
+			CoinID cid = it->second.second;
+			m_mapRecognized.erase(it);
+
+			return OnUtxoSpentRecognized(h, cid, d);
 		}
 
 		return true;
@@ -699,21 +911,103 @@ namespace beam
 
 	bool RecoveryInfo::IRecognizer::OnShieldedOut(const ShieldedTxo::DescriptionOutp& dout, const ShieldedTxo& txo, const ECC::Hash::Value& hvMsg, Height hScheme)
 	{
-		for (Key::Index nIdx = 0; nIdx < static_cast<Key::Index>(m_vSh.size()); nIdx++)
+		if (m_vSh.empty())
+			return true;
+
+		auto& x = m_vShieldedOuts.emplace_back();
+		x.m_Desc = dout;
+		x.m_Txo = std::move(Cast::NotConst(txo));
+		x.m_hvMsg = hvMsg;
+		x.m_Height = hScheme;
+
+		return MaybeFlush(m_vShieldedOuts.size());
+	}
+
+	bool RecoveryInfo::IRecognizer::MaybeFlush(size_t nPending)
+	{
+		if (Executor::s_pInstance && (nPending < m_BatchSize))
+			return true;
+
+		return Flush();
+	}
+
+	struct RecoveryInfo::IRecognizer::RecognizeTask
+		:public Executor::TaskSync
+	{
+		IRecognizer& m_This;
+		RecognizeTask(IRecognizer& x) :m_This(x) {}
+
+		virtual ~RecognizeTask() {}
+
+		template <typename T>
+		void RecognizeRange(std::deque<T>& v, Executor::Context& ctx)
+		{
+			uint32_t i0, nCount;
+			ctx.get_Portion(i0, nCount, static_cast<uint32_t>(v.size()));
+
+			for (nCount += i0; i0 < nCount; i0++)
+				m_This.Recognize(v[i0]);
+		}
+
+		void Exec(Executor::Context& ctx) override
 		{
-			ShieldedTxo::DataParams pars;
+			RecognizeRange(m_This.m_vUtxos, ctx);
+			RecognizeRange(m_This.m_vShieldedOuts, ctx);
+		}
+	};
 
-			if (pars.m_Ticket.Recover(txo.m_Ticket, m_vSh[nIdx]))
+	bool RecoveryInfo::IRecognizer::Flush()
+	{
+		if (m_vUtxos.empty() && m_vShieldedOuts.empty())
+			return true;
+
+		if (Executor::s_pInstance)
+		{
+			RecognizeTask t(*this);
+			Executor::s_pInstance->ExecAll(t);
+		}
+		else
+		{
+			for (auto& x : m_vUtxos)
+				Recognize(x);
+			for (auto& x : m_vShieldedOuts)
+				Recognize(x);
+		}
+
+		// the parser reports utxos before the shielded, so the order is preserved
+		bool bRet = true;
+
+		for (auto& x : m_vUtxos)
+		{
+			if (!x.m_Recognized)
+				continue;
+
+			if (!OnUtxoRecognized(x.m_Height, x.m_Outp, x.m_Cid, x.m_User))
 			{
-				ECC::Oracle oracle;
-				oracle << hvMsg;
+				bRet = false;
+				break;
+			}
 
-				if (pars.m_Output.Recover(txo, pars.m_Ticket.m_SharedSecret, hScheme, oracle))
-					return OnShieldedOutRecognized(dout, pars, nIdx);
+			// deltas may spend it later
+			m_mapRecognized.emplace(x.m_Outp.m_Commitment, std::make_pair(x.m_Outp.get_MinMaturity(x.m_Height), x.m_Cid));
+		}
+
+		if (bRet)
+		{
+			for (auto& x : m_vShieldedOuts)
+			{
+				if (x.m_Recognized && !OnShieldedOutRecognized(x.m_Desc, x.m_Pars, x.m_nIdx))
+				{
+					bRet = false;
+					break;
+				}
 			}
 		}
 
-		return true;
+		m_vUtxos.clear();
+		m_vShieldedOuts.clear();
+
+		return bRet;
 	}
 
 	bool RecoveryInfo::IRecognizer::OnAsset(Asset::Full& ai)
@@ -14,7 +14,10 @@
 
 #pragma once
 #include "block_crypt.h"
+#include "shielded.h"
 #include "radixtree.h"
+#include <deque>
+#include <map>
 
 namespace beam
 {
@@ -53,7 +56,10 @@ namespace beam
 		bool Import(void*, uint32_t, uint8_t nCode);
 	};
 
+	class Serializer;
+
 	// Full recovery info. Includes ChainWorkProof, and all the UTXO set which hash should correspond to the tip commitment
+	// Delta files contain the changes since the previous file (either full or delta), and are applied in sequence on top of the full one.
 	struct RecoveryInfo
 	{
 		struct Flags {
@@ -66,6 +72,10 @@ namespace beam
 			std::FStream m_Stream;
 
 			void Open(const char*, const Block::ChainWorkProof&, Height hMax);
+
+			// serialized in memory, so that the file may be written asynchronously
+			static void WriteHeader(Serializer&, const Block::ChainWorkProof&, Height hMax);
+			static void WriteDeltaHeader(Serializer&, const Block::ChainWorkProof&, Height hMax, Height hPrev);
 		};
 
 		struct IParser
@@ -74,11 +84,14 @@ namespace beam
 			virtual bool OnProgress(uint64_t nPos, uint64_t nTotal) { return true; }
 			virtual bool OnStates(std::vector<Block::SystemState::Full>&) { return true; }
 			virtual bool OnUtxo(Height, const Output&) { return true; }
+			virtual bool OnUtxoSpent(Height, const UtxoTree::Key::Data&) { return true; } // delta only, the commitment and maturity of the spent UTXO
 			virtual bool OnShieldedOut(const ShieldedTxo::DescriptionOutp& , const ShieldedTxo&, const ECC::Hash::Value& hvMsg, Height) { return true; }
 			virtual bool OnShieldedIn(const ShieldedTxo::DescriptionInp&) { return true; }
 			virtual bool OnAsset(Asset::Full&) { return true; }
+			virtual bool Flush() { return true; } // deliver the buffered elements (if any) before the parser proceeds to the dependent ones
 
 			bool Proceed(const char*);
+			bool Proceed(const char* szFull, const std::vector<std::string>& vDeltas);
 
 			struct Context;
 		};
@@ -89,15 +102,57 @@ namespace beam
 			Key::IPKdf::Ptr m_pOwner;
 			std::vector<ShieldedTxo::Viewer> m_vSh;
 
+			// If the Executor is set - outputs are buffered and recognized in parallel, in batches of this size.
+			// The recognized ones are reported in the original order.
+			uint32_t m_BatchSize = 0x2000;
+
 			void Init(const Key::IPKdf::Ptr&, Key::Index nMaxShieldedIdx = 1);
 
 			bool OnUtxo(Height, const Output&) override;
+			bool OnUtxoSpent(Height, const UtxoTree::Key::Data&) override;
 			bool OnShieldedOut(const ShieldedTxo::DescriptionOutp&, const ShieldedTxo&, const ECC::Hash::Value& hvMsg, Height) override;
 			bool OnAsset(Asset::Full&) override;
+			bool Flush() override;
 
 			virtual bool OnUtxoRecognized(Height, const Output&, CoinID&, const Output::User&) { return true; }
+			virtual bool OnUtxoSpentRecognized(Height, const CoinID&, const UtxoTree::Key::Data&) { return true; }
 			virtual bool OnShieldedOutRecognized(const ShieldedTxo::DescriptionOutp&, const ShieldedTxo::DataParams&, Key::Index) { return true; }
 			virtual bool OnAssetRecognized(Asset::Full&) { return true; }
+
+		private:
+
+			struct PendingUtxo
+			{
+				Height m_Height;
+				Output m_Outp;
+				CoinID m_Cid;
+				Output::User m_User;
+				bool m_Recognized;
+			};
+
+			struct PendingShieldedOut
+			{
+				ShieldedTxo::DescriptionOutp m_Desc;
+				ShieldedTxo m_Txo;
+				ECC::Hash::Value m_hvMsg;
+				Height m_Height;
+				ShieldedTxo::DataParams m_Pars;
+				Key::Index m_nIdx;
+				bool m_Recognized;
+			};
+
+			// elements are constructed in-place and never relocated
+			std::deque<PendingUtxo> m_vUtxos;
+			std::deque<PendingShieldedOut> m_vShieldedOuts;
+
+			// recognized UTXOs, to report the spent ones
+			std::multimap<ECC::Point, std::pair<Height, CoinID> > m_mapRecognized; // commitment -> maturity, CoinID
+
+			struct RecognizeTask;
+
+			void Recognize(PendingUtxo&) const;
+			void Recognize(PendingShieldedOut&) const;
+			bool MaybeFlush(size_t nPending);
 		};
 	};
 
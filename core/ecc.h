@@ -400,6 +400,8 @@ namespace ECC
 
 		struct Confidential
 		{
+			BEAM_POOLED_ALLOC
+
 			// Bulletproof scheme
 			struct Part1 {
 				Point m_A;
@@ -474,6 +476,8 @@ namespace ECC
 
 		struct Public
 		{
+			BEAM_POOLED_ALLOC
+
 			Signature m_Signature;
 			Amount m_Value;
 
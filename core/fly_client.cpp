@@ -926,6 +926,118 @@ void FlyClient::NetworkStd::Connection::OnRequestData(RequestUtxo& req)
             ThrowUnexpected();
 }
 
+bool FlyClient::NetworkStd::Connection::SendRequest(RequestUtxo& req)
+{
+    Send(req.m_Msg);
+    return true;
+}
+
+bool FlyClient::NetworkStd::Connection::SendRequest(RequestUtxoBatch& req)
+{
+    req.m_Res.m_Proofs.clear();
+    req.m_Res.m_Common.clear();
+
+    if (req.m_Msg.m_Utxos.size() > proto::g_ProofUtxoBatchMaxSize)
+        return false;
+
+    if (req.m_Msg.m_Utxos.empty())
+    {
+        RequestNode& n = m_lst.back(); // SendRequest is called on the most recently added request
+        assert(&req == n.m_pRequest);
+
+        OnDone(n);
+        return true;
+    }
+
+    if (get_Ext() >= 13)
+        Send(req.m_Msg);
+    else
+    {
+        // older node, fallback to individual requests. Replies are accumulated in the same order
+        proto::GetProofUtxo msg;
+        msg.m_MaturityMin = 0;
+
+        for (const auto& comm : req.m_Msg.m_Utxos)
+        {
+            msg.m_Utxo = comm;
+            Send(msg);
+        }
+    }
+
+    return true;
+}
+
+void FlyClient::NetworkStd::Connection::OnMsg(ProofUtxo&& msg)
+{
+    auto& n = get_FirstRequest();
+    switch (n.m_pRequest->get_Type())
+    {
+    case Request::Type::Utxo:
+        {
+            auto& req = Cast::Up<RequestUtxo>(*n.m_pRequest);
+            req.m_Res = std::move(msg);
+            OnRequestData(req);
+        }
+        break;
+
+    case Request::Type::UtxoBatch:
+        {
+            auto& req = Cast::Up<RequestUtxoBatch>(*n.m_pRequest);
+
+            size_t i = req.m_Res.m_Proofs.size();
+            if (i >= req.m_Msg.m_Utxos.size())
+                ThrowUnexpected();
+
+            for (const auto& p : msg.m_Proofs)
+                if (!m_Tip.IsValidProofUtxo(req.m_Msg.m_Utxos[i], p))
+                    ThrowUnexpected();
+
+            req.m_Res.m_Proofs.push_back(std::move(msg.m_Proofs));
+
+            if (req.m_Res.m_Proofs.size() < req.m_Msg.m_Utxos.size())
+                return; // more to come
+        }
+        break;
+
+    default:
+        ThrowUnexpected();
+    }
+
+    OnDone(n);
+}
+
+void FlyClient::NetworkStd::Connection::OnMsg(ProofUtxoBatch&& msg)
+{
+    auto& n = get_FirstRequest();
+    auto& req = n.m_pRequest->As<RequestUtxoBatch>();
+    req.m_Res = std::move(msg);
+
+    auto& vProofs = req.m_Res.m_Proofs;
+    if (vProofs.empty())
+        vProofs.resize(req.m_Msg.m_Utxos.size()); // node is not ready to serve proofs
+    else
+    {
+        if (vProofs.size() != req.m_Msg.m_Utxos.size())
+            ThrowUnexpected();
+
+        const auto& vCommon = req.m_Res.m_Common;
+        for (size_t i = 0; i < vProofs.size(); i++)
+        {
+            for (auto& p : vProofs[i])
+            {
+                p.m_Proof.insert(p.m_Proof.end(), vCommon.begin(), vCommon.end());
+
+                if (!m_Tip.IsValidProofUtxo(req.m_Msg.m_Utxos[i], p))
+                    ThrowUnexpected();
+            }
+        }
+
+        req.m_Res.m_Common.clear();
+    }
+
+    OnDone(n);
+}
+
 void FlyClient::NetworkStd::Connection::OnRequestData(RequestKernel& req)
 {
     if (!req.m_Res.m_Proof.empty())
@@ -1032,12 +1144,7 @@ bool FlyClient::Data::DecodedHdrPack::DecodeAndCheck(const HdrPack& msg)
 
     // PoW verification is heavy for big packs. Do it in parallel
     std::vector<Block::SystemState::Full> v;
-    v.resize(msg.m_vElements.size());
-
-    v.front().SetFirst(msg.m_Prefix, msg.m_vElements.back());
-
-    for (size_t i = 1; i < msg.m_vElements.size(); i++)
-        v[i].SetNext(v[i - 1], msg.m_vElements[msg.m_vElements.size() - i - 1]);
+    Decode(v, msg);
 
     struct MyTask
         :public Executor::TaskSync
@@ -1080,6 +1187,18 @@ bool FlyClient::Data::DecodedHdrPack::DecodeAndCheck(const HdrPack& msg)
     return t.m_Valid;
 }
 
+void FlyClient::Data::DecodedHdrPack::Decode(std::vector<Block::SystemState::Full>& v, const HdrPack& msg)
+{
+    v.resize(msg.m_vElements.size());
+    if (v.empty())
+        return;
+
+    v.front().SetFirst(msg.m_Prefix, msg.m_vElements.back());
+
+    for (size_t i = 1; i < msg.m_vElements.size(); i++)
+        v[i].SetNext(v[i - 1], msg.m_vElements[msg.m_vElements.size() - i - 1]);
+}
+
 bool FlyClient::NetworkStd::Connection::SendRequest(RequestEnumHdrs& req)
 {
     Send(req.m_Msg);
@@ -1117,6 +1236,11 @@ void FlyClient::NetworkStd::Connection::OnMsg(DataMissing&& msg)
         OnDone(n);
         break;
 
+    case Request::Type::ContractVars: // historical state is not available
+        r.As<RequestContractVars>().m_bDataMissing = true;
+        OnDone(n);
+        break;
+
     default:
         ThrowUnexpected();
     }
@@ -1234,6 +1358,23 @@ bool FlyClient::NetworkStd::Connection::SendTrgCtx(const std::unique_ptr<Merkle:
 
 bool FlyClient::NetworkStd::Connection::SendRequest(RequestContractVars& req)
 {
+    if (MaxHeight != req.m_Height)
+    {
+        if (get_Ext() < 12)
+            return false;
+
+        req.m_bDataMissing = false;
+
+        proto::ContractVarsEnumAt msg;
+        msg.m_KeyMin = req.m_Msg.m_KeyMin;
+        msg.m_KeyMax = req.m_Msg.m_KeyMax;
+        msg.m_bSkipMin = req.m_Msg.m_bSkipMin;
+        msg.m_Height = req.m_Height;
+
+        Send(msg);
+        return true;
+    }
+
     if (!SendTrgCtx(req.m_pCtx))
         return false;
 
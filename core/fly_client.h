@@ -25,6 +25,7 @@ namespace proto {
 	{
 #define REQUEST_TYPES_All(macro) \
 		macro(Utxo) \
+		macro(UtxoBatch) \
 		macro(Kernel) \
 		macro(Kernel2) \
 		macro(Kernel3) \
@@ -49,7 +50,6 @@ namespace proto {
 
 
 #define REQUEST_TYPES_Std(macro) \
-        macro(Utxo,              GetProofUtxo,         ProofUtxo) \
         macro(Kernel,            GetProofKernel,       ProofKernel) \
         macro(Asset,             GetProofAsset,        ProofAsset) \
         macro(Events,            GetEvents,            Events) \
@@ -116,6 +116,15 @@ namespace proto {
 			REQUEST_TYPES_Std(THE_MACRO)
 #undef THE_MACRO
 
+			struct Utxo :public Std {
+				proto::GetProofUtxo m_Msg;
+				proto::ProofUtxo m_Res;
+			};
+			struct UtxoBatch {
+				proto::GetProofUtxoBatch m_Msg;
+				proto::ProofUtxoBatch m_Res; // on completion the common part is already appended to each proof
+			};
+
 			struct BbsMsg {
 				proto::BbsMsg m_Msg;
 			};
@@ -123,14 +132,17 @@ namespace proto {
 			struct DecodedHdrPack {
 				std::vector<Block::SystemState::Full> m_vStates;
 				bool DecodeAndCheck(const HdrPack& msg);
+				static void Decode(std::vector<Block::SystemState::Full>&, const HdrPack& msg); // no PoW verification
 			};
 			struct EnumHdrs :public DecodedHdrPack {
 				proto::EnumHdrs m_Msg;
 			};
 			struct ContractVars :public Std {
 				std::unique_ptr<Merkle::Hash> m_pCtx;
+				Height m_Height = MaxHeight; // if specified - the vars state at this height
 				proto::ContractVarsEnum m_Msg;
 				proto::ContractVars m_Res;
+				bool m_bDataMissing = false; // the node doesn't keep contract history down to m_Height, m_Res is empty
 			};
 			struct ContractLogs :public Std {
 				std::unique_ptr<Merkle::Hash> m_pCtx;
@@ -339,6 +351,8 @@ namespace proto {
 				void OnMsg(proto::ContractLogs&& msg) override;
 				void OnMsg(proto::AssetsListAt&& msg) override;
 				void OnMsg(proto::ProofKernel2&& msg) override;
+				void OnMsg(proto::ProofUtxo&& msg) override;
+				void OnMsg(proto::ProofUtxoBatch&& msg) override;
 
 				bool IsSupported(const Data::Std&) { return true; }
 				bool IsSupported(RequestEvents&);
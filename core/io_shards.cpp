@@ -0,0 +1,514 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "io_shards.h"
+#include "../utility/logger.h"
+
+namespace beam {
+namespace proto {
+
+/////////////////////////
+// Shard side
+struct IoShards::Stream
+{
+	Shard& m_Shard;
+	uint64_t m_ID = 0;
+	MsgHeader m_HdrDefault{ 0, 0, 0 };
+	std::vector<std::pair<uint32_t, uint32_t> > m_vSizeLimits;
+	io::TcpStream::Ptr m_pStream;
+	std::shared_ptr<Shared> m_pShared;
+	std::unique_ptr<Cipher> m_pCipher;
+
+	ByteBuffer m_Frame;
+	uint32_t m_nDone = 0;
+	uint32_t m_nExpected = MsgHeader::SIZE;
+
+	ByteBuffer m_Pending; // received while paused
+	bool m_bPaused = false;
+	bool m_bDead = false;
+
+	Stream(Shard& s) :m_Shard(s)
+	{
+		m_Frame.resize(MsgHeader::SIZE);
+	}
+
+	void EnableRead();
+	bool OnRead(io::ErrorCode, const void*, size_t);
+	void Process(const uint8_t*, size_t);
+	void OnFrame();
+	void Fail(Evt::Type, int32_t nErr);
+	void Write(const io::SerializedMsg&);
+	void Resume(std::unique_ptr<Cipher>&&);
+
+	void UpdateUnsent()
+	{
+		if (m_pStream)
+			m_pShared->m_Unsent = m_pStream->state().unsent;
+	}
+};
+
+struct IoShards::Shard
+{
+	// the reactor must be destroyed last
+	io::Reactor::Ptr m_pReactor;
+	std::unique_ptr<RX<Cmd> > m_pRx;
+	std::unique_ptr<TX<Cmd> > m_pTx; // used by the owner
+	std::unique_ptr<TX<Evt> > m_pTxEvt;
+	io::Timer::Ptr m_pTimer;
+	std::map<uint64_t, std::unique_ptr<Stream> > m_Streams;
+	std::thread m_Thread;
+
+	static const uint32_t s_Refresh_ms = 100; // unsent stats
+
+	void Run() { m_pReactor->run(); }
+	void OnCmd(Cmd&&);
+	void OnTimer();
+	void Post(Evt&& evt) { m_pTxEvt->send(std::move(evt)); }
+};
+
+void IoShards::Shard::OnCmd(Cmd&& cmd)
+{
+	if (Cmd::Type::Open == cmd.m_Type)
+	{
+		auto& pS = m_Streams[cmd.m_ID];
+		pS = std::make_unique<Stream>(*this);
+		pS->m_ID = cmd.m_ID;
+		pS->m_HdrDefault = cmd.m_Hdr;
+		pS->m_vSizeLimits = std::move(cmd.m_vSizeLimits);
+		pS->m_pShared = std::move(cmd.m_pShared);
+
+		io::Result res = m_pReactor->tcp_import(cmd.m_Socket, pS->m_pStream);
+		if (res)
+			pS->EnableRead();
+		else
+			pS->Fail(Evt::Type::IoError, res.error());
+
+		return;
+	}
+
+	auto it = m_Streams.find(cmd.m_ID);
+	if (m_Streams.end() == it)
+		return;
+
+	Stream& s = *it->second;
+
+	switch (cmd.m_Type)
+	{
+	case Cmd::Type::Write:
+		s.Write(cmd.m_Data);
+		break;
+
+	case Cmd::Type::Duplex:
+		s.Resume(std::move(cmd.m_pCipher));
+		break;
+
+	case Cmd::Type::Close:
+		m_Streams.erase(it);
+		break;
+
+	default:
+		assert(false);
+	}
+}
+
+void IoShards::Shard::OnTimer()
+{
+	for (auto& x : m_Streams)
+		x.second->UpdateUnsent();
+}
+
+void IoShards::Stream::EnableRead()
+{
+	if (m_bDead)
+		return;
+
+	io::Result res = m_pStream->enable_read([this](io::ErrorCode err, void* p, size_t n) {
+		return OnRead(err, p, n);
+	});
+
+	if (!res)
+		Fail(Evt::Type::IoError, res.error());
+}
+
+void IoShards::Stream::Fail(Evt::Type type, int32_t nErr)
+{
+	if (m_bDead)
+		return;
+	m_bDead = true;
+
+	Evt evt;
+	evt.m_Type = type;
+	evt.m_ID = m_ID;
+	evt.m_Error = nErr;
+	m_Shard.Post(std::move(evt));
+}
+
+bool IoShards::Stream::OnRead(io::ErrorCode err, const void* p, size_t n)
+{
+	if (err)
+		Fail(Evt::Type::IoError, err);
+	else
+		Process(reinterpret_cast<const uint8_t*>(p), n);
+
+	if (m_bDead || m_bPaused)
+	{
+		// the read buffer is released, the data is not accessed anymore
+		m_pStream->disable_read();
+		return false;
+	}
+
+	return true;
+}
+
+void IoShards::Stream::Process(const uint8_t* p, size_t n)
+{
+	while (n && !m_bPaused)
+	{
+		if (m_bDead)
+			return;
+
+		uint32_t nPortion = static_cast<uint32_t>(std::min<size_t>(n, m_nExpected - m_nDone));
+		uint8_t* pDst = &m_Frame.front() + m_nDone;
+
+		memcpy(pDst, p, nPortion);
+		if (m_pCipher)
+			m_pCipher->m_Cipher.XCrypt(m_pCipher->m_Enc, pDst, nPortion);
+
+		p += nPortion;
+		n -= nPortion;
+		m_nDone += nPortion;
+
+		if (m_nDone < m_nExpected)
+			break;
+
+		if (MsgHeader::SIZE == m_nExpected)
+		{
+			MsgHeader hdr(&m_Frame.front());
+			if ((hdr.V0 != m_HdrDefault.V0) || (hdr.V1 != m_HdrDefault.V1) || (hdr.V2 != m_HdrDefault.V2))
+			{
+				Fail(Evt::Type::ProtoError, static_cast<int32_t>(ProtocolError::version_error));
+				return;
+			}
+
+			// same checks as the protocol does, but before the frame is buffered
+			if ((hdr.type >= m_vSizeLimits.size()) || (m_vSizeLimits[hdr.type].first > m_vSizeLimits[hdr.type].second))
+			{
+				Fail(Evt::Type::ProtoError, static_cast<int32_t>(ProtocolError::msg_type_error));
+				return;
+			}
+
+			const auto& lim = m_vSizeLimits[hdr.type];
+			if ((hdr.size < lim.first) || (hdr.size > lim.second) || (hdr.size > NodeConnection::s_MaxMsgSize))
+			{
+				Fail(Evt::Type::ProtoError, static_cast<int32_t>(ProtocolError::msg_size_error));
+				return;
+			}
+
+			m_nExpected += hdr.size;
+			m_Frame.resize(m_nExpected);
+
+			if (m_nDone < m_nExpected)
+				continue;
+		}
+
+		OnFrame();
+	}
+
+	if (n && !m_bDead)
+		m_Pending.insert(m_Pending.end(), p, p + n); // paused, the rest is not decrypted yet
+}
+
+void IoShards::Stream::OnFrame()
+{
+	MsgHeader hdr(&m_Frame.front());
+	uint32_t nSizeBody = hdr.size;
+
+	if (m_pCipher)
+	{
+		ProtocolPlus::MacValue hmac;
+		if (nSizeBody < hmac.nBytes)
+		{
+			Fail(Evt::Type::ProtoError, static_cast<int32_t>(ProtocolError::message_corrupted));
+			return;
+		}
+
+		nSizeBody -= hmac.nBytes;
+
+		ECC::Hash::Mac hm = m_pCipher->m_HMac;
+		hm.Write(&m_Frame.front(), MsgHeader::SIZE + nSizeBody);
+		ProtocolPlus::get_HMac(hm, hmac);
+
+		if (memcmp(&m_Frame.front() + MsgHeader::SIZE + nSizeBody, hmac.m_pData, hmac.nBytes))
+		{
+			Fail(Evt::Type::ProtoError, static_cast<int32_t>(ProtocolError::message_corrupted));
+			return;
+		}
+	}
+
+	Evt evt;
+	evt.m_Type = Evt::Type::Msg;
+	evt.m_ID = m_ID;
+	evt.m_MsgType = hdr.type;
+	evt.m_SizeWire = hdr.size;
+	evt.m_SizeBody = nSizeBody;
+	evt.m_Frame = std::move(m_Frame);
+	m_Shard.Post(std::move(evt));
+
+	m_Frame.clear();
+	m_Frame.resize(MsgHeader::SIZE);
+	m_nDone = 0;
+	m_nExpected = MsgHeader::SIZE;
+
+	if (!m_pCipher && (SChannelReady::s_Code == hdr.type))
+		// the peer switched to the encrypted mode. Wait for the owner to provide the cipher (or close the connection)
+		m_bPaused = true;
+}
+
+void IoShards::Stream::Resume(std::unique_ptr<Cipher>&& pCipher)
+{
+	if (m_bDead)
+		return;
+
+	assert(m_bPaused && !m_pCipher);
+	m_pCipher = std::move(pCipher);
+	m_bPaused = false;
+
+	ByteBuffer buf;
+	buf.swap(m_Pending);
+	if (!buf.empty())
+		Process(&buf.front(), buf.size());
+
+	if (!m_bPaused)
+		EnableRead();
+}
+
+void IoShards::Stream::Write(const io::SerializedMsg& msg)
+{
+	size_t nSize = 0;
+	for (const auto& x : msg)
+		nSize += x.size;
+
+	assert(m_pShared->m_Queued >= nSize);
+	m_pShared->m_Queued -= nSize;
+
+	if (m_bDead)
+		return;
+
+	io::Result res = m_pStream->write(msg);
+	if (res)
+		UpdateUnsent();
+	else
+	{
+		Fail(Evt::Type::IoError, res.error());
+		m_pStream->disable_read();
+	}
+}
+
+/////////////////////////
+// Owner side
+IoShards::IoShards()
+{
+}
+
+IoShards::~IoShards()
+{
+	Stop();
+}
+
+void IoShards::Start(uint32_t nShards)
+{
+	Stop();
+
+#ifdef WIN32
+	BEAM_LOG_WARNING() << "I/O shards are not supported on this platform";
+	nShards;
+#else // WIN32
+
+	if (!nShards)
+		return;
+
+	m_pRx = std::make_unique<RX<Evt> >(io::Reactor::get_Current(), [this](Evt&& evt) { OnEvt(std::move(evt)); });
+
+	m_vShards.resize(nShards);
+	for (auto& pS : m_vShards)
+	{
+		pS = std::make_unique<Shard>();
+		Shard* pShard = pS.get();
+
+		// created before the thread starts, the loop isn't running yet
+		pS->m_pReactor = io::Reactor::create();
+		pS->m_pRx = std::make_unique<RX<Cmd> >(*pS->m_pReactor, [pShard](Cmd&& cmd) { pShard->OnCmd(std::move(cmd)); });
+		pS->m_pTx = std::make_unique<TX<Cmd> >(pS->m_pRx->get_tx());
+		pS->m_pTxEvt = std::make_unique<TX<Evt> >(m_pRx->get_tx());
+
+		pS->m_pTimer = io::Timer::create(*pS->m_pReactor);
+		pS->m_pTimer->start(Shard::s_Refresh_ms, true, [pShard]() { pShard->OnTimer(); });
+
+		pS->m_Thread = std::thread(&Shard::Run, pShard);
+	}
+
+	BEAM_LOG_INFO() << "I/O shards: " << nShards;
+
+#endif // WIN32
+}
+
+void IoShards::Stop()
+{
+	for (auto& pS : m_vShards)
+	{
+		pS->m_pReactor->stop();
+		if (pS->m_Thread.joinable())
+			pS->m_Thread.join();
+	}
+
+	m_vShards.clear();
+	m_pRx.reset();
+}
+
+std::unique_ptr<IoShardLink> IoShards::Attach(io::TcpStream::Ptr& pStream, NodeConnection& conn, ProtocolBase& proto)
+{
+	if (!IsRunning())
+		return nullptr;
+
+	io::Address addr = pStream->peer_address();
+
+	uv_os_sock_t s;
+	io::Result res = pStream->export_socket(s);
+	if (!res)
+	{
+		BEAM_LOG_WARNING() << "Socket export failed: " << io::error_str(res.error());
+		return nullptr;
+	}
+
+	pStream.reset();
+
+	auto pLink = std::make_unique<IoShardLink>(*this, conn);
+	pLink->m_Addr = addr;
+
+	Cmd cmd;
+	cmd.m_Type = Cmd::Type::Open;
+	cmd.m_Socket = s;
+	cmd.m_Hdr = proto.get_default_header();
+
+	cmd.m_vSizeLimits.resize(proto.max_message_types());
+	for (size_t i = 0; i < cmd.m_vSizeLimits.size(); i++)
+	{
+		auto& lim = cmd.m_vSizeLimits[i];
+		if (!proto.get_msg_size_limits(static_cast<MsgType>(i), lim.first, lim.second))
+		{
+			lim.first = 1;
+			lim.second = 0; // not handled
+		}
+	}
+
+	cmd.m_pShared = pLink->m_pShared;
+	pLink->Post(std::move(cmd));
+
+	return pLink;
+}
+
+void IoShards::OnEvt(Evt&& evt)
+{
+	auto it = m_mapLinks.find(evt.m_ID);
+	if (m_mapLinks.end() == it)
+		return; // closed already
+
+	NodeConnection& conn = it->second->m_Conn;
+
+	// the connection may be destroyed during the handling
+	switch (evt.m_Type)
+	{
+	case Evt::Type::Msg:
+		conn.OnShardMsg(evt.m_MsgType, evt.m_SizeWire, &evt.m_Frame.front() + MsgHeader::SIZE, evt.m_SizeBody);
+		break;
+
+	case Evt::Type::IoError:
+		conn.OnShardIoErr(static_cast<io::ErrorCode>(evt.m_Error));
+		break;
+
+	case Evt::Type::ProtoError:
+		conn.OnShardProtoErr(static_cast<ProtocolError>(evt.m_Error));
+		break;
+
+	default:
+		assert(false);
+	}
+}
+
+/////////////////////////
+// IoShardLink
+IoShardLink::IoShardLink(IoShards& x, NodeConnection& conn)
+	:m_This(x)
+	,m_Conn(conn)
+	,m_pShared(std::make_shared<IoShards::Shared>())
+{
+	assert(x.IsRunning());
+
+	m_ID = ++x.m_LastID;
+	m_iShard = x.m_iNextShard++ % static_cast<uint32_t>(x.m_vShards.size());
+	x.m_mapLinks[m_ID] = this;
+}
+
+IoShardLink::~IoShardLink()
+{
+	m_This.m_mapLinks.erase(m_ID);
+
+	IoShards::Cmd cmd;
+	cmd.m_Type = IoShards::Cmd::Type::Close;
+	Post(std::move(cmd));
+}
+
+void IoShardLink::Post(IoShards::Cmd&& cmd)
+{
+	if (m_iShard >= m_This.m_vShards.size())
+		return; // stopped
+
+	cmd.m_ID = m_ID;
+	m_This.m_vShards[m_iShard]->m_pTx->send(std::move(cmd));
+}
+
+io::Result IoShardLink::write_msg(const io::SerializedMsg& msg)
+{
+	IoShards::Cmd cmd;
+	cmd.m_Type = IoShards::Cmd::Type::Write;
+	cmd.m_Data = msg;
+
+	size_t nSize = 0;
+	for (const auto& x : msg)
+		nSize += x.size;
+	m_pShared->m_Queued += nSize;
+
+	Post(std::move(cmd));
+	return io::Ok();
+}
+
+size_t IoShardLink::get_Unsent() const
+{
+	return m_pShared->m_Queued + m_pShared->m_Unsent;
+}
+
+void IoShardLink::OnDuplex(const ProtocolPlus& p)
+{
+	IoShards::Cmd cmd;
+	cmd.m_Type = IoShards::Cmd::Type::Duplex;
+	cmd.m_pCipher = std::make_unique<IoShards::Cipher>();
+	cmd.m_pCipher->m_Enc = p.m_Enc;
+	cmd.m_pCipher->m_Cipher = p.m_CipherIn;
+	cmd.m_pCipher->m_HMac = p.m_HMac;
+
+	Post(std::move(cmd));
+}
+
+} // namespace proto
+} // namespace beam
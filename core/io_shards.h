@@ -0,0 +1,136 @@
+// Copyright 2018 The Beam Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include "proto.h"
+#include "../utility/message_queue.h"
+#include "../utility/io/timer.h"
+#include <thread>
+#include <atomic>
+
+namespace beam {
+namespace proto {
+
+	// I/O shards for the inbound node connections.
+	// Each shard runs its own reactor thread, which owns the sockets and does the reads/writes, SChannel decryption, MAC verification and framing.
+	// Complete plaintext messages are handed to the owner (node) thread, where they're deserialized and handled as usual.
+	// Socket migration isn't supported on Windows, there the connections stay in the owner thread.
+	class IoShards
+	{
+	public:
+
+		struct Cipher // inbound, once the duplex mode is established
+		{
+			AES::Encoder m_Enc;
+			AES::StreamCipher m_Cipher;
+			ECC::Hash::Mac m_HMac;
+		};
+
+		struct Shared // per-connection, accessed by both threads
+		{
+			std::atomic<size_t> m_Queued; // posted by the owner, not yet handed to the stream
+			std::atomic<size_t> m_Unsent; // last known stream state
+
+			Shared() :m_Queued(0) ,m_Unsent(0) {}
+		};
+
+		IoShards();
+		~IoShards();
+
+		void Start(uint32_t nShards); // from the owner reactor thread
+		void Stop();
+		bool IsRunning() const { return !m_vShards.empty(); }
+
+		// On success the stream is taken over. Otherwise it's left intact, and the caller should handle it in a standard way
+		std::unique_ptr<IoShardLink> Attach(io::TcpStream::Ptr&, NodeConnection&, ProtocolBase&);
+
+	private:
+
+		friend class IoShardLink;
+
+		struct Cmd
+		{
+			enum struct Type : uint8_t {
+				Open,
+				Write,
+				Duplex,
+				Close
+			};
+
+			Type m_Type = Type::Close;
+			uint64_t m_ID = 0;
+			uv_os_sock_t m_Socket = 0;
+			MsgHeader m_Hdr{ 0, 0, 0 }; // Open: expected protocol version
+			std::vector<std::pair<uint32_t, uint32_t> > m_vSizeLimits; // Open: min/max per msg type, min > max if not handled
+			io::SerializedMsg m_Data;
+			std::shared_ptr<Shared> m_pShared;
+			std::unique_ptr<Cipher> m_pCipher;
+		};
+
+		struct Evt
+		{
+			enum struct Type : uint8_t {
+				Msg,
+				IoError,
+				ProtoError
+			};
+
+			Type m_Type = Type::Msg;
+			uint64_t m_ID = 0;
+			uint8_t m_MsgType = 0;
+			uint32_t m_SizeWire = 0; // as in the header
+			uint32_t m_SizeBody = 0; // w/o MAC
+			int32_t m_Error = 0;
+			ByteBuffer m_Frame; // header + body + MAC
+		};
+
+		struct Stream;
+		struct Shard;
+
+		std::vector<std::unique_ptr<Shard> > m_vShards;
+		std::unique_ptr<RX<Evt> > m_pRx;
+		std::map<uint64_t, IoShardLink*> m_mapLinks;
+		uint64_t m_LastID = 0;
+		uint32_t m_iNextShard = 0;
+
+		void OnEvt(Evt&&);
+	};
+
+	class IoShardLink
+	{
+		friend class IoShards;
+
+		IoShards& m_This;
+		NodeConnection& m_Conn;
+		uint64_t m_ID;
+		uint32_t m_iShard;
+		io::Address m_Addr;
+		std::shared_ptr<IoShards::Shared> m_pShared;
+
+		void Post(IoShards::Cmd&&);
+
+	public:
+
+		IoShardLink(IoShards&, NodeConnection&);
+		~IoShardLink();
+
+		io::Result write_msg(const io::SerializedMsg&);
+		size_t get_Unsent() const;
+		const io::Address& get_PeerAddress() const { return m_Addr; }
+
+		void OnDuplex(const ProtocolPlus&); // resume inbound processing with decryption
+	};
+
+} // namespace proto
+} // namespace beam
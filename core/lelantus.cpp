@@ -117,28 +117,84 @@ void CmList::Import(MultiMac& mm, uint32_t iPos, uint32_t nCount)
 	}
 }
 
+bool CmList::ImportBatch(MultiMac& mm, uint32_t iPos, uint32_t nCount)
+{
+	const uint32_t iBatch = iPos / PreparedBatch::s_Size;
+	const uint32_t nOffset = iPos % PreparedBatch::s_Size;
+	std::setmin(nCount, PreparedBatch::s_Size - nOffset);
+
+	const PreparedBatch* pB = get_Prepared(iBatch);
+	if (!pB)
+	{
+		Import(mm, iPos, nCount);
+		return false;
+	}
+
+	for (mm.Reset(); static_cast<uint32_t>(mm.m_Casual) < nCount; mm.m_Casual++)
+	{
+		MultiMac::Casual::Fast& f = mm.m_pCasual[mm.m_Casual].U.F.get();
+		const Point::Native* pSrc = pB->m_ppPt[nOffset + mm.m_Casual];
+
+		for (uint32_t i = 0; i < MultiMac::Casual::Fast::nCount; i++)
+			f.m_pPt[i] = pSrc[i];
+		f.m_nNeeded = MultiMac::Casual::Fast::nCount;
+	}
+
+	mm.m_ReuseFlag = MultiMac::Reuse::UseGenerated;
+	return true;
+}
+
+bool CmList::Prepare(PreparedBatch& pb, uint32_t iBatch)
+{
+	Mode::Scope scope(Mode::Fast);
+
+	MultiMac_WithBufs<PreparedBatch::s_Size, 1> mm;
+	Import(mm, iBatch * PreparedBatch::s_Size, PreparedBatch::s_Size);
+	if (static_cast<uint32_t>(mm.m_Casual) < PreparedBatch::s_Size)
+		return false;
+
+	// calculation with zero factors just generates and normalizes the odd multiples
+	for (uint32_t i = 0; i < PreparedBatch::s_Size; i++)
+		mm.m_pKCasual[i] = Zero;
+
+	mm.m_ReuseFlag = MultiMac::Reuse::Generate;
+
+	Point::Native res;
+	mm.Calculate(res);
+
+	for (uint32_t i = 0; i < PreparedBatch::s_Size; i++)
+	{
+		const MultiMac::Casual::Fast& f = mm.m_pCasual[i].U.F.get();
+		for (uint32_t j = 0; j < MultiMac::Casual::Fast::nCount; j++)
+			pb.m_ppPt[i][j] = f.m_pPt[j];
+	}
+
+	return true;
+}
+
 void CmList::Calculate(Point::Native& res, uint32_t iPos, uint32_t nCount, const Scalar::Native* pKs)
 {
 	Mode::Scope scope(Mode::Fast);
 
-	const uint32_t nSizeNaggle = 128;
-	MultiMac_WithBufs<nSizeNaggle, 1> mm;
+	MultiMac_WithBufs<PreparedBatch::s_Size, 1> mm;
 
 	Point::Native comm;
 
-	while (true)
+	while (nCount)
 	{
-		Import(mm, iPos, std::min(nSizeNaggle, nCount));
+		uint32_t nPortion = std::min(nCount, PreparedBatch::s_Size - iPos % PreparedBatch::s_Size);
+
+		ImportBatch(mm, iPos, nPortion);
 		mm.m_pKCasual = Cast::NotConst(pKs + iPos);
 
 		mm.Calculate(comm);
 		res += comm;
 
-		iPos += mm.m_Casual;
-		nCount -= mm.m_Casual;
-
-		if (!nCount || (static_cast<uint32_t>(mm.m_Casual) < nSizeNaggle))
+		if (static_cast<uint32_t>(mm.m_Casual) < nPortion)
 			break;
+
+		iPos += nPortion;
+		nCount -= nPortion;
 	}
 }
 
@@ -574,8 +630,7 @@ void Prover::ExtractG_Part(GB* pGB, uint32_t i0, uint32_t i1)
 		gb.m_kBias = Zero;
 	}
 
-	const uint32_t nSizeNaggle = 128;
-	MultiMac_WithBufs<nSizeNaggle, 1> mm;
+	MultiMac_WithBufs<CmList::PreparedBatch::s_Size, 1> mm;
 
 	Point::Native comm;
 
@@ -584,8 +639,9 @@ void Prover::ExtractG_Part(GB* pGB, uint32_t i0, uint32_t i1)
 
 	while (i0 < i1)
 	{
-		m_List.Import(mm, i0, std::min(nSizeNaggle, i1 - i0));
-		mm.m_ReuseFlag = MultiMac::Reuse::Generate;
+		uint32_t nPortion = std::min(i1 - i0, CmList::PreparedBatch::s_Size - i0 % CmList::PreparedBatch::s_Size);
+		if (!m_List.ImportBatch(mm, i0, nPortion))
+			mm.m_ReuseFlag = MultiMac::Reuse::Generate;
 
 		Scalar::Native* pP = m_p;
 		for (uint32_t k = 0; k < m_Cfg.M; k++)
@@ -605,10 +661,10 @@ void Prover::ExtractG_Part(GB* pGB, uint32_t i0, uint32_t i1)
 			pP += N;
 		}
 
-		i0 += mm.m_Casual;
-
-		if (static_cast<uint32_t>(mm.m_Casual) < nSizeNaggle)
+		if (static_cast<uint32_t>(mm.m_Casual) < nPortion)
 			break;
+
+		i0 += nPortion;
 	}
 }
 
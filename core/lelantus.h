@@ -20,9 +20,22 @@ namespace Sigma {
 
 	struct CmList
 	{
+		// Odd multiples of a complete aligned batch of elements, brought to a common denominator (Fast mode only).
+		// Can be reused across calculations, as long as the batch elements don't change
+		struct PreparedBatch
+		{
+			static const uint32_t s_Size = 128;
+			typedef ECC::MultiMac::Casual::Fast Fast;
+
+			ECC::Point::Native m_ppPt[s_Size][Fast::nCount];
+		};
+
 		virtual bool get_At(ECC::Point::Storage&, uint32_t iIdx) = 0;
+		virtual const PreparedBatch* get_Prepared(uint32_t /* iBatch */) { return nullptr; }
 
 		void Import(ECC::MultiMac&, uint32_t iPos, uint32_t nCount);
+		bool ImportBatch(ECC::MultiMac&, uint32_t iPos, uint32_t nCount); // Fast mode only, doesn't cross the batch boundary. Returns true if the prepared batch was used
+		bool Prepare(PreparedBatch&, uint32_t iBatch); // fails if the batch is incomplete
 		void Calculate(ECC::Point::Native&, uint32_t iPos, uint32_t nCount, const ECC::Scalar::Native* pKs);
 	};
 
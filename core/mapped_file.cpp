@@ -317,6 +317,11 @@ namespace beam
 		}
 	}
 
+	bool MappedFile::IsReserved(uint32_t iBank, uint32_t nMinFree)
+	{
+		return get_Bank(iBank).m_Free >= nMinFree;
+	}
+
 	void* MappedFile::Allocate(uint32_t iBank, uint32_t nSize)
 	{
 		assert(nSize >= sizeof(Offset));
@@ -344,4 +349,171 @@ namespace beam
 		b.m_Free++;
 	}
 
+	////////////////////////////////////////
+	// MappedArray
+
+	bool MappedArray::Open(const char* sz, uint32_t nSig, uint32_t nElement)
+	{
+		static_assert(sizeof(Hdr) <= s_Data, "");
+		assert(nElement);
+
+		Close();
+		m_Raw.Open(sz);
+
+		bool bValid =
+			(m_Raw.m_nMapping >= s_Data) &&
+			(get_Hdr().m_Sig == nSig) &&
+			(get_Hdr().m_nElement == nElement) &&
+			!get_Hdr().m_Dirty;
+
+		if (bValid)
+		{
+			m_nElement = nElement;
+			bValid = (get_Capacity() >= get_Count());
+		}
+
+		if (!bValid)
+		{
+			m_Raw.CloseMapping();
+			m_Raw.Resize(0);
+			m_Raw.Resize(s_Data);
+			m_Raw.OpenMapping();
+
+			Hdr& hdr = get_Hdr();
+			hdr.m_Sig = nSig;
+			hdr.m_nElement = nElement;
+			hdr.m_Count = 0;
+		}
+
+		m_nElement = nElement;
+		get_Hdr().m_Dirty = 1;
+
+		return bValid;
+	}
+
+	void MappedArray::Close()
+	{
+		if (IsOpen())
+		{
+			get_Hdr().m_Dirty = 0;
+			m_nElement = 0;
+		}
+
+		m_Raw.Close();
+	}
+
+	uint64_t MappedArray::get_Capacity() const
+	{
+		return (m_Raw.m_nMapping - s_Data) / m_nElement;
+	}
+
+	void MappedArray::Reserve(uint64_t nCount)
+	{
+		uint64_t nCap = get_Capacity();
+		if (nCap >= nCount)
+			return;
+
+		// grow by at least 1/8, page-aligned
+		std::setmax(nCount, nCap + (nCap >> 3));
+		Offset n1 = AlignUp(s_Data + nCount * m_nElement, m_Raw.s_PageSize);
+
+		m_Raw.CloseMapping();
+		m_Raw.Resize(n1);
+		m_Raw.OpenMapping();
+	}
+
+	void MappedArray::Resize(uint64_t nCount)
+	{
+		assert(IsOpen());
+		Reserve(nCount);
+		get_Hdr().m_Count = nCount;
+	}
+
+	////////////////////////////////////////
+	// MappedLog
+	bool MappedLog::Open(const char* sz, uint32_t nSig)
+	{
+		static_assert(sizeof(Hdr) <= s_Data, "");
+
+		Close();
+		m_Raw.Open(sz);
+
+		bool bValid =
+			(m_Raw.m_nMapping >= s_Data) &&
+			(get_Hdr().m_Sig == nSig) &&
+			(get_Hdr().m_Size >= s_Data) &&
+			(get_Hdr().m_Size <= m_Raw.m_nMapping);
+
+		if (!bValid)
+		{
+			m_Raw.CloseMapping();
+			m_Raw.Resize(0);
+			m_Raw.Resize(s_Data);
+			m_Raw.OpenMapping();
+
+			Hdr& hdr = get_Hdr();
+			hdr.m_Sig = nSig;
+			hdr.m_Reserved = 0;
+			hdr.m_Size = s_Data;
+		}
+
+		m_Flushed = get_Hdr().m_Size;
+		return bValid;
+	}
+
+	void MappedLog::Close()
+	{
+		if (IsOpen())
+			Flush();
+
+		m_Raw.Close();
+	}
+
+	MappedLog::Offset MappedLog::Append(const void* p, uint32_t n)
+	{
+		assert(IsOpen());
+
+		Offset n0 = get_Hdr().m_Size;
+		Offset n1 = n0 + n;
+
+		if (n1 > m_Raw.m_nMapping)
+		{
+			// grow by at least 1/8, page-aligned
+			Offset nNew = std::max(n1, m_Raw.m_nMapping + (m_Raw.m_nMapping >> 3));
+			nNew = AlignUp(nNew, m_Raw.s_PageSize);
+
+			m_Raw.CloseMapping();
+			m_Raw.Resize(nNew);
+			m_Raw.OpenMapping();
+		}
+
+		memcpy(m_Raw.m_pMapping + n0, p, n);
+		get_Hdr().m_Size = n1;
+
+		return n0 - s_Data;
+	}
+
+	void MappedLog::Flush()
+	{
+		assert(IsOpen());
+
+		Offset n1 = get_Hdr().m_Size;
+		if (m_Flushed == n1)
+			return;
+
+		// the data first, then the header that references it
+		Offset n0 = m_Flushed & ~Offset(m_Raw.s_PageSize - 1);
+
+#ifdef WIN32
+		test_SysRet(!FlushViewOfFile(m_Raw.m_pMapping + n0, (size_t) (n1 - n0)), "FlushViewOfFile");
+		test_SysRet(!FlushViewOfFile(m_Raw.m_pMapping, sizeof(Hdr)), "FlushViewOfFile");
+		test_SysRet(!FlushFileBuffers(m_Raw.m_hFile), "FlushFileBuffers");
+#else // WIN32
+		test_SysRet(msync(m_Raw.m_pMapping + n0, (size_t) (n1 - n0), MS_SYNC) != 0, "msync");
+		test_SysRet(msync(m_Raw.m_pMapping, sizeof(Hdr), MS_SYNC) != 0, "msync");
+#endif // WIN32
+
+		m_Flushed = n1;
+	}
+
 } // namespace beam
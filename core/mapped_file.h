@@ -115,6 +115,100 @@ namespace beam
 		void Free(uint32_t iBank, void*);
 
 		void EnsureReserve(uint32_t iBank, uint32_t nSize, uint32_t nMinFree);
+		bool IsReserved(uint32_t iBank, uint32_t nMinFree); // no need to grow
+	};
+
+	// Append-only array of fixed-size elements, mapped as a whole, for contiguous range access.
+	// Grows in chunks, shrinking only updates the count.
+	class MappedArray
+	{
+	public:
+
+		typedef MappedFileRaw::Offset Offset;
+
+	private:
+
+		struct Hdr
+		{
+			uint32_t m_Sig;
+			uint32_t m_nElement;
+			uint64_t m_Count;
+			uint32_t m_Dirty; // set while modified, reset on close
+		};
+
+		static const Offset s_Data = 0x40;
+
+		MappedFileRaw m_Raw;
+		uint32_t m_nElement = 0;
+
+		Hdr& get_Hdr() const { return m_Raw.get_At<Hdr>(0); }
+		uint64_t get_Capacity() const;
+		void Reserve(uint64_t);
+
+	public:
+
+		// returns false if the file is new, incompatible, or wasn't closed properly. In this case it's reset
+		bool Open(const char* sz, uint32_t nSig, uint32_t nElement);
+		void Close();
+		bool IsOpen() const { return !!m_nElement; }
+
+		uint64_t get_Count() const { return get_Hdr().m_Count; }
+		void Resize(uint64_t);
+
+		void* get_At(uint64_t i) const
+		{
+			assert(i < get_Count());
+			return m_Raw.m_pMapping + s_Data + i * m_nElement;
+		}
+
+		template <typename T> T* get_As(uint64_t i) const
+		{
+			assert(sizeof(T) == m_nElement);
+			return reinterpret_cast<T*>(get_At(i));
+		}
+	};
+
+	// Append-only log of variable-size records, mapped as a whole. The records are addressed by their offsets, which must be kept externally.
+	// Grows in chunks. Data is never modified once appended.
+	class MappedLog
+	{
+	public:
+
+		typedef MappedFileRaw::Offset Offset;
+
+	private:
+
+		struct Hdr
+		{
+			uint32_t m_Sig;
+			uint32_t m_Reserved;
+			Offset m_Size; // including the header
+		};
+
+		static const Offset s_Data = 0x40;
+
+		MappedFileRaw m_Raw;
+		Offset m_Flushed = 0;
+
+		Hdr& get_Hdr() const { return m_Raw.get_At<Hdr>(0); }
+
+	public:
+
+		// returns false if the file is new or incompatible. In this case it's reset
+		bool Open(const char* sz, uint32_t nSig);
+		void Close();
+		bool IsOpen() const { return !!m_Raw.m_pMapping; }
+
+		Offset get_Size() const { return get_Hdr().m_Size - s_Data; } // data only
+
+		Offset Append(const void*, uint32_t);
+		void Flush(); // make the appended data durable
+
+		const uint8_t* get_At(Offset n, uint32_t nSize) const
+		{
+			assert(n + nSize <= get_Size());
+			return m_Raw.m_pMapping + s_Data + n;
+		}
 	};
 
 } // namespace beam
@@ -16,6 +16,7 @@
 #include "core/serialization_adapters.h"
 #include "core/ecc_native.h"
 #include "proto.h"
+#include "io_shards.h"
 #include "../utility/logger.h"
 
 namespace beam {
@@ -342,7 +343,7 @@ NodeConnection::NodeConnection()
     ,m_LoginFlags(0)
 {
 #define THE_MACRO(code, msg) \
-    m_Protocol.add_message_handler<NodeConnection, msg##_NoInit, &NodeConnection::OnMsgInternal>(uint8_t(code), this, 0, 1024*1024*10);
+    m_Protocol.add_message_handler<NodeConnection, msg##_NoInit, &NodeConnection::OnMsgInternal>(uint8_t(code), this, 0, s_MaxMsgSize);
 
     BeamNodeMsgsAll(THE_MACRO)
 #undef THE_MACRO
@@ -363,6 +364,7 @@ void NodeConnection::Reset()
 
 	m_RulesCfgSent = false;
     m_Connection = NULL;
+    m_pShardLink.reset();
     m_pAsyncFail = NULL;
     m_LoginFlags = 0;
 
@@ -462,9 +464,18 @@ void NodeConnection::OnIoErr(io::ErrorCode err)
 
 size_t NodeConnection::get_Unsent() const
 {
+	if (m_pShardLink)
+		return m_pShardLink->get_Unsent();
 	return m_Connection ? m_Connection->get_Unsent() : 0;
 }
 
+io::Address NodeConnection::get_PeerAddress() const
+{
+	if (m_pShardLink)
+		return m_pShardLink->get_PeerAddress();
+	return m_Connection ? m_Connection->peer_address() : io::Address();
+}
+
 void NodeConnection::on_protocol_error(uint64_t, ProtocolError error)
 {
     Reset();
@@ -518,7 +529,7 @@ void NodeConnection::ThrowUnexpected(const char* sz, NodeProcessingException::Ty
 
 void NodeConnection::Connect(const io::Address& addr, const boost::optional<io::Address>& proxyAddr)
 {
-    assert(!m_Connection && !m_ConnectPending);
+    assert(!m_Connection && !m_pShardLink && !m_ConnectPending);
 
     io::Result res;
     if (proxyAddr)
@@ -543,7 +554,7 @@ void NodeConnection::Connect(const io::Address& addr, const boost::optional<io::
 
 void NodeConnection::Accept(io::TcpStream::Ptr&& newStream)
 {
-    assert(!m_Connection && !m_ConnectPending);
+    assert(!m_Connection && !m_pShardLink && !m_ConnectPending);
 
     newStream->enable_keepalive(Rules::get().DA.get_Target_s() + 1); // it should be comparable to the block rate
 
@@ -556,9 +567,46 @@ void NodeConnection::Accept(io::TcpStream::Ptr&& newStream)
         );
 }
 
+void NodeConnection::Accept(IoShards& s, io::TcpStream::Ptr&& newStream)
+{
+    assert(!m_Connection && !m_pShardLink && !m_ConnectPending);
+
+    if (s.IsRunning())
+    {
+        newStream->enable_keepalive(Rules::get().DA.get_Target_s() + 1);
+
+        m_pShardLink = s.Attach(newStream, *this, m_Protocol);
+        if (m_pShardLink)
+            return;
+    }
+
+    Accept(std::move(newStream));
+}
+
+void NodeConnection::OnShardMsg(uint8_t nType, uint32_t nSizeWire, const uint8_t* p, uint32_t nSize)
+{
+    uint64_t id = uint64_t(this);
+
+    MsgHeader hdr = m_Protocol.get_default_header();
+    hdr.reset(nType, nSizeWire);
+
+    if (m_Protocol.approve_msg_header(id, hdr))
+        m_Protocol.on_new_message(id, nType, p, nSize);
+}
+
+void NodeConnection::OnShardIoErr(io::ErrorCode err)
+{
+    on_connection_error(uint64_t(this), err);
+}
+
+void NodeConnection::OnShardProtoErr(ProtocolError err)
+{
+    on_protocol_error(uint64_t(this), err);
+}
+
 bool NodeConnection::IsLive() const
 {
-    return m_Connection && !m_pAsyncFail;
+    return (m_Connection || m_pShardLink) && !m_pAsyncFail;
 }
 
 #define THE_MACRO(code, msg) \
@@ -570,7 +618,7 @@ void NodeConnection::SendRaw(const msg& v) \
     MsgSerializer& ser = m_Protocol.serializeNoFinalize(m_SerializeCache, uint8_t(code), v); \
     m_Protocol.Encrypt(m_SerializeCache, ser); \
     OnTraficOut(msg::s_Code); \
-    io::Result res = m_Connection->write_msg(m_SerializeCache); \
+    io::Result res = m_pShardLink ? m_pShardLink->write_msg(m_SerializeCache) : m_Connection->write_msg(m_SerializeCache); \
     m_SerializeCache.clear(); \
 \
     TestIoResultAsync(res); \
@@ -762,7 +810,7 @@ void NodeConnection::OnMsg(Login&& msg)
 
                 Height hScheme = pFork[1].m_Height;
 
-                BEAM_LOG_WARNING() << "Peer " << m_Connection->peer_address() << " incompatible with HF " << (nMyFork + 1) << ", Height=" << hScheme;
+                BEAM_LOG_WARNING() << "Peer " << get_PeerAddress() << " incompatible with HF " << (nMyFork + 1) << ", Height=" << hScheme;
 
                 Height hMinScheme = get_MinPeerFork();
                 if (hMinScheme >= hScheme)
@@ -771,7 +819,7 @@ void NodeConnection::OnMsg(Login&& msg)
 
             if (i + 1 != msg.m_Cfgs.size())
             {
-                BEAM_LOG_WARNING() << "Peer " << m_Connection->peer_address() << " has unknown fork: " << msg.m_Cfgs[i + 1];
+                BEAM_LOG_WARNING() << "Peer " << get_PeerAddress() << " has unknown fork: " << msg.m_Cfgs[i + 1];
             }
 
 			OnLoginInternal(std::move(msg));
@@ -808,7 +856,7 @@ void NodeConnection::OnLoginInternal(Login&& msg)
     if (LoginFlags::Extension::Maximum != nExt)
     {
         bool bNewer = (nExt > LoginFlags::Extension::Maximum);
-        BEAM_LOG_WARNING() << "Peer " << m_Connection->peer_address() << " uses " << (bNewer ? "newer" : "older") << " ext: " << nExt;
+        BEAM_LOG_WARNING() << "Peer " << get_PeerAddress() << " uses " << (bNewer ? "newer" : "older") << " ext: " << nExt;
 
         if (nExt < LoginFlags::Extension::Minimum)
             ThrowUnexpected("Legacy", NodeProcessingException::Type::Incompatible);
@@ -823,6 +871,9 @@ void NodeConnection::OnMsg(SChannelReady&& msg)
         ThrowUnexpected();
 
     m_Protocol.m_Mode = ProtocolPlus::Mode::Duplex;
+
+    if (m_pShardLink)
+        m_pShardLink->OnDuplex(m_Protocol);
 }
 
 void NodeConnection::ProveID(ECC::Scalar::Native& sk, uint8_t nIDType)
@@ -92,6 +92,9 @@ namespace proto {
     macro(ECC::Point, Utxo) \
     macro(Height, MaturityMin) /* set to non-zero in case the result is too big, and should be retrieved within multiple queries */
 
+#define BeamNodeMsg_GetProofUtxoBatch(macro) \
+    macro(std::vector<ECC::Point>, Utxos)
+
 #define BeamNodeMsg_GetProofShieldedOutp(macro) \
     macro(ECC::Point, SerialPub)
 
@@ -120,6 +123,10 @@ namespace proto {
 #define BeamNodeMsg_ProofUtxo(macro) \
     macro(std::vector<Input::Proof>, Proofs)
 
+#define BeamNodeMsg_ProofUtxoBatch(macro) \
+    macro(std::vector<std::vector<Input::Proof> >, Proofs) /* without the common part */ \
+    macro(Merkle::Proof, Common)
+
 #define BeamNodeMsg_ProofShieldedOutp(macro) \
     macro(ECC::Point, Commitment) \
     macro(TxoID, ID) \
@@ -275,6 +282,12 @@ namespace proto {
     macro(ByteBuffer, KeyMax) \
     macro(bool, bSkipMin)
 
+#define BeamNodeMsg_ContractVarsEnumAt(macro) \
+    macro(ByteBuffer, KeyMin) \
+    macro(ByteBuffer, KeyMax) \
+    macro(bool, bSkipMin) \
+    macro(Height, Height)
+
 #define BeamNodeMsg_ContractVars(macro) \
     macro(ByteBuffer, Result) \
     macro(bool, bMore)
@@ -372,6 +385,8 @@ namespace proto {
     macro(0x1a, ProofKernel) \
     macro(0x1b, GetProofUtxo) \
     macro(0x1c, ProofUtxo) \
+    macro(0x4f, GetProofUtxoBatch) \
+    macro(0x50, ProofUtxoBatch) \
     macro(0x1d, GetProofChainWork) \
     macro(0x1e, ProofChainWork) \
     macro(0x22, GetCommonState) \
@@ -390,6 +405,7 @@ namespace proto {
     macro(0x2a, GetShieldedList) \
     macro(0x3d, ShieldedList) \
     macro(0x1f, ContractVarsEnum) \
+    macro(0x4e, ContractVarsEnumAt) \
     macro(0x2d, ContractVars) \
     macro(0x40, ContractLogsEnum) \
     macro(0x41, ContractLogs) \
@@ -461,9 +477,12 @@ namespace proto {
             // 9 - Dependent txs
             // 10- GetAssetsListAt
             // 11- GetProofKernel3
+            // 12- ContractVarsEnumAt
+            // 13- GetProofUtxoBatch
+            // 14- Compact block body
 
             static const uint32_t Minimum = 8;
-            static const uint32_t Maximum = 11;
+            static const uint32_t Maximum = 14;
 
             static void set(uint32_t& nFlags, uint32_t nExt);
             static uint32_t get(uint32_t nFlags);
@@ -481,6 +500,7 @@ namespace proto {
     };
 
 	static const uint32_t g_HdrPackMaxSize = 2048; // about 400K
+	static const uint32_t g_ProofUtxoBatchMaxSize = 256;
 
     struct Event
     {
@@ -601,6 +621,7 @@ namespace proto {
 		static const uint8_t Full = 0; // default
 		static const uint8_t None = 1;
 		static const uint8_t Recovery1 = 2; // part suitable for recovery (version 1). Suitable for Outputs
+		static const uint8_t Compact = 3; // non-coinbase outputs are replaced by their hashes, to be restored from the tx pool
 
 	};
 
@@ -812,11 +833,15 @@ namespace proto {
         Type m_type;
     };
 
+    class IoShards;
+    class IoShardLink;
+
     class NodeConnection
         :public INodeMsgHandler
     {
         ProtocolPlus m_Protocol;
         std::unique_ptr<Connection> m_Connection;
+        std::unique_ptr<IoShardLink> m_pShardLink; // instead of m_Connection, if the connection is served by an I/O shard
         io::AsyncEvent::Ptr m_pAsyncFail;
         bool m_ConnectPending;
 		bool m_RulesCfgSent;
@@ -847,6 +872,8 @@ namespace proto {
         uint32_t m_LoginFlags;
         uint32_t get_Ext() const;
 
+        static const uint32_t s_MaxMsgSize = 1024 * 1024 * 10;
+
         NodeConnection();
         virtual ~NodeConnection();
         void Reset();
@@ -855,6 +882,7 @@ namespace proto {
 
         void Connect(const io::Address& addr, const boost::optional<io::Address>& proxyAddr = boost::none);
         void Accept(io::TcpStream::Ptr&& newStream);
+        void Accept(IoShards&, io::TcpStream::Ptr&& newStream); // falls back to the standard mode if the stream can't be moved to a shard
 
         // Secure-channel-specific
         void SecureConnect(); // must be connected already
@@ -891,6 +919,12 @@ namespace proto {
         bool IsLoginSent() const { return m_RulesCfgSent; } // at least once
 
         const Connection* get_Connection() { return m_Connection.get(); }
+        io::Address get_PeerAddress() const;
+
+        // events from the I/O shard
+        void OnShardMsg(uint8_t nType, uint32_t nSizeWire, const uint8_t* p, uint32_t nSize);
+        void OnShardIoErr(io::ErrorCode);
+        void OnShardProtoErr(ProtocolError);
 
         virtual void OnConnectedSecure() {}
 
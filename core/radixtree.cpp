@@ -119,18 +119,23 @@ void RadixTree::CursorBase::InvalidateElement()
 void RadixTree::ReplaceTip(CursorBase& cu, Node* pNew)
 {
 	assert(cu.m_nPtrs);
-	Node* pOld = cu.m_pp[cu.m_nPtrs - 1];
+	ReplaceNode(cu, cu.m_nPtrs - 1, pNew);
+}
+
+void RadixTree::ReplaceNode(CursorBase& cu, uint16_t iPos, Node* pNew)
+{
+	Node* pOld = cu.m_pp[iPos];
 	assert(pOld);
 
-	if (cu.m_nPtrs > 1)
+	if (iPos)
 	{
-		Joint* pPrev = Cast::Up<Joint>(cu.m_pp[cu.m_nPtrs - 2]);
+		Joint* pPrev = Cast::Up<Joint>(cu.m_pp[iPos - 1]);
 		assert(pPrev);
 
 		for (size_t i = 0; ; i++)
 		{
 			assert(i < _countof(pPrev->m_ppC));
-			if (pPrev->m_ppC[i].get_Strict() == pOld)
+			if (pPrev->m_ppC[i].get() == pOld) // the other child may be already detached (during Delete)
 			{
 				pPrev->m_ppC[i].set(pNew);
 				break;
@@ -143,6 +148,63 @@ void RadixTree::ReplaceTip(CursorBase& cu, Node* pNew)
 	}
 }
 
+RadixTree::Joint* RadixTree::CloneJoint(const Joint& x)
+{
+	Joint* p = CreateJoint();
+
+	for (size_t i = 0; i < _countof(x.m_ppC); i++)
+		p->m_ppC[i].set(x.m_ppC[i].get());
+
+	p->m_pKeyPtr.set_Strict(x.m_pKeyPtr.get_Strict());
+	return p;
+}
+
+RadixTree::Node* RadixTree::CloneNode(CursorBase& cu, uint16_t iPos)
+{
+	// all the ancestors must already be writable
+	Node* pOld = cu.m_pp[iPos];
+	Node* pNew;
+
+	if (Node::s_Leaf & pOld->m_Bits)
+	{
+		Leaf& xOld = Cast::Up<Leaf>(*pOld);
+		Leaf* pLeaf = CloneLeaf(xOld);
+		pNew = pLeaf;
+
+		// only the ancestors may reference its key
+		const uint8_t* pKeyOld = GetLeafKey(xOld);
+		const uint8_t* pKeyNew = GetLeafKey(*pLeaf);
+
+		for (uint16_t j = 0; j < iPos; j++)
+		{
+			Joint& x = Cast::Up<Joint>(*cu.m_pp[j]);
+			if (x.m_pKeyPtr.get_Strict() == pKeyOld)
+				x.m_pKeyPtr.set_Strict(pKeyNew);
+		}
+	}
+	else
+		pNew = CloneJoint(Cast::Up<Joint>(*pOld));
+
+	pNew->m_Bits = pOld->m_Bits;
+
+	ReplaceNode(cu, iPos, pNew);
+	cu.m_pp[iPos] = pNew;
+
+	if (Node::s_Leaf & pOld->m_Bits)
+		DeleteClonedLeaf(Cast::Up<Leaf>(pOld));
+	else
+		DeleteJoint(Cast::Up<Joint>(pOld));
+
+	return pNew;
+}
+
+void RadixTree::MakeWritable(CursorBase& cu)
+{
+	for (uint16_t i = 0; i < cu.m_nPtrs; i++)
+		if (IsShared(cu.m_pp[i]))
+			CloneNode(cu, i);
+}
+
 bool RadixTree::Goto(CursorBase& cu, const uint8_t* pKey, uint16_t nBits) const
 {
 	Node* p = get_Root();
@@ -208,6 +270,8 @@ RadixTree::Leaf* RadixTree::Find(CursorBase& cu, const uint8_t* pKey, uint16_t n
 {
 	if (Goto(cu, pKey, nBits))
 	{
+		if (bCreate)
+			MakeWritable(cu); // the caller is about to modify it
 		bCreate = false;
 		return &cu.get_Leaf();
 	}
@@ -218,6 +282,7 @@ RadixTree::Leaf* RadixTree::Find(CursorBase& cu, const uint8_t* pKey, uint16_t n
 		return nullptr;
 
 	OnDirty();
+	MakeWritable(cu);
 
 	Leaf* pN = CreateLeaf();
 
@@ -290,6 +355,7 @@ void RadixTree::Delete(CursorBase& cu)
 
 	assert(cu.m_nPtrs);
 
+	MakeWritable(cu);
 	cu.InvalidateElement();
 
 	Leaf* p = Cast::Up<Leaf>(cu.m_pp[cu.m_nPtrs - 1]);
@@ -313,6 +379,13 @@ void RadixTree::Delete(CursorBase& cu)
 			Node* pN = pPrev->m_ppC[i].get();
 			if (pN)
 			{
+				if (IsShared(pN))
+				{
+					// its bits are about to change
+					cu.m_pp[cu.m_nPtrs] = pN;
+					pN = CloneNode(cu, cu.m_nPtrs);
+				}
+
 				const uint8_t* pKey1 = get_NodeKey(*pN);
 				assert(pKey1 != pKeyDead);
 
@@ -523,6 +596,13 @@ const Merkle::Hash& RadixHashTree::get_Hash(Node& n, Merkle::Hash& hv)
 	return x.m_Hash;
 }
 
+RadixTree::Joint* RadixHashTree::CloneJoint(const Joint& x)
+{
+	MyJoint* p = Cast::Up<MyJoint>(RadixTree::CloneJoint(x));
+	p->m_Hash = Cast::Up<MyJoint>(x).m_Hash;
+	return p;
+}
+
 void RadixHashTree::get_Proof(Merkle::Proof& proof, const CursorBase& cu)
 {
 	uint16_t n = cu.get_Depth();
@@ -603,12 +683,59 @@ void UtxoTree::DeleteLeaf(Leaf* p)
 {
 	MyLeaf& x = *Cast::Up<MyLeaf>(p);
 
-	while (x.IsExt())
-		PopID(x);
+	if (x.IsExt())
+	{
+		// release as-is, w/o modification (may be shared)
+		MyLeaf::IDQueue* pQueue = x.m_pIDs.get_Strict();
+
+		for (MyLeaf::IDNode* pN = pQueue->m_pTop.get(); pN; )
+		{
+			MyLeaf::IDNode* pNext = pN->m_pNext.get();
+			DeleteIDNode(pN);
+			pN = pNext;
+		}
+
+		DeleteIDQueue(pQueue);
+	}
 
 	DeleteEmptyLeaf(p);
 }
 
+RadixTree::Leaf* UtxoTree::CloneLeaf(const Leaf& x0)
+{
+	const MyLeaf& x = Cast::Up<MyLeaf>(x0);
+	MyLeaf* p = Cast::Up<MyLeaf>(CreateLeaf());
+
+	p->m_Key = x.m_Key;
+
+	if (x.IsExt())
+		p->m_pIDs.set_Strict(x.m_pIDs.get_Strict()); // the queue is cloned only when modified
+	else
+		p->m_ID = x.m_ID;
+
+	return p;
+}
+
+UtxoTree::MyLeaf::IDQueue& UtxoTree::get_WritableIDs(MyLeaf& x)
+{
+	assert(!IsShared(&x));
+	MyLeaf::IDQueue* pQueue = x.m_pIDs.get_Strict();
+
+	if (IsShared(pQueue))
+	{
+		// the nodes are never modified in-place, it's enough to clone the queue header
+		MyLeaf::IDQueue* pNew = CreateIDQueue();
+		pNew->m_Count = pQueue->m_Count;
+		pNew->m_pTop.set(pQueue->m_pTop.get());
+
+		x.m_pIDs.set_Strict(pNew);
+		DeleteIDQueue(pQueue);
+		pQueue = pNew;
+	}
+
+	return *pQueue;
+}
+
 void UtxoTree::PushID(TxoID id, MyLeaf& x)
 {
 	if (!x.IsExt())
@@ -626,7 +753,7 @@ void UtxoTree::PushID(TxoID id, MyLeaf& x)
 		PushIDRaw(val, *pQueue);
 	}
 
-	PushIDRaw(id, *x.m_pIDs.get_Strict());
+	PushIDRaw(id, get_WritableIDs(x));
 }
 
 void UtxoTree::PushIDRaw(TxoID id, MyLeaf::IDQueue& q)
@@ -658,7 +785,7 @@ TxoID UtxoTree::PopIDRaw(MyLeaf::IDQueue& q)
 TxoID UtxoTree::PopID(MyLeaf& x)
 {
 	assert(x.IsExt());
-	MyLeaf::IDQueue& q = *x.m_pIDs.get_Strict();
+	MyLeaf::IDQueue& q = get_WritableIDs(x);
 
 	TxoID ret = PopIDRaw(q);
 
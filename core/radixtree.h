@@ -95,6 +95,14 @@ protected:
 	virtual void DeleteJoint(Joint*) = 0;
 	virtual void DeleteLeaf(Leaf*) = 0;
 
+	// Copy-on-write, for read-only snapshots. Objects that may be referenced by a snapshot are reported as shared.
+	// Shared nodes are never modified in-place: they're cloned, and the originals are released via the standard Delete methods,
+	// the derived class is responsible to defer the actual deletion.
+	virtual bool IsShared(const void*) const { return false; }
+	virtual Joint* CloneJoint(const Joint&);
+	virtual Leaf* CloneLeaf(const Leaf&) { assert(false); return nullptr; } // must be overridden if nodes may be shared
+	virtual void DeleteClonedLeaf(Leaf* p) { DeleteLeaf(p); } // its contents are now owned by the clone
+
 public:
 
 	RadixTree();
@@ -142,6 +150,8 @@ public:
 
 	void Delete(CursorBase& cu);
 
+	void MakeWritable(CursorBase& cu); // clone the shared nodes on the path. Find() does this implicitly if bCreate is requested
+
 	struct ITraveler
 	{
 		CursorBase* m_pCu; // set it to a valid cursor instance to get the cursor of the element during traverse.
@@ -171,6 +181,8 @@ private:
 
 	void DeleteNode(Node*);
 	void ReplaceTip(CursorBase& cu, Node* pNew);
+	void ReplaceNode(CursorBase& cu, uint16_t iPos, Node* pNew);
+	Node* CloneNode(CursorBase& cu, uint16_t iPos);
 	bool Traverse(const Node&, ITraveler&) const;
 
 	static int Cmp(const uint8_t* pKey, const uint8_t* pThreshold, uint16_t n0, uint16_t dn);
@@ -193,6 +205,7 @@ protected:
 	// RadixTree
 	Joint* CreateJoint() override { return new MyJoint; }
 	void DeleteJoint(Joint* p) override { delete Cast::Up<MyJoint>(p); }
+	Joint* CloneJoint(const Joint&) override;
 
 	const Merkle::Hash& get_Hash(Node&, Merkle::Hash&);
 
@@ -336,6 +349,8 @@ protected:
 	uint8_t* GetLeafKey(const Leaf& x) const override { return Cast::Up<MyLeaf>(Cast::NotConst(x)).m_Key.V.m_pData; }
 	void DeleteLeaf(Leaf* p) override;
 	const Merkle::Hash& get_LeafHash(Node&, Merkle::Hash&) override;
+	Leaf* CloneLeaf(const Leaf&) override;
+	void DeleteClonedLeaf(Leaf* p) override { DeleteEmptyLeaf(p); }
 
 	virtual MyLeaf::IDQueue* CreateIDQueue() { return new MyLeaf::IDQueue; }
 	virtual void DeleteIDQueue(MyLeaf::IDQueue* p) { delete p; }
@@ -364,6 +379,7 @@ protected:
 
 	void PushIDRaw(TxoID, MyLeaf::IDQueue&);
 	TxoID PopIDRaw(MyLeaf::IDQueue&);
+	MyLeaf::IDQueue& get_WritableIDs(MyLeaf&);
 };
 
 } // namespace beam
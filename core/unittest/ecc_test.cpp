@@ -1620,6 +1620,46 @@ void TestAES()
 
 	sd.dec.Proceed(pBuf, pBuf); // inplace decode
 	verify_test(!memcmp(pBuf, pPlaintext, sizeof(pPlaintext)));
+
+	// CTR mode, NIST SP 800-38A, F.5.5. Both sw and hw paths, the data fed in different portions
+	const uint8_t pPlaintextCtr[AES::s_BlockSize * 4] = {
+		0x6B,0xC1,0xBE,0xE2,0x2E,0x40,0x9F,0x96,0xE9,0x3D,0x7E,0x11,0x73,0x93,0x17,0x2A,
+		0xAE,0x2D,0x8A,0x57,0x1E,0x03,0xAC,0x9C,0x9E,0xB7,0x6F,0xAC,0x45,0xAF,0x8E,0x51,
+		0x30,0xC8,0x1C,0x46,0xA3,0x5C,0xE4,0x11,0xE5,0xFB,0xC1,0x19,0x1A,0x0A,0x52,0xEF,
+		0xF6,0x9F,0x24,0x45,0xDF,0x4F,0x9B,0x17,0xAD,0x2B,0x41,0x7B,0xE6,0x6C,0x37,0x10
+	};
+
+	const uint8_t pCiphertextCtr[AES::s_BlockSize * 4] = {
+		0x60,0x1E,0xC3,0x13,0x77,0x57,0x89,0xA5,0xB7,0xA7,0xF5,0x04,0xBB,0xF3,0xD2,0x28,
+		0xF4,0x43,0xE3,0xCA,0x4D,0x62,0xB5,0x9A,0xCA,0x84,0xE9,0x90,0xCA,0xCA,0xF5,0xC5,
+		0x2B,0x09,0x30,0xDA,0xA2,0x3D,0xE9,0x4C,0xE8,0x70,0x17,0xBA,0x2D,0x84,0x98,0x8D,
+		0xDF,0xC9,0xC5,0x8D,0xB6,0x7A,0xAD,0xA6,0x13,0xC2,0xDD,0x08,0x45,0x79,0x41,0xA6
+	};
+
+	bool bHw = AES::s_HwEnabled;
+
+	for (uint32_t iPath = 0; iPath < 2; iPath++)
+	{
+		AES::s_HwEnabled = !!iPath;
+
+		for (uint32_t nPortion = 1; nPortion <= sizeof(pPlaintextCtr); nPortion++)
+		{
+			AES::StreamCipher asc;
+			asc.Reset();
+			for (uint32_t i = 0; i < AES::s_BlockSize; i++)
+				asc.m_Counter.m_pData[i] = static_cast<uint8_t>(0xf0 + i);
+
+			uint8_t pBufCtr[sizeof(pPlaintextCtr)];
+			memcpy(pBufCtr, pPlaintextCtr, sizeof(pBufCtr));
+
+			for (uint32_t i = 0; i < sizeof(pBufCtr); i += nPortion)
+				asc.XCrypt(se.enc, pBufCtr + i, std::min<uint32_t>(nPortion, sizeof(pBufCtr) - i));
+
+			verify_test(!memcmp(pBufCtr, pCiphertextCtr, sizeof(pBufCtr)));
+		}
+	}
+
+	AES::s_HwEnabled = bHw;
 }
 
 void TestKdfPair(Key::IKdf& skdf, Key::IPKdf& pkdf)
@@ -2000,6 +2040,24 @@ void TestTreasury()
 	}
 }
 
+struct CmListPrepared
+	:public beam::Lelantus::CmListVec
+{
+	std::vector<PreparedBatch> m_vBatches;
+
+	void PrepareAll()
+	{
+		m_vBatches.resize(m_vec.size() / PreparedBatch::s_Size);
+		for (uint32_t i = 0; i < m_vBatches.size(); i++)
+			verify_test(Prepare(m_vBatches[i], i));
+	}
+
+	const PreparedBatch* get_Prepared(uint32_t iBatch) override
+	{
+		return (iBatch < m_vBatches.size()) ? &m_vBatches[iBatch] : nullptr;
+	}
+};
+
 void TestLelantus(bool bWithAsset, bool bMpc)
 {
 	beam::Lelantus::Cfg cfg; // default
@@ -2217,6 +2275,32 @@ void TestLelantus(bool bWithAsset, bool bMpc)
 	}
 
 	verify_test(bSuccess);
+
+	{
+		// list calculation with the prepared batches, unaligned range
+		CmListPrepared lst2;
+		lst2.m_vec = lst.m_vec;
+		lst2.PrepareAll();
+
+		for (uint32_t i = 0; i < N; i++)
+			SetRandom(vKs[i]);
+
+		uint32_t i0 = N / 3;
+		uint32_t nCount = N - i0 - 1;
+
+		Point::Native pt1(Zero), pt2(Zero);
+
+		uint32_t t = beam::GetTime_ms();
+		lst.Calculate(pt1, i0, nCount, &vKs.front());
+		uint32_t t1 = beam::GetTime_ms();
+		lst2.Calculate(pt2, i0, nCount, &vKs.front());
+		uint32_t t2 = beam::GetTime_ms();
+
+		verify_test(pt1 == pt2);
+
+		if (!bSpecial)
+			printf("\tList calculation = %u ms, prepared = %u ms\n", t1 - t, t2 - t1);
+	}
 }
 
 void TestLelantusKeys()
@@ -2876,6 +2960,40 @@ void RunBenchmark()
 		} while (bm.ShouldContinue());
 	}
 
+	{
+		CmListPrepared lst;
+		lst.m_vec.resize(1024);
+
+		std::vector<Scalar::Native> vKs;
+		vKs.resize(lst.m_vec.size());
+
+		Point::Native pt;
+		SetRandom(pt);
+		for (uint32_t i = 0; i < lst.m_vec.size(); i++, pt += pt)
+		{
+			pt.Export(lst.m_vec[i]);
+			SetRandom(vKs[i]);
+		}
+
+		for (uint32_t iPath = 0; iPath < 2; iPath++)
+		{
+			if (iPath)
+				lst.PrepareAll();
+
+			BenchmarkMeter bm(iPath ? "Sigma.List-1K.Prepared" : "Sigma.List-1K");
+			bm.N = 10;
+			do
+			{
+				for (uint32_t i = 0; i < bm.N; i++)
+				{
+					pt = Zero;
+					lst.Calculate(pt, 0, static_cast<uint32_t>(vKs.size()), &vKs.front());
+				}
+
+			} while (bm.ShouldContinue());
+		}
+	}
+
 	{
 		AES::Encoder enc;
 		enc.Init(hv.m_pData);
@@ -2884,17 +3002,25 @@ void RunBenchmark()
 
 		uint8_t pBuf[0x400];
 
-		BenchmarkMeter bm("AES.XCrypt-1MB");
-		bm.N = 10;
-		do
+		for (uint32_t iPath = 0; iPath < 2; iPath++)
 		{
-			for (uint32_t i = 0; i < bm.N; i++)
+			bool bHw = AES::s_HwEnabled;
+			AES::s_HwEnabled = !!iPath;
+
+			BenchmarkMeter bm(iPath ? "AES.XCrypt-1MB" : "AES.XCrypt-1MB-sw");
+			bm.N = 10;
+			do
 			{
-				for (size_t nSize = 0; nSize < 0x100000; nSize += sizeof(pBuf))
-					asc.XCrypt(enc, pBuf, sizeof(pBuf));
-			}
+				for (uint32_t i = 0; i < bm.N; i++)
+				{
+					for (size_t nSize = 0; nSize < 0x100000; nSize += sizeof(pBuf))
+						asc.XCrypt(enc, pBuf, sizeof(pBuf));
+				}
 
-		} while (bm.ShouldContinue());
+			} while (bm.ShouldContinue());
+
+			AES::s_HwEnabled = bHw;
+		}
 	}
 
 	{
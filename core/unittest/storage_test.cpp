@@ -412,6 +412,220 @@ namespace beam
 		verify_test(hv1 == hv2);
 	}
 
+	struct UtxoTreeCow
+		:public UtxoTree
+	{
+		// in-memory copy-on-write policy: everything allocated before the snapshot is shared, the released shared objects are deferred
+		bool m_bShared = false;
+		std::set<const void*> m_setPrivate;
+		std::vector<std::function<void()> > m_vRetired;
+		size_t m_nAllocated = 0;
+
+		bool IsShared(const void* p) const override
+		{
+			return m_bShared && !m_setPrivate.count(p);
+		}
+
+		template <typename T>
+		T* OnNew(T* p)
+		{
+			m_nAllocated++;
+			if (m_bShared)
+				m_setPrivate.insert(p);
+			return p;
+		}
+
+		template <typename T, typename TFunc>
+		void OnDelete(T* p, TFunc&& fn)
+		{
+			verify_test(m_nAllocated);
+			m_nAllocated--;
+
+			if (IsShared(p))
+				m_vRetired.push_back(std::move(fn));
+			else
+			{
+				m_setPrivate.erase(p);
+				fn();
+			}
+		}
+
+		Leaf* CreateLeaf() override { return OnNew(UtxoTree::CreateLeaf()); }
+		Joint* CreateJoint() override { return OnNew(UtxoTree::CreateJoint()); }
+		MyLeaf::IDQueue* CreateIDQueue() override { return OnNew(UtxoTree::CreateIDQueue()); }
+		MyLeaf::IDNode* CreateIDNode() override { return OnNew(UtxoTree::CreateIDNode()); }
+
+		void DeleteEmptyLeaf(Leaf* p) override { OnDelete(p, [this, p]() { UtxoTree::DeleteEmptyLeaf(p); }); }
+		void DeleteJoint(Joint* p) override { OnDelete(p, [this, p]() { UtxoTree::DeleteJoint(p); }); }
+		void DeleteIDQueue(MyLeaf::IDQueue* p) override { OnDelete(p, [this, p]() { UtxoTree::DeleteIDQueue(p); }); }
+		void DeleteIDNode(MyLeaf::IDNode* p) override { OnDelete(p, [this, p]() { UtxoTree::DeleteIDNode(p); }); }
+
+		int64_t TakeSnapshot()
+		{
+			m_setPrivate.clear();
+			m_bShared = true;
+			return m_RootOffset;
+		}
+
+		void ReleaseSnapshot()
+		{
+			for (auto& fn : m_vRetired)
+				fn();
+			m_vRetired.clear();
+			m_setPrivate.clear();
+			m_bShared = false;
+		}
+
+		~UtxoTreeCow()
+		{
+			Clear();
+		}
+	};
+
+	struct UtxoTreeView
+		:public UtxoTree
+	{
+		// read-only, doesn't own the nodes
+		UtxoTreeView(int64_t nRoot) { m_RootOffset = nRoot; }
+		~UtxoTreeView() { m_RootOffset = 0; }
+	};
+
+	void TestUtxoTreeCow()
+	{
+		std::vector<UtxoTree::Key> vKeys;
+		vKeys.resize(20000);
+
+		// the same operations are applied to the cow tree and to the reference tree
+		UtxoTreeCow t;
+		UtxoTree tRef;
+
+		for (uint32_t i = 0; i < vKeys.size(); i++)
+		{
+			UtxoTree::Key::Data d;
+			SetRandomUtxoKey(d);
+			vKeys[i] = d;
+
+			for (uint32_t iTree = 0; iTree < 2; iTree++)
+			{
+				UtxoTree& tt = iTree ? tRef : t;
+
+				UtxoTree::Cursor cu;
+				bool bCreate = true;
+				UtxoTree::MyLeaf* p = tt.Find(cu, vKeys[i], bCreate);
+				verify_test(p && bCreate);
+				SetLeafIDs(tt, *p, i, false);
+			}
+		}
+
+		Merkle::Hash hv0, hv1, hv2;
+		t.get_Hash(hv0); // all the nodes must be clean before the snapshot
+
+		Serializer ser0;
+		t.save(ser0);
+
+		std::unique_ptr<UtxoTreeView> pView = std::make_unique<UtxoTreeView>(t.TakeSnapshot());
+		UtxoTree& v = *pView;
+
+		for (uint32_t i = 0; i < vKeys.size(); i++)
+		{
+			for (uint32_t iTree = 0; iTree < 2; iTree++)
+			{
+				UtxoTree& tt = iTree ? tRef : t;
+
+				UtxoTree::Cursor cu;
+				bool bCreate = true;
+
+				switch (i % 4)
+				{
+				case 0:
+					// delete
+					bCreate = false;
+					verify_test(tt.Find(cu, vKeys[i], bCreate));
+					tt.Delete(cu);
+					break;
+
+				case 1:
+					{
+						// add/remove IDs
+						UtxoTree::MyLeaf* p = tt.Find(cu, vKeys[i], bCreate);
+						verify_test(p && !bCreate);
+
+						if (p->IsExt())
+							tt.PopID(*p);
+						else
+							tt.PushID(i + 1000000, *p);
+
+						cu.InvalidateElement();
+					}
+					break;
+
+				case 2:
+					{
+						// new element
+						UtxoTree::Key key = vKeys[i];
+						key.V.m_pData[3] ^= 0x5a;
+
+						UtxoTree::MyLeaf* p = tt.Find(cu, key, bCreate);
+						verify_test(p && bCreate);
+						p->m_ID = i;
+					}
+					break;
+
+				default:
+					break;
+				}
+			}
+
+			if (!(i % 19))
+				t.get_Hash(hv1); // make some private nodes clean
+		}
+
+		t.get_Hash(hv1);
+		tRef.get_Hash(hv2);
+		verify_test(hv1 == hv2);
+		verify_test(hv1 != hv0);
+
+		// the snapshot is intact
+		v.get_Hash(hv2);
+		verify_test(hv2 == hv0);
+
+		Serializer ser1;
+		v.save(ser1);
+		verify_test(ser0.buffer().second == ser1.buffer().second);
+		verify_test(!memcmp(ser0.buffer().first, ser1.buffer().first, ser1.buffer().second));
+
+		for (uint32_t i = 0; i < vKeys.size(); i += 97)
+		{
+			UtxoTree::Cursor cu;
+			bool bCreate = false;
+			UtxoTree::MyLeaf* p = v.Find(cu, vKeys[i], bCreate);
+			verify_test(p);
+
+			Merkle::Proof proof;
+			v.get_Proof(proof, cu);
+
+			Merkle::Hash hvElement;
+			p->get_Hash(hvElement);
+
+			Merkle::Interpret(hvElement, proof);
+			verify_test(hvElement == hv0);
+		}
+
+		verify_test(!t.m_vRetired.empty());
+		pView.reset();
+		t.ReleaseSnapshot();
+
+		// the tree is consistent after the release
+		Serializer ser2, ser3;
+		t.save(ser2);
+		tRef.save(ser3);
+		verify_test(ser2.buffer().second == ser3.buffer().second);
+		verify_test(!memcmp(ser2.buffer().first, ser3.buffer().first, ser3.buffer().second));
+
+		t.Clear();
+		verify_test(!t.m_nAllocated);
+	}
+
 	struct MyMmr
 		:public Merkle::Mmr
 	{
@@ -675,6 +889,7 @@ int main()
 {
 	beam::TestNavigator();
 	beam::TestUtxoTree();
+	beam::TestUtxoTreeCow();
 	beam::TestMmr();
 
 	return g_TestsFailed ? -1 : 0;
@@ -279,6 +279,12 @@ private:
             uint64_t m_Count;
             uint64_t m_Size;
 
+            void operator += (const CountAndSize& x)
+            {
+                m_Count += x.m_Count;
+                m_Size += x.m_Size;
+            }
+
             template <typename T>
             void OnObj(const T& obj)
             {
@@ -373,6 +379,20 @@ private:
                 m_MW.m_Outputs.OnObj(*pOutp);
         }
 
+        // all members are plain sums, partial totals of block ranges can be merged in any grouping
+        void operator += (const Totals& x)
+        {
+            m_Fee += x.m_Fee;
+            m_Kernels += x.m_Kernels;
+            m_MW.m_Inputs += x.m_MW.m_Inputs;
+            m_MW.m_Outputs += x.m_MW.m_Outputs;
+            m_Shielded.m_Inputs += x.m_Shielded.m_Inputs;
+            m_Shielded.m_Outputs += x.m_Shielded.m_Outputs;
+            m_Contract.m_Created += x.m_Contract.m_Created;
+            m_Contract.m_Destroyed += x.m_Contract.m_Destroyed;
+            m_Contract.m_Invoked += x.m_Contract.m_Invoked;
+        }
+
     };
 
     struct StateData
@@ -517,62 +537,118 @@ private:
             la.OnProgress(lst.size());
         }
 
+        // Blocks are processed in batches. The DB is accessed sequentially, while the block kernels (which dominate the cost)
+        // are decoded and counted in parallel into per-block deltas. The deltas are then accumulated in order.
+        // Intermediate batches are committed, an interrupted backfill resumes from the last block having totals.
+        struct Item
+        {
+            uint64_t m_Row;
+            NodeProcessor::StateExtra::Full m_Extra0;
+            ByteBuffer m_bbE;
+            Totals m_Delta;
+        };
+
+        struct MyTask
+            :public Executor::TaskSync
+        {
+            std::vector<Item> m_vItems;
+            std::mutex m_Mutex;
+            std::string m_sErr;
+
+            void Exec(Executor::Context& ctx) override
+            {
+                uint32_t i0, nCount;
+                ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_vItems.size()));
+
+                TxVectors::Eternal txe;
+
+                for (uint32_t i = 0; i < nCount; i++)
+                {
+                    auto& x = m_vItems[i0 + i];
+
+                    try {
+                        Deserializer der;
+                        der.reset(x.m_bbE);
+                        der & txe;
+                    }
+                    catch (const std::exception& exc) {
+                        std::unique_lock<std::mutex> scope(m_Mutex);
+                        m_sErr = exc.what();
+                        return;
+                    }
+
+                    x.m_Delta.OnHiLevelKrnls(txe.m_vKernels);
+                    x.m_bbE.clear();
+                }
+            }
+        } t;
+
+        const uint32_t nBatch = 0x400;
         std::vector<NodeDB::StateInput> vIns;
-        TxVectors::Eternal txe;
-        ByteBuffer bbE;
 
         la.SetTotal(lst.size());
 
-        for (; !lst.empty(); lst.pop_back())
+        while (!lst.empty())
         {
             la.OnProgress(la.m_Total - lst.size());
 
-            auto& x = lst.back();
-            db.GetStateBlock(x.first, nullptr, &bbE, nullptr);
+            t.m_vItems.resize(std::min(lst.size(), static_cast<size_t>(nBatch)));
 
-            try {
-		        Deserializer der;
-		        der.reset(bbE);
-		        der & txe;
-	        }
-	        catch (const std::exception& exc0) {
-                CorruptionException exc;
-                exc.m_sErr = exc0.what();
-                throw exc;
-	        }
+            for (auto& x : t.m_vItems)
+            {
+                const auto& src = lst.back();
+                x.m_Row = src.first;
+                x.m_Extra0 = src.second;
+                lst.pop_back();
 
-            // kernels
-            sd.m_Totals.OnHiLevelKrnls(txe.m_vKernels);
+                db.GetStateBlock(x.m_Row, nullptr, &x.m_bbE, nullptr);
+                ZeroObject(x.m_Delta);
 
-            // inputs
-            db.get_StateInputs(x.first, vIns);
-            for (const auto& inp : vIns)
-            {
+                // inputs
+                db.get_StateInputs(x.m_Row, vIns);
+                for (const auto& inp : vIns)
+                {
+                    NodeDB::WalkerTxo wlk;
+                    db.TxoGetValue(wlk, inp.get_ID());
+
+                    OnTotalsTxo(x.m_Delta.m_MW.m_Inputs, wlk);
+                }
+
+                // outputs
                 NodeDB::WalkerTxo wlk;
-                _node.get_Processor().get_DB().TxoGetValue(wlk, inp.get_ID());
+                db.EnumTxos(wlk, txos);
 
-                OnTotalsTxo(sd.m_Totals.m_MW.m_Inputs, wlk);
+                txos = db.get_StateTxos(x.m_Row);
+
+                while (wlk.MoveNext())
+                {
+                    if (wlk.m_ID >= txos)
+                        break;
+
+                    OnTotalsTxo(x.m_Delta.m_MW.m_Outputs, wlk);
+                }
             }
 
-            // outputs
-            NodeDB::WalkerTxo wlk;
-            db.EnumTxos(wlk, txos);
+            proc.get_Executor().ExecAll(t);
 
-            txos = db.get_StateTxos(x.first);
-            
-            while (wlk.MoveNext())
+            if (!t.m_sErr.empty())
             {
-                if (wlk.m_ID >= txos)
-                    break;
-
-                OnTotalsTxo(sd.m_Totals.m_MW.m_Outputs, wlk);
+                CorruptionException exc;
+                exc.m_sErr = std::move(t.m_sErr);
+                throw exc;
             }
 
+            for (const auto& x : t.m_vItems)
+            {
+                sd.m_Totals += x.m_Delta;
+                sd.m_Extra0 = x.m_Extra0;
 
-            sd.m_Extra0 = x.second;
-            Blob blobSd(&sd, sizeof(sd));
+                Blob blobSd(&sd, sizeof(sd));
+                db.set_StateExtra(x.m_Row, &blobSd);
+            }
 
-            db.set_StateExtra(x.first, &blobSd);
+            if (!lst.empty())
+                proc.CommitDB(); // checkpoint
         }
 
     }
@@ -2882,6 +2958,54 @@ private:
         return get_block_not_found(h);
     }
 
+    json get_txos_by_commitment(const Blob& x) override
+    {
+        auto& db = _nodeBackend.get_DB();
+
+        std::vector<TxoID> vIDs;
+        ECC::Point comm;
+        if (x.n == sizeof(comm))
+        {
+            memcpy(&comm, x.p, sizeof(comm));
+            db.TxoIdxFind(comm, vIDs); // empty unless rich info is on
+        }
+
+        json jRows = json::array();
+        jRows.push_back({ MakeTableHdr("Txo"), MakeTableHdr("Created"), MakeTableHdr("Spent") });
+
+        for (auto id : vIDs)
+        {
+            NodeDB::WalkerTxo wlk;
+            db.EnumTxos(wlk, id);
+            if (!wlk.MoveNext() || (wlk.m_ID != id))
+                continue; // pruned
+
+            Height hCreate = 0;
+            if (id >= _nodeBackend.m_Extra.m_TxosTreasury)
+            {
+                NodeDB::StateID sid;
+                db.FindStateByTxoID(sid, id);
+
+                Block::SystemState::Full s;
+                db.get_State(sid.m_Row, s);
+                hCreate = s.get_Height();
+            }
+
+            json jRow = json::array();
+            jRow.push_back(id);
+            jRow.push_back(MakeObjHeight(hCreate));
+
+            if (MaxHeight == wlk.m_SpendHeight)
+                jRow.push_back("");
+            else
+                jRow.push_back(MakeObjHeight(wlk.m_SpendHeight));
+
+            jRows.push_back(std::move(jRow));
+        }
+
+        return MakeTable(std::move(jRows));
+    }
+
     json get_blocks(Height startHeight, uint64_t n) override {
 
         json result = json::array();
@@ -71,6 +71,7 @@ struct IAdapter {
     virtual json get_status() = 0;
     virtual json get_block(Height height, int adj) = 0;
     virtual json get_block_by_kernel(const Blob& key) = 0;
+    virtual json get_txos_by_commitment(const Blob& x) = 0;
     virtual json get_blocks(Height startHeight, uint64_t n) = 0;
     virtual json get_hdrs(Height hMax, uint64_t nMax, uint64_t dn, const TotalsCol* pCols, uint32_t nCols) = 0;
     virtual json get_peers() = 0;
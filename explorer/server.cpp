@@ -715,6 +715,16 @@ OnRequest(blocks)
     return _backend.get_blocks(start, n);
 }
 
+OnRequest(txos)
+{
+    // as displayed: X followed by the Y parity byte
+    uintBig_t<ECC::nBytes + 1> x;
+    if (!get_UrlHexArg(_currentUrl, "commitment", x))
+        Exc::Fail("commitment missing");
+
+    return _backend.get_txos_by_commitment(x);
+}
+
 OnRequest(hdrs)
 {
     Height hTop = _currentUrl.get_int_arg("hMax", std::numeric_limits<int64_t>::max());
@@ -25,6 +25,7 @@
     macro(status) \
     macro(block) \
     macro(blocks) \
+    macro(txos) \
     macro(hdrs) \
     macro(peers) \
     macro(swap_offers) \
@@ -94,6 +94,16 @@ namespace beam {
 #define TblTxo_Value			"Value"
 #define TblTxo_SpendHeight		"SpendHeight"
 
+#define TblTxoIdx				"TxoIdx"
+#define TblTxoIdx_ID			"ID"
+#define TblTxoIdx_Key			"Key"
+
+#define TblArchive				"Archive"
+#define TblArchive_Row			"Row"
+#define TblArchive_Segment		"Segment"
+#define TblArchive_Offset		"Offset"
+#define TblArchive_Size			"Size"
+
 #define TblStreams				"Streams"
 #define TblStream_ID			"ID"
 #define TblStream_Value			"Value"
@@ -135,6 +145,12 @@ namespace beam {
 #define TblContractLogs_Key		"Key"
 #define TblContractLogs_Data	"Data"
 
+#define TblContractHist			"ContractHist"
+#define TblContractHist_Pos		"Pos"
+#define TblContractHist_Key		"Key"
+#define TblContractHist_Old		"Old"
+#define TblContractHist_New		"New"
+
 #define TblCache				"Cache"
 #define TblCache_Key			"Key"
 #define TblCache_Data			"Data"
@@ -399,7 +415,7 @@ void NodeDB::Open(const char* szPath)
 		bCreate = !rs.Step();
 	}
 
-	const uint64_t nVersionTop = 38;
+	const uint64_t nVersionTop = 41;
 
 
 	Transaction t(*this);
@@ -499,6 +515,25 @@ void NodeDB::Open(const char* szPath)
 			CreateTables37();
 			// no break;
 
+		case 38: // contract vars history
+			CreateTables38();
+
+			// populate it if rich info is on
+			if (ParamIntGetDef(ParamID::RichContractInfo))
+				ParamIntSet(ParamID::Flags1, ParamIntGetDef(ParamID::Flags1) | Flags1::PendingRebuildNonStd);
+			// no break;
+
+		case 39: // txo commitment index
+			CreateTables39();
+
+			if (ParamIntGetDef(ParamID::RichContractInfo))
+				ParamIntSet(ParamID::Flags1, ParamIntGetDef(ParamID::Flags1) | Flags1::PendingRebuildNonStd);
+			// no break;
+
+		case 40: // block body archive
+			CreateTables40();
+			// no break;
+
 			ParamIntSet(ParamID::DbVer, nVersionTop);
 			// no break;
 
@@ -620,6 +655,9 @@ void NodeDB::Create()
 	CreateTables31();
 	CreateTables36();
 	CreateTables37();
+	CreateTables38();
+	CreateTables39();
+	CreateTables40();
 }
 
 void NodeDB::CreateTables20()
@@ -734,6 +772,38 @@ void NodeDB::CreateTables37()
 	ExecQuick("CREATE INDEX [Idx" TblBridge "] ON [" TblBridge "] ([" TblBridge_Key "],[" TblBridge_Pos "]);");
 }
 
+void NodeDB::CreateTables38()
+{
+	ExecQuick("CREATE TABLE [" TblContractHist "] ("
+		"[" TblContractHist_Pos		"] BLOB NOT NULL PRIMARY KEY,"
+		"[" TblContractHist_Key		"] BLOB NOT NULL,"
+		"[" TblContractHist_Old		"] BLOB NOT NULL,"
+		"[" TblContractHist_New		"] BLOB NOT NULL"
+		") WITHOUT ROWID");
+
+	ExecQuick("CREATE INDEX [Idx" TblContractHist "_Key" "] ON [" TblContractHist "] ([" TblContractHist_Key "],[" TblContractHist_Pos "]);");
+}
+
+void NodeDB::CreateTables39()
+{
+	ExecQuick("CREATE TABLE [" TblTxoIdx "] ("
+		"[" TblTxoIdx_ID	"] INTEGER NOT NULL PRIMARY KEY,"
+		"[" TblTxoIdx_Key	"] BLOB NOT NULL)");
+
+	ExecQuick("CREATE INDEX [Idx" TblTxoIdx "_Key" "] ON [" TblTxoIdx "] ([" TblTxoIdx_Key "]);");
+}
+
+void NodeDB::CreateTables40()
+{
+	ExecQuick("CREATE TABLE [" TblArchive "] ("
+		"[" TblArchive_Row		"] INTEGER NOT NULL PRIMARY KEY,"
+		"[" TblArchive_Segment	"] INTEGER NOT NULL,"
+		"[" TblArchive_Offset	"] INTEGER NOT NULL,"
+		"[" TblArchive_Size		"] INTEGER NOT NULL)");
+
+	ExecQuick("CREATE INDEX [Idx" TblArchive "_Seg" "] ON [" TblArchive "] ([" TblArchive_Segment "],[" TblArchive_Offset "]);");
+}
+
 void NodeDB::Vacuum()
 {
 	ExecQuick("VACUUM");
@@ -1661,10 +1731,20 @@ void NodeDB::GetStateBlock(uint64_t rowid, ByteBuffer* pP, ByteBuffer* pE, ByteB
 
 	if (pP && !rs.IsNull(0))
 		rs.get(0, *pP);
-	if (pE && !rs.IsNull(1))
-		rs.get(1, *pE);
 	if (pRB && !rs.IsNull(2))
 		rs.get(2, *pRB);
+
+	if (pE)
+	{
+		if (!rs.IsNull(1))
+			rs.get(1, *pE);
+		else
+		{
+			ArchiveEntry ae;
+			if (m_pArchive && ArchiveGet(rowid, ae))
+				m_pArchive->Read(ae, *pE);
+		}
+	}
 }
 
 void NodeDB::DelStateBlockPP(uint64_t rowid)
@@ -1690,6 +1770,82 @@ void NodeDB::DelStateBlockAll(uint64_t rowid)
 	rs.put(0, rowid);
 	rs.Step();
 	TestChanged1Row();
+
+	// archived body (if any) becomes dead
+	rs.Reset(*this, Query::ArchiveDel, "DELETE FROM " TblArchive " WHERE " TblArchive_Row "=?");
+	rs.put(0, rowid);
+	rs.Step();
+}
+
+void NodeDB::ArchiveMove(uint64_t rowid, const ArchiveEntry& ae)
+{
+	ArchiveSet(rowid, ae);
+
+	Recordset rs(*this, Query::StateDelBodyE, "UPDATE " TblStates " SET " TblStates_BodyE "=NULL WHERE rowid=?");
+	rs.put(0, rowid);
+	rs.Step();
+	TestChanged1Row();
+}
+
+void NodeDB::ArchiveSet(uint64_t rowid, const ArchiveEntry& ae)
+{
+	Recordset rs(*this, Query::ArchiveIns, "INSERT OR REPLACE INTO " TblArchive "(" TblArchive_Row "," TblArchive_Segment "," TblArchive_Offset "," TblArchive_Size ") VALUES(?,?,?,?)");
+	rs.put(0, rowid);
+	rs.put(1, ae.m_iSegment);
+	rs.put(2, ae.m_Offset);
+	rs.put(3, ae.m_Size);
+	rs.Step();
+	TestChanged1Row();
+}
+
+bool NodeDB::ArchiveGet(uint64_t rowid, ArchiveEntry& ae)
+{
+	Recordset rs(*this, Query::ArchiveGet, "SELECT " TblArchive_Segment "," TblArchive_Offset "," TblArchive_Size " FROM " TblArchive " WHERE " TblArchive_Row "=?");
+	rs.put(0, rowid);
+	if (!rs.Step())
+		return false;
+
+	rs.get(0, ae.m_iSegment);
+	rs.get(1, ae.m_Offset);
+	rs.get(2, ae.m_Size);
+	return true;
+}
+
+uint64_t NodeDB::ArchiveGetLive(uint32_t iSegment)
+{
+	Recordset rs(*this, Query::ArchiveLive, "SELECT SUM(" TblArchive_Size ") FROM " TblArchive " WHERE " TblArchive_Segment "=?");
+	rs.put(0, iSegment);
+	rs.StepStrict();
+
+	uint64_t n = 0;
+	if (!rs.IsNull(0))
+		rs.get(0, n);
+	return n;
+}
+
+void NodeDB::ArchiveEnumSegments(std::vector<uint32_t>& v)
+{
+	Recordset rs(*this, Query::ArchiveSegments, "SELECT DISTINCT " TblArchive_Segment " FROM " TblArchive " ORDER BY " TblArchive_Segment);
+	while (rs.Step())
+		rs.get(0, v.emplace_back());
+}
+
+void NodeDB::ArchiveEnum(WalkerArchive& wlk, uint32_t iSegment)
+{
+	wlk.m_Rs.Reset(*this, Query::ArchiveEnum, "SELECT " TblArchive_Row "," TblArchive_Offset "," TblArchive_Size " FROM " TblArchive " WHERE " TblArchive_Segment "=? ORDER BY " TblArchive_Offset);
+	wlk.m_Rs.put(0, iSegment);
+	wlk.m_Entry.m_iSegment = iSegment;
+}
+
+bool NodeDB::WalkerArchive::MoveNext()
+{
+	if (!m_Rs.Step())
+		return false;
+
+	m_Rs.get(0, m_Row);
+	m_Rs.get(1, m_Entry.m_Offset);
+	m_Rs.get(2, m_Entry.m_Size);
+	return true;
 }
 
 void NodeDB::SetFlags(uint64_t rowid, uint32_t n)
@@ -2455,6 +2611,30 @@ void NodeDB::TxoGetValue(WalkerTxo& wlk, TxoID id0)
 	wlk.m_Rs.get(0, wlk.m_Value);
 }
 
+void NodeDB::TxoIdxAdd(TxoID id, const ECC::Point& pt)
+{
+	Recordset rs(*this, Query::TxoIdxAdd, "INSERT INTO " TblTxoIdx "(" TblTxoIdx_ID "," TblTxoIdx_Key ") VALUES(?,?)");
+	rs.put(0, id);
+	rs.put_As(1, pt);
+	rs.Step();
+}
+
+void NodeDB::TxoIdxDelFrom(TxoID id)
+{
+	Recordset rs(*this, Query::TxoIdxDelFrom, "DELETE FROM " TblTxoIdx " WHERE " TblTxoIdx_ID ">=?");
+	rs.put(0, id);
+	rs.Step();
+}
+
+void NodeDB::TxoIdxFind(const ECC::Point& pt, std::vector<TxoID>& v)
+{
+	Recordset rs(*this, Query::TxoIdxFind, "SELECT " TblTxoIdx_ID " FROM " TblTxoIdx " WHERE " TblTxoIdx_Key "=? ORDER BY " TblTxoIdx_ID);
+	rs.put_As(0, pt);
+
+	while (rs.Step())
+		rs.get(0, v.emplace_back());
+}
+
 NodeDB::StreamMmr::StreamMmr(NodeDB& db, StreamType::Enum eType, bool bStoreH0)
 	:m_hStoreFrom(!bStoreH0)
 	,m_eType(eType)
@@ -3301,6 +3481,73 @@ bool NodeDB::ContractLog::Walker::MoveNext()
 	return true;
 }
 
+void NodeDB::ContractHistInsert(const ContractHist::Entry& x)
+{
+	Recordset rs(*this, Query::ContractHistInsert, "INSERT INTO " TblContractHist " (" TblContractHist_Pos "," TblContractHist_Key "," TblContractHist_Old "," TblContractHist_New ") VALUES(?,?,?,?)");
+
+	HeightPosPacked buf;
+	buf.put(rs, 0, x.m_Pos);
+
+	rs.put(1, x.m_Key);
+	rs.put(2, x.m_ValOld);
+	rs.put(3, x.m_ValNew);
+
+	rs.Step();
+	TestChanged1Row();
+}
+
+void NodeDB::ContractHistDelFrom(const HeightPos& posMin)
+{
+	Recordset rs(*this, Query::ContractHistDel, "DELETE FROM " TblContractHist " WHERE " TblContractHist_Pos ">=?");
+
+	HeightPosPacked bufMin;
+	bufMin.put(rs, 0, posMin);
+
+	rs.Step();
+}
+
+void NodeDB::ContractHistEnum(ContractHist::Walker& wlk, const HeightPos& posMin, const HeightPos& posMax)
+{
+	wlk.m_Rs.Reset(*this, Query::ContractHistEnum, "SELECT * FROM " TblContractHist " WHERE " TblContractHist_Pos " BETWEEN ? AND ? ORDER BY " TblContractHist_Pos);
+
+	wlk.m_bufMin.put(wlk.m_Rs, 0, posMin);
+	wlk.m_bufMax.put(wlk.m_Rs, 1, posMax);
+}
+
+void NodeDB::ContractHistEnum(ContractHist::Walker& wlk, const Blob& keyMin, const Blob& keyMax, Height hAfter)
+{
+	// sqlite-specific: in presence of a single MIN() aggregate the bare columns are taken from the row with the minimum value
+	wlk.m_Rs.Reset(*this, Query::ContractHistEnumKey, "SELECT MIN(" TblContractHist_Pos ")," TblContractHist_Key "," TblContractHist_Old "," TblContractHist_New " FROM " TblContractHist
+		" WHERE (" TblContractHist_Key " BETWEEN ? AND ?) AND (" TblContractHist_Pos ">?) GROUP BY " TblContractHist_Key " ORDER BY " TblContractHist_Key);
+	wlk.m_Rs.put(0, keyMin);
+	wlk.m_Rs.put(1, keyMax);
+
+	wlk.m_bufMin.put(wlk.m_Rs, 2, HeightPos(hAfter, static_cast<uint32_t>(-1)));
+}
+
+bool NodeDB::ContractHistFind(ContractHist::Walker& wlk, const Blob& key, Height hAfter)
+{
+	wlk.m_Rs.Reset(*this, Query::ContractHistFind, "SELECT * FROM " TblContractHist
+		" WHERE (" TblContractHist_Key "=?) AND (" TblContractHist_Pos ">?) ORDER BY " TblContractHist_Pos " LIMIT 1");
+	wlk.m_Rs.put(0, key);
+
+	wlk.m_bufMin.put(wlk.m_Rs, 1, HeightPos(hAfter, static_cast<uint32_t>(-1)));
+
+	return wlk.MoveNext();
+}
+
+bool NodeDB::ContractHist::Walker::MoveNext()
+{
+	if (!m_Rs.Step())
+		return false;
+
+	HeightPosPacked::get(m_Rs, 0, m_Entry.m_Pos);
+	m_Rs.get(1, m_Entry.m_Key);
+	m_Rs.get(2, m_Entry.m_ValOld);
+	m_Rs.get(3, m_Entry.m_ValNew);
+	return true;
+}
+
 void NodeDB::KrnInfoInsert(const KrnInfo::Entry& x)
 {
 	Recordset rs(*this, Query::KrnInfoInsert, "INSERT INTO " TblKrnInfo " (" TblKrnInfo_Pos "," TblKrnInfo_Key "," TblKrnInfo_Data ") VALUES(?,?,?)");
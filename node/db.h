@@ -66,6 +66,10 @@ public:
 			TreasuryTotals, // for use in explorer node
 			PbftCid,
 			PbftStamp,
+			RecoveryChain, // num of files in the recovery chain (full + deltas), 0 if there's no valid chain to append a delta to
+			NumberArchive, // Block Number below which the eternal bodies of the active blocks are moved to the archive
+			ArchiveTail, // index of the archive segment the new bodies are appended to
+			HeightContractHist, // Height starting from which the contract vars history is complete
 		};
 	};
 
@@ -130,6 +134,13 @@ public:
 			StateDelBlockPP,
 			StateDelBlockPPR,
 			StateDelBlockAll,
+			StateDelBodyE,
+			ArchiveIns,
+			ArchiveGet,
+			ArchiveDel,
+			ArchiveEnum,
+			ArchiveLive,
+			ArchiveSegments,
 			EventIns,
 			EventDelByHeight,
 			EventDelByAccount,
@@ -168,6 +179,9 @@ public:
 			TxoEnum,
 			TxoSetValue,
 			TxoGetValue,
+			TxoIdxAdd,
+			TxoIdxDelFrom,
+			TxoIdxFind,
 			StreamIns,
 			StreamDel,
 			EnumSystemStatesBkwd,
@@ -210,6 +224,12 @@ public:
 			ContractLogEnum,
 			ContractLogEnumCid,
 
+			ContractHistInsert,
+			ContractHistDel,
+			ContractHistEnum,
+			ContractHistEnumKey,
+			ContractHistFind,
+
 			ShieldedStatisticSel,
 			ShieldedStatisticIns,
 			ShieldedStatisticDel,
@@ -381,6 +401,39 @@ public:
 	void DelStateBlockPPR(uint64_t rowid); // delete perishable, rollback, peer. Keep eternal, extra, txos
 	void DelStateBlockAll(uint64_t rowid); // delete perishable, peer, eternal, extra, txos, rollback
 
+	// Eternal bodies of the fossil blocks may be moved out of the DB into the append-only archive segments (files).
+	// The Archive table is the index, the segment data is immutable. Deleted entries are just removed from the index, their space is reclaimed by the compaction.
+	struct ArchiveEntry
+	{
+		uint32_t m_iSegment;
+		uint64_t m_Offset;
+		uint32_t m_Size;
+	};
+
+	struct IArchive
+	{
+		virtual void Read(const ArchiveEntry&, ByteBuffer&) = 0;
+	};
+
+	IArchive* m_pArchive = nullptr; // if set - GetStateBlock reads the archived eternal bodies transparently
+
+	void ArchiveMove(uint64_t rowid, const ArchiveEntry&); // removes the eternal body from the states table
+	void ArchiveSet(uint64_t rowid, const ArchiveEntry&); // relocated by the compaction
+	bool ArchiveGet(uint64_t rowid, ArchiveEntry&);
+	uint64_t ArchiveGetLive(uint32_t iSegment); // total size of the live entries
+	void ArchiveEnumSegments(std::vector<uint32_t>&);
+
+	struct WalkerArchive
+	{
+		Recordset m_Rs;
+		uint64_t m_Row;
+		ArchiveEntry m_Entry;
+
+		bool MoveNext();
+	};
+
+	void ArchiveEnum(WalkerArchive&, uint32_t iSegment);
+
 	TxoID FindStateByTxoID(StateID&, TxoID); // returns the Txos at state end
 
 	struct WalkerState {
@@ -599,6 +652,11 @@ public:
 	void TxoSetValue(TxoID, const Blob&);
 	void TxoGetValue(WalkerTxo&, TxoID);
 
+	// optional commitment -> Txo index, maintained only with rich info. Keyed by the whole commitment (X and Y), C and -C are distinct
+	void TxoIdxAdd(TxoID, const ECC::Point&);
+	void TxoIdxDelFrom(TxoID);
+	void TxoIdxFind(const ECC::Point&, std::vector<TxoID>&);
+
 	void ShieldedResize(uint64_t n, uint64_t n0) {
 		StreamResize_T<ECC::Point::Storage>(StreamType::Shielded, n, n0);
 	}
@@ -796,6 +854,33 @@ public:
 	void ContractLogEnum(ContractLog::Walker&, const HeightPos& posMin, const HeightPos& posMax);
 	void ContractLogEnum(ContractLog::Walker&, const Blob& keyMin, const Blob& keyMax, const HeightPos& posMin, const HeightPos& posMax);
 
+	// Per-block contract vars delta log. Each var modification is recorded with its previous and new values,
+	// so that the state can be rolled back or reconstructed at any height by visiting only the modified keys.
+	struct ContractHist
+	{
+		struct Entry
+		{
+			HeightPos m_Pos; // block height, index of the modification within the block
+			Blob m_Key;
+			Blob m_ValOld; // empty if the var didn't exist
+			Blob m_ValNew; // empty if the var is deleted
+		};
+
+		struct Walker
+		{
+			HeightPosPacked m_bufMin, m_bufMax;
+			Recordset m_Rs;
+			Entry m_Entry;
+			bool MoveNext();
+		};
+	};
+
+	void ContractHistInsert(const ContractHist::Entry&);
+	void ContractHistDelFrom(const HeightPos&);
+	void ContractHistEnum(ContractHist::Walker&, const HeightPos& posMin, const HeightPos& posMax); // ordered by pos
+	void ContractHistEnum(ContractHist::Walker&, const Blob& keyMin, const Blob& keyMax, Height hAfter); // the earliest modification of each key above the height, ordered by key
+	bool ContractHistFind(ContractHist::Walker&, const Blob& key, Height hAfter); // the earliest modification above the height
+
 	struct KrnInfo
 	{
 		typedef ECC::Hash::Value Cid;
@@ -858,6 +943,9 @@ private:
 	void CreateTables31();
 	void CreateTables36();
 	void CreateTables37();
+	void CreateTables38();
+	void CreateTables39();
+	void CreateTables40();
 	void ExecQuick(const char*);
 	std::string ExecTextOut(const char*);
 	bool ExecStep(sqlite3_stmt*);
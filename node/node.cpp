@@ -45,7 +45,10 @@ bool Node::SyncStatus::operator == (const SyncStatus& x) const
 {
 	return
 		(m_Done == x.m_Done) &&
-		(m_Total == x.m_Total);
+		(m_Total == x.m_Total) &&
+		(m_HdrsPerSec == x.m_HdrsPerSec) &&
+		(m_BlocksPerSec == x.m_BlocksPerSec) &&
+		(m_BytesPerSec == x.m_BytesPerSec);
 }
 
 void Node::SyncStatus::ToRelative(Height hDone0)
@@ -72,6 +75,8 @@ void Node::RefreshCongestions()
 		if (!t.m_bNeeded)
 			DeleteUnassignedTask(t);
 	}
+
+	PlanBodyPacks();
 }
 
 void Node::UpdateSyncStatus()
@@ -79,7 +84,6 @@ void Node::UpdateSyncStatus()
 	if (!m_UpdatedFromPeers)
 		return;
 
-	SyncStatus stat = m_SyncStatus;
 	UpdateSyncStatusRaw();
 
 	if (!m_PostStartSynced && (m_SyncStatus.m_Done == m_SyncStatus.m_Total) && !m_Processor.IsFastSync())
@@ -98,8 +102,12 @@ void Node::UpdateSyncStatus()
 		m_Validator.OnNewState();
 	}
 
-	if (m_Cfg.m_Observer && !(m_SyncStatus == stat))
+	// compare with the last reported, the rates are updated before this call
+	if (m_Cfg.m_Observer && !(m_SyncStatus == m_SyncStatusReported))
+	{
+		m_SyncStatusReported = m_SyncStatus;
 		m_Cfg.m_Observer->OnSyncProgress();
+	}
 }
 
 void Node::UpdateSyncStatusRaw()
@@ -111,6 +119,9 @@ void Node::UpdateSyncStatusRaw()
 	if (m_Processor.IsFastSync())
 		hTotal = m_Processor.m_SyncData.m_Target.m_Number.v;
 
+	bool bHdrs = false;
+	bool bBlocks = false;
+
 	for (TaskSet::iterator it = m_setTasks.begin(); m_setTasks.end() != it; ++it)
 	{
 		const Task& t = *it;
@@ -123,6 +134,7 @@ void Node::UpdateSyncStatusRaw()
 		if (bBlock)
 		{
 			assert(t.m_Key.first.m_Number.v);
+			bBlocks = true;
 			// all the blocks up to this had been dloaded
 			std::setmax(hTotal, t.m_sidTrg.m_Number.v);
 			std::setmax(hDoneHdrs, t.m_sidTrg.m_Number.v);
@@ -133,6 +145,7 @@ void Node::UpdateSyncStatusRaw()
 			if (!t.m_pOwner)
 				continue; // don't account for unowned
 
+			bHdrs = true;
 			std::setmax(hTotal, t.m_sidTrg.m_Number.v);
 			if (t.m_sidTrg.m_Number.v > t.m_Key.first.m_Number.v)
 				std::setmax(hDoneHdrs, m_Processor.m_Cursor.m_Full.m_Number.v + t.m_sidTrg.m_Number.v - t.m_Key.first.m_Number.v);
@@ -178,6 +191,11 @@ void Node::UpdateSyncStatusRaw()
 
 	}
 
+	if (!bHdrs)
+		m_HdrRate.Reset(m_SyncStatus);
+	if (!bBlocks)
+		m_BodyRate.Reset(m_SyncStatus);
+
 	m_SyncStatus.m_Total = hTotal * (SyncStatus::s_WeightHdr + SyncStatus::s_WeightBlock);
 	m_SyncStatus.m_Done = hDoneHdrs * SyncStatus::s_WeightHdr + hDoneBlocks * SyncStatus::s_WeightBlock;
 }
@@ -334,6 +352,22 @@ void Node::Wanted::OnTimer()
 
 void Node::TryAssignTask(Task& t)
 {
+	if (t.m_Key.second)
+	{
+		// blocks: prioritize w.r.t. throughput
+		std::vector<std::pair<uint32_t, Peer*> > vPeers;
+		for (PeerMan::LiveSet::iterator it = m_PeerMan.m_LiveSet.begin(); m_PeerMan.m_LiveSet.end() != it; ++it)
+			vPeers.emplace_back(it->m_p->get_BodyBps(), it->m_p);
+
+		std::stable_sort(vPeers.begin(), vPeers.end(), [](const std::pair<uint32_t, Peer*>& a, const std::pair<uint32_t, Peer*>& b) { return a.first > b.first; });
+
+		for (size_t i = 0; i < vPeers.size(); i++)
+			if (TryAssignTask(t, *vPeers[i].second))
+				return;
+
+		return;
+	}
+
 	// Prioritize w.r.t. rating!
 	for (PeerMan::LiveSet::iterator it = m_PeerMan.m_LiveSet.begin(); m_PeerMan.m_LiveSet.end() != it; ++it)
 	{
@@ -401,15 +435,22 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 	// assign
 	if (t.m_Key.second)
 	{
-		if (m_nTasksPackBody >= m_Cfg.m_MaxConcurrentBlocksRequest)
+		if (!t.m_bNeeded && (m_nTasksBody >= std::max(m_Cfg.m_MaxConcurrentBodyPacks, 1U)))
 		{
 			BEAM_LOG_VERBOSE() << "too many blocks requested";
 			return false; // too many blocks requested
 		}
 
+		if (nBlocks)
+		{
+			BEAM_LOG_VERBOSE() << "peer busy";
+			return false; // a single body pack per peer
+		}
+
 		uint64_t hCountExtra = t.m_sidTrg.m_Number.v - t.m_Key.first.m_Number.v;
 
 		proto::GetBodyPack msg;
+		t.m_bCompact = false;
 
 		if (t.m_Key.first.m_Number.v <= m_Processor.m_SyncData.m_Target.m_Number.v)
 		{
@@ -431,19 +472,30 @@ bool Node::TryAssignTask(Task& t, Peer& p)
 			msg.m_Top.m_Number = t.m_sidTrg.m_Number;
 			m_Processor.get_DB().get_StateHash(t.m_sidTrg.m_Row, msg.m_Top.m_Hash);
 			msg.m_CountExtra.v = hCountExtra;
+
+			// a single new block, most of its txs are expected to be in our pool
+			if (!hCountExtra && m_Cfg.m_CompactBlocks && !t.m_bNoCompact && !m_TxPool.m_setTxs.empty() && (p.get_Ext() >= 14))
+			{
+				msg.m_FlagP = proto::BodyBuffers::Compact;
+				t.m_bCompact = true;
+			}
 		}
 
+		if (t.m_Key.first.m_Number.v && msg.m_CountExtra.v)
+			TrimBodyPack(msg, t, get_BodyPackCount(p));
+
 		p.Send(msg);
 
 		t.m_nCount = std::min(static_cast<uint32_t>(msg.m_CountExtra.v), m_Cfg.m_BandwidthCtl.m_MaxBodyPackCount) + 1; // just an estimate, the actual num of blocks can be smaller
 		m_nTasksPackBody += t.m_nCount;
+		m_nTasksBody++;
 
 		t.m_n0 = m_Processor.m_SyncData.m_n0;
 		t.m_nTxoLo = m_Processor.m_SyncData.m_TxoLo;
 	}
 	else
 	{
-		const uint32_t nMaxHdrRequests = proto::g_HdrPackMaxSize * 2;
+		const uint32_t nMaxHdrRequests = proto::g_HdrPackMaxSize * std::max(m_Cfg.m_MaxConcurrentHdrPacks, 1U);
 		if (m_nTasksPackHdr >= nMaxHdrRequests)
 		{
 			BEAM_LOG_VERBOSE() << "too many hdrs requested";
@@ -522,6 +574,248 @@ void Node::Peer::SetTimerWrtFirstTask()
 	}
 }
 
+uint32_t Node::Peer::get_BodyBps() const
+{
+	if (m_DataRate.m_Bps)
+		return m_DataRate.m_Bps;
+
+	return m_pInfo ? PeerManager::Rating::ToBps(m_pInfo->m_RawRating.m_Value) : 0;
+}
+
+void Node::Peer::DataRate::OnResponse(uint32_t dt_ms, size_t nSize, bool bBulk)
+{
+	// moving averages, the new sample has 1/4 weight
+	if (bBulk)
+	{
+		uint32_t dtTransfer_ms = dt_ms - std::min(m_Rtt_ms, dt_ms / 2);
+		uint32_t nBps = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(nSize) * 1000 / std::max(dtTransfer_ms, 1U), static_cast<uint32_t>(-1)));
+
+		m_Bps = m_Bps ? (m_Bps - m_Bps / 4 + nBps / 4) : nBps;
+	}
+	else
+	{
+		uint32_t dtTransfer_ms = m_Bps ? static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(nSize) * 1000 / m_Bps, dt_ms)) : 0;
+		uint32_t nRtt_ms = dt_ms - dtTransfer_ms;
+
+		m_Rtt_ms = m_Rtt_ms ? (m_Rtt_ms - m_Rtt_ms / 4 + nRtt_ms / 4) : nRtt_ms;
+	}
+}
+
+uint32_t Node::Peer::DataRate::get_Expected_ms(uint64_t nSize, uint32_t nBps) const
+{
+	uint64_t dt_ms = nSize * 1000 / std::max(nBps, 1U);
+	return m_Rtt_ms + static_cast<uint32_t>(std::min<uint64_t>(dt_ms, static_cast<uint32_t>(-1) / 2));
+}
+
+uint32_t Node::get_BodyPackCount(const Peer& p) const
+{
+	const Config::BandwidthCtl& bw = m_Cfg.m_BandwidthCtl; // alias
+	if (!m_BodyRate.m_SizePerBlock)
+		return bw.m_MaxBodyPackCount; // nothing is known yet
+
+	uint64_t nSize = static_cast<uint64_t>(p.get_BodyBps()) * bw.m_BodyPackTime_ms / 1000;
+	std::setmin(nSize, bw.m_MaxBodyPackSize);
+
+	uint64_t nCount = nSize / m_BodyRate.m_SizePerBlock;
+	std::setmax(nCount, 1U);
+	std::setmin(nCount, bw.m_MaxBodyPackCount);
+
+	return static_cast<uint32_t>(nCount);
+}
+
+void Node::TrimBodyPack(proto::GetBodyPack& msg, const Task& t, uint32_t nMax)
+{
+	// limit the range, and stop before the blocks that are already received (by other packs)
+	const Block::Number& num = t.m_Key.first.m_Number; // alias
+	if (t.m_sidTrg.m_Number.v < num.v)
+		return;
+
+	uint64_t hCountExtra = t.m_sidTrg.m_Number.v - num.v;
+	if (msg.m_CountExtra.v > hCountExtra)
+		return;
+
+	const uint64_t* pRows = m_Processor.get_CachedRows(t.m_sidTrg, hCountExtra);
+	if (!pRows)
+		return;
+
+	uint64_t n = std::min<uint64_t>(msg.m_CountExtra.v, nMax ? (nMax - 1) : 0);
+	for (uint64_t i = 1; i <= n; i++)
+	{
+		if (NodeDB::StateFlags::Functional & m_Processor.get_DB().GetStateFlags(pRows[hCountExtra - i]))
+		{
+			n = i - 1;
+			break;
+		}
+	}
+
+	if (msg.m_CountExtra.v == n)
+		return;
+
+	msg.m_CountExtra.v = n;
+	msg.m_Top.m_Number.v = num.v + n;
+	m_Processor.get_DB().get_StateHash(pRows[hCountExtra - n], msg.m_Top.m_Hash);
+}
+
+Node::Task* Node::CreateBodyTask(const Block::SystemState::ID& id, const NodeDB::StateID& sidTrg)
+{
+	Task* pTask = new Task;
+	pTask->m_Key.first = id;
+	pTask->m_Key.second = true;
+	pTask->m_sidTrg = sidTrg;
+	pTask->m_bNeeded = false; // not requested by the processor (yet)
+	pTask->m_nCount = 0;
+	pTask->m_pOwner = NULL;
+	pTask->m_bCompact = false;
+	pTask->m_bNoCompact = false;
+
+	m_setTasks.insert(*pTask);
+	m_lstTasksUnassigned.push_back(*pTask);
+
+	return pTask;
+}
+
+void Node::PlanBodyPacks()
+{
+	const uint32_t nMaxPacks = std::max(m_Cfg.m_MaxConcurrentBodyPacks, 1U);
+
+	if (m_Processor.IsTreasuryHandled() && (m_nTasksBody < nMaxPacks))
+	{
+		// request the subsequent ranges ahead of the first missing blocks, from other peers
+		std::vector<Task*> vHeads;
+		for (TaskSet::iterator it = m_setTasks.begin(); m_setTasks.end() != it; ++it)
+		{
+			Task& t = *it;
+			if (t.m_Key.second && t.m_bNeeded && t.m_pOwner && t.m_Key.first.m_Number.v && !t.m_bCompact)
+				vHeads.push_back(&t);
+		}
+
+		for (size_t i = 0; i < vHeads.size(); i++)
+		{
+			const Task& h = *vHeads[i];
+
+			Block::Number numLast = (h.m_Key.first.m_Number.v <= m_Processor.m_SyncData.m_Target.m_Number.v) ?
+				m_Processor.m_SyncData.m_Target.m_Number : // don't cross the fast-sync target
+				h.m_sidTrg.m_Number;
+
+			if (numLast.v > h.m_sidTrg.m_Number.v)
+				continue;
+
+			uint64_t hCountExtra = h.m_sidTrg.m_Number.v - h.m_Key.first.m_Number.v;
+			const uint64_t* pRows = m_Processor.get_CachedRows(h.m_sidTrg, hCountExtra);
+			if (!pRows)
+				continue;
+
+			for (Block::Number num(h.m_Key.first.m_Number.v + h.m_nCount); (num.v <= numLast.v) && (m_nTasksBody < nMaxPacks); )
+			{
+				uint64_t row = pRows[hCountExtra - (num.v - h.m_Key.first.m_Number.v)];
+				if (NodeDB::StateFlags::Functional & m_Processor.get_DB().GetStateFlags(row))
+				{
+					num.v++;
+					continue;
+				}
+
+				Task tKey;
+				tKey.m_Key.first.m_Number = num;
+				m_Processor.get_DB().get_StateHash(row, tKey.m_Key.first.m_Hash);
+				tKey.m_Key.second = true;
+
+				TaskSet::iterator it = m_setTasks.find(tKey);
+				Task& t = (m_setTasks.end() == it) ? *CreateBodyTask(tKey.m_Key.first, h.m_sidTrg) : *it;
+
+				if (!t.m_pOwner)
+				{
+					TryAssignTask(t);
+					if (!t.m_pOwner)
+					{
+						if (!t.m_bNeeded)
+							DeleteUnassignedTask(t);
+						break; // no idle peers
+					}
+
+					pRows = m_Processor.get_CachedRows(h.m_sidTrg, hCountExtra); // could be rebuilt
+					if (!pRows)
+						break;
+				}
+
+				num.v += t.m_nCount;
+			}
+		}
+	}
+
+	if (m_nTasksBody)
+	{
+		if (!m_bTimerBodies)
+		{
+			if (!m_pTimerBodies)
+				m_pTimerBodies = io::Timer::create(io::Reactor::get_Current());
+
+			m_pTimerBodies->start(1000, true, [this]() { OnTimerBodies(); });
+			m_bTimerBodies = true;
+		}
+	}
+	else
+	{
+		if (m_bTimerBodies)
+		{
+			m_pTimerBodies->cancel();
+			m_bTimerBodies = false;
+		}
+	}
+}
+
+void Node::CheckBodyStragglers()
+{
+	if (!m_BodyRate.m_SizePerBlock)
+		return;
+
+	PeerManager::TimePoint tp;
+
+	// the first missing ranges (requested by the processor) stall the pipeline if late
+	std::vector<Task*> vLate;
+	for (TaskSet::iterator it = m_setTasks.begin(); m_setTasks.end() != it; ++it)
+	{
+		Task& t = *it;
+		if (!t.m_Key.second || !t.m_bNeeded || !t.m_pOwner || !t.m_Key.first.m_Number.v || t.m_bCompact)
+			continue;
+
+		if (m_setTasks.count(t) > 1)
+			continue; // already re-requested
+
+		const Peer& p = *t.m_pOwner;
+		uint64_t nExpected_ms = p.m_DataRate.get_Expected_ms(static_cast<uint64_t>(t.m_nCount) * m_BodyRate.m_SizePerBlock, p.get_BodyBps());
+		uint32_t dt_ms = tp.get() - t.m_TimeAssigned_ms;
+
+		if (dt_ms > nExpected_ms * std::max(m_Cfg.m_BandwidthCtl.m_StragglerFactor, 1U))
+			vLate.push_back(&t);
+	}
+
+	for (size_t i = 0; i < vLate.size(); i++)
+	{
+		Task& t = *vLate[i];
+		Peer& p = *t.m_pOwner;
+
+		// request the same range from another idle peer, whichever responds first. The late one is busy, hence excluded
+		Task& t2 = *CreateBodyTask(t.m_Key.first, t.m_sidTrg);
+		t2.m_bNeeded = true;
+
+		TryAssignTask(t2);
+
+		if (t2.m_pOwner)
+		{
+			m_nBodyRerequests++;
+			BEAM_LOG_INFO() << "Peer " << p.m_RemoteAddr << " is late with blocks from " << t.m_Key.first << ", re-requested from " << t2.m_pOwner->m_RemoteAddr;
+		}
+		else
+			DeleteUnassignedTask(t2);
+	}
+}
+
+void Node::OnTimerBodies()
+{
+	CheckBodyStragglers();
+	PlanBodyPacks();
+}
+
 void Node::Processor::RequestData(const Block::SystemState::ID& id, bool bBlock, const NodeDB::StateID& sidTrg)
 {
 	Node::Task tKey;
@@ -539,6 +833,8 @@ void Node::Processor::RequestData(const Block::SystemState::ID& id, bool bBlock,
 		pTask->m_bNeeded = true;
 		pTask->m_nCount = 0;
 		pTask->m_pOwner = NULL;
+		pTask->m_bCompact = false;
+		pTask->m_bNoCompact = false;
 
 		get_ParentObj().m_setTasks.insert(*pTask);
 		get_ParentObj().m_lstTasksUnassigned.push_back(*pTask);
@@ -787,49 +1083,144 @@ void Node::Processor::OnFastSyncSucceeded()
 	}
 }
 
+static bool RecoveryMoveFile(const std::string& sTmp, const std::string& sPath)
+{
+#ifdef WIN32
+	return
+		MoveFileExW(Utf8toUtf16(sTmp.c_str()).c_str(), Utf8toUtf16(sPath.c_str()).c_str(), MOVEFILE_REPLACE_EXISTING) ||
+		(GetLastError() == ERROR_FILE_NOT_FOUND);
+#else // WIN32
+	return
+		!rename(sTmp.c_str(), sPath.c_str()) ||
+		(ENOENT == errno);
+#endif // WIN32
+}
+
 void Node::MaybeGenerateRecovery()
 {
 	if (!m_PostStartSynced || m_Cfg.m_Recovery.m_sPathOutput.empty() || !m_Cfg.m_Recovery.m_Granularity)
 		return;
 
-	Height h0 = m_Processor.get_DB().ParamIntGetDef(NodeDB::ParamID::LastRecoveryHeight);
+	RecoveryWriter& rw = m_RecoveryWriter;
+	if (rw.IsBusy())
+		return; // the previous file is still being written
+
+	NodeDB& db = m_Processor.get_DB();
+
+	Height h0 = db.ParamIntGetDef(NodeDB::ParamID::LastRecoveryHeight);
 	Height h1 = m_Processor.m_Cursor.m_hh.m_Height;
 	if (h1 < h0 + m_Cfg.m_Recovery.m_Granularity)
 		return;
 
-	BEAM_LOG_INFO() << "Generating recovery...";
-
 	std::ostringstream os;
 	os
 		<< m_Cfg.m_Recovery.m_sPathOutput
 		<< m_Processor.m_Cursor.m_hh;
 
-	std::string sPath = os.str();
+	rw.m_sPath = os.str();
+	rw.m_Buf.clear();
 
-	std::string sTmp = sPath;
-	sTmp += ".tmp";
+	// the data is collected here (the DB is accessed by this thread only), the file is written by the worker thread
+	uint64_t nChain = db.ParamIntGetDef(NodeDB::ParamID::RecoveryChain);
+	if (nChain && (nChain <= m_Cfg.m_Recovery.m_Deltas) && (h0 < h1))
+	{
+		BEAM_LOG_INFO() << "Generating recovery delta...";
+
+		if (GenerateRecoveryDelta(rw.m_Buf, h0))
+		{
+			rw.m_sPath += ".delta";
+			rw.m_Full = false;
+		}
+		else
+		{
+			BEAM_LOG_INFO() << "Recovery delta generation failed";
+			rw.m_Buf.clear();
+		}
+	}
 
-	bool bOk = GenerateRecoveryInfo(sTmp.c_str());
-	if (bOk)
+	if (rw.m_Buf.empty())
 	{
-#ifdef WIN32
-		bOk =
-			MoveFileExW(Utf8toUtf16(sTmp.c_str()).c_str(), Utf8toUtf16(sPath.c_str()).c_str(), MOVEFILE_REPLACE_EXISTING) ||
-			(GetLastError() == ERROR_FILE_NOT_FOUND);
-#else // WIN32
-		bOk =
-			!rename(sTmp.c_str(), sPath.c_str()) ||
-			(ENOENT == errno);
-#endif // WIN32
+		BEAM_LOG_INFO() << "Generating recovery...";
+
+		if (!GenerateRecoveryInfo(rw.m_Buf))
+		{
+			BEAM_LOG_INFO() << "Recovery generation failed";
+			ByteBuffer().swap(rw.m_Buf);
+			return;
+		}
+
+		rw.m_Full = true;
 	}
 
-	if (bOk) {
-		BEAM_LOG_INFO() << "Recovery generation done";
-		m_Processor.get_DB().ParamIntSet(NodeDB::ParamID::LastRecoveryHeight, h1);
-	} else
+	rw.m_Height = h1;
+	rw.m_Ok = false;
+	rw.m_Orphaned = false;
+
+	if (!rw.m_pEvt)
+		rw.m_pEvt = io::AsyncEvent::create(io::Reactor::get_Current(), [this]() { OnRecoveryWritten(); });
+
+	rw.m_Thread = std::thread(&RecoveryWriter::Write, &rw);
+}
+
+void Node::RecoveryWriter::Write()
+{
+	std::string sTmp = m_sPath + ".tmp";
+
+	try
 	{
-		BEAM_LOG_INFO() << "Recovery generation failed";
+		std::FStream fs;
+		fs.Open(sTmp.c_str(), false, true);
+		fs.write(m_Buf.data(), m_Buf.size());
+		fs.Close();
+
+		m_Ok = RecoveryMoveFile(sTmp, m_sPath);
+	}
+	catch (const std::exception& ex)
+	{
+		BEAM_LOG_ERROR() << ex.what();
+		m_Ok = false;
+	}
+
+	if (!m_Ok)
 		beam::DeleteFile(sTmp.c_str());
+
+	m_pEvt->post();
+}
+
+void Node::OnRecoveryWritten()
+{
+	RecoveryWriter& rw = m_RecoveryWriter;
+	if (!rw.IsBusy())
+		return;
+
+	rw.m_Thread.join();
+	ByteBuffer().swap(rw.m_Buf);
+
+	if (!rw.m_Ok)
+	{
+		BEAM_LOG_INFO() << "Recovery generation failed";
+		return;
+	}
+
+	if (rw.m_Orphaned)
+	{
+		BEAM_LOG_INFO() << "Recovery discarded";
+		beam::DeleteFile(rw.m_sPath.c_str());
+		return;
+	}
+
+	BEAM_LOG_INFO() << "Recovery generation done";
+
+	NodeDB& db = m_Processor.get_DB();
+	db.ParamIntSet(NodeDB::ParamID::LastRecoveryHeight, rw.m_Height);
+
+	if (rw.m_Full)
+		db.ParamIntSet(NodeDB::ParamID::RecoveryChain, 1);
+	else
+	{
+		uint64_t nChain = db.ParamIntGetDef(NodeDB::ParamID::RecoveryChain);
+		if (nChain)
+			db.ParamIntSet(NodeDB::ParamID::RecoveryChain, nChain + 1);
 	}
 }
 
@@ -877,6 +1268,14 @@ void Node::Processor::OnRolledBack()
 
 	get_ParentObj().m_TxDependent.Clear();
 
+	// recovery deltas can't be appended to the files beyond the rollback
+	if (m_Cursor.m_hh.m_Height < get_DB().ParamIntGetDef(NodeDB::ParamID::LastRecoveryHeight))
+		get_DB().ParamIntSet(NodeDB::ParamID::RecoveryChain, 0);
+
+	RecoveryWriter& rw = get_ParentObj().m_RecoveryWriter;
+	if (rw.IsBusy() && (m_Cursor.m_hh.m_Height < rw.m_Height))
+		rw.m_Orphaned = true;
+
 	IObserver* pObserver = get_ParentObj().m_Cfg.m_Observer;
 	if (pObserver)
 		pObserver->OnRolledBack();
@@ -1126,10 +1525,12 @@ void Node::Initialize()
 	RefreshAccounts();
 
 	ZeroObject(m_SyncStatus);
+	ZeroObject(m_SyncStatusReported);
 	RefreshCongestions();
 
 	if (m_Cfg.m_Listen.port())
 	{
+		m_IoShards.Start(m_Cfg.m_IoThreads);
 		m_Server.Listen(m_Cfg.m_Listen);
 		if (m_Cfg.m_BeaconPeriod_ms)
 			m_Beacon.Start();
@@ -1513,11 +1914,15 @@ Node::~Node()
 	while (!m_lstPeers.empty())
 		m_lstPeers.front().DeleteSelf(false, proto::NodeConnection::ByeReason::Stopping);
 
+	m_IoShards.Stop();
+
 	while (!m_lstTasksUnassigned.empty())
 		DeleteUnassignedTask(m_lstTasksUnassigned.front());
 
 	assert(m_setTasks.empty());
 
+	OnRecoveryWritten(); // wait for the pending recovery file, if any
+
 	m_Processor.Stop();
 
 	if (!std::uncaught_exceptions() && m_Processor.get_DB().IsOpen())
@@ -1894,6 +2299,12 @@ void Node::Peer::ReleaseTask(Task& t)
 
 		nCounter -= t.m_nCount;
 		t.m_nCount = 0;
+
+		if (t.m_Key.second)
+		{
+			assert(m_This.m_nTasksBody);
+			m_This.m_nTasksBody--;
+		}
 	}
 
 	m_lstTasks.erase(TaskList::s_iterator_to(t));
@@ -1999,6 +2410,8 @@ void Node::Peer::TakeTasks()
 
 	for (TaskList::iterator it = m_This.m_lstTasksUnassigned.begin(); m_This.m_lstTasksUnassigned.end() != it; )
 		m_This.TryAssignTask(*it++, *this);
+
+	m_This.PlanBodyPacks();
 }
 
 void Node::Peer::OnMsg(proto::Pong&&)
@@ -2084,6 +2497,7 @@ Node::Task& Node::Peer::get_FirstTask()
 
 void Node::Peer::OnFirstTaskDone()
 {
+	m_DataRate.m_tLast_ms = PeerManager::TimePoint().get();
 	ReleaseTask(get_FirstTask());
 	SetTimerWrtFirstTask();
 
@@ -2114,6 +2528,14 @@ void Node::Peer::ModifyRatingWrtData(size_t nSize)
 
 	uint32_t nRatingAvg = PeerManager::Rating::FromBps(bwAvg);
 
+	if (nSize)
+	{
+		// don't account for the time the request was queued behind the previous one
+		const Task& t = get_FirstTask();
+		uint32_t tStart_ms = (m_DataRate.m_tLast_ms && (static_cast<int32_t>(m_DataRate.m_tLast_ms - t.m_TimeAssigned_ms) > 0)) ? m_DataRate.m_tLast_ms : t.m_TimeAssigned_ms;
+		m_DataRate.OnResponse(tp.get() - tStart_ms, nSize, t.m_Key.second);
+	}
+
 	m_This.m_PeerMan.m_LiveSet.erase(PeerMan::LiveSet::s_iterator_to(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live));
 	m_This.m_PeerMan.SetRating(*m_pInfo, nRatingAvg);
 	m_This.m_PeerMan.m_LiveSet.insert(Cast::Up<PeerMan::PeerInfoPlus>(m_pInfo)->m_Live);
@@ -2211,22 +2633,149 @@ void Node::Peer::SendHdrs(NodeDB::StateID& sid, uint32_t nCount)
 	Send(proto::DataMissing());
 }
 
-bool Node::DecodeAndCheckHdrs(std::vector<Block::SystemState::Full>& v, const proto::HdrPack& msg)
+struct Node::HdrsVerifyTask
+	:public Executor::TaskAsync
 {
-	if (msg.m_vElements.empty() || (msg.m_vElements.size() > proto::g_HdrPackMaxSize))
-		return false;
+	const Block::SystemState::Full* m_pV;
+	uint32_t m_Count;
+	uint8_t* m_pInvalid;
 
-	// PoW verification is heavy for big packs. Do it in parallel
-	Executor::Scope scope(m_Processor.m_ExecutorMT);
+	void Exec(Executor::Context&) override
+	{
+		for (uint32_t i = 0; i < m_Count; i++)
+		{
+			if (!m_pV[i].IsValid())
+			{
+				*m_pInvalid = 1;
+				break;
+			}
+		}
+	}
+};
 
-	proto::FlyClient::Data::DecodedHdrPack ex;
-	if (!ex.DecodeAndCheck(msg))
-		return false;
+bool Node::InsertHdrsPipelined(const std::vector<Block::SystemState::Full>& v, const PeerID& pid)
+{
+	// PoW of the next chunk is verified on the worker threads, while the current chunk is inserted into the DB
+	const uint32_t nChunk = 256;
+
+	ExecutorMT& ex = m_Processor.m_ExecutorMT;
+	uint32_t nThreads = ex.get_Threads();
+	uint32_t nTotal = static_cast<uint32_t>(v.size());
+	uint32_t nChunks = (nTotal + nChunk - 1) / nChunk;
+
+	std::vector<uint8_t> vInvalid(nChunks * nThreads, 0);
+
+	struct FlushGuard
+	{
+		ExecutorMT& m_Ex;
+		~FlushGuard() { m_Ex.Flush(0); } // tasks reference the local data
+	} fg { ex };
+
+	auto fnPush = [&](uint32_t iChunk)
+	{
+		uint32_t i0 = iChunk * nChunk;
+		uint32_t n = std::min(nChunk, nTotal - i0);
+
+		for (uint32_t iThread = 0; iThread < nThreads; iThread++)
+		{
+			uint32_t i1 = i0 + n * iThread / nThreads;
+			uint32_t i2 = i0 + n * (iThread + 1) / nThreads;
+			if (i1 == i2)
+				continue;
+
+			auto pTask = std::make_unique<HdrsVerifyTask>();
+			pTask->m_pV = &v[i1];
+			pTask->m_Count = i2 - i1;
+			pTask->m_pInvalid = &vInvalid[iChunk * nThreads + iThread];
+
+			ex.Push(std::move(pTask));
+		}
+	};
+
+	fnPush(0);
+	ex.Flush(0);
+
+	for (uint32_t iChunk = 0; iChunk < nChunks; iChunk++)
+	{
+		for (uint32_t iThread = 0; iThread < nThreads; iThread++)
+			if (vInvalid[iChunk * nThreads + iThread])
+				return false;
+
+		if (iChunk + 1 < nChunks)
+			fnPush(iChunk + 1);
+
+		uint32_t i1 = std::min(nTotal, (iChunk + 1) * nChunk);
+		for (uint32_t i = iChunk * nChunk; i < i1; i++)
+		{
+			Block::SystemState::ID id;
+			if (NodeProcessor::DataStatus::Invalid == m_Processor.OnStateSilent(v[i], pid, id, true))
+				return false; // though PoW was already tested, header can still be invalid. For instance, due to improper Timestamp
+		}
+
+		ex.Flush(0);
+	}
 
-	v = std::move(ex.m_vStates);
 	return true;
 }
 
+void Node::HdrRate::OnHdrs(SyncStatus& ss, uint32_t nCount)
+{
+	uint32_t t_ms = GetTime_ms();
+	if (!m_Count && !ss.m_HdrsPerSec)
+		m_t0_ms = t_ms;
+
+	m_Count += nCount;
+
+	uint32_t dt_ms = t_ms - m_t0_ms;
+	if (dt_ms >= 1000)
+	{
+		ss.m_HdrsPerSec = static_cast<uint32_t>(uint64_t(m_Count) * 1000 / dt_ms);
+		m_Count = 0;
+		m_t0_ms = t_ms;
+	}
+}
+
+void Node::HdrRate::Reset(SyncStatus& ss)
+{
+	ss.m_HdrsPerSec = 0;
+	m_Count = 0;
+}
+
+void Node::BodyRate::OnBodies(SyncStatus& ss, uint32_t nCount, uint64_t nSize)
+{
+	if (!nCount)
+		return;
+
+	uint32_t nSizePerBlock = static_cast<uint32_t>(std::min<uint64_t>(nSize / nCount, static_cast<uint32_t>(-1)));
+	m_SizePerBlock = m_SizePerBlock ? (m_SizePerBlock - m_SizePerBlock / 4 + nSizePerBlock / 4) : nSizePerBlock;
+	std::setmax(m_SizePerBlock, 1U);
+
+	uint32_t t_ms = GetTime_ms();
+	if (!m_Count && !ss.m_BlocksPerSec)
+		m_t0_ms = t_ms;
+
+	m_Count += nCount;
+	m_Size += nSize;
+
+	uint32_t dt_ms = t_ms - m_t0_ms;
+	if (dt_ms >= 1000)
+	{
+		ss.m_BlocksPerSec = static_cast<uint32_t>(uint64_t(m_Count) * 1000 / dt_ms);
+		ss.m_BytesPerSec = static_cast<uint32_t>(std::min<uint64_t>(m_Size * 1000 / dt_ms, static_cast<uint32_t>(-1)));
+		m_Count = 0;
+		m_Size = 0;
+		m_t0_ms = t_ms;
+	}
+}
+
+void Node::BodyRate::Reset(SyncStatus& ss)
+{
+	ss.m_BlocksPerSec = 0;
+	ss.m_BytesPerSec = 0;
+	m_Count = 0;
+	m_Size = 0;
+}
+
 void Node::Peer::OnMsg(proto::HdrPack&& msg)
 {
 	Task& t = get_FirstTask();
@@ -2236,35 +2785,24 @@ void Node::Peer::OnMsg(proto::HdrPack&& msg)
 		ThrowUnexpected();
 	}
 
-	std::vector<Block::SystemState::Full> v;
-	if (!m_This.DecodeAndCheckHdrs(v, msg))
+	if (msg.m_vElements.empty() || (msg.m_vElements.size() > proto::g_HdrPackMaxSize))
 		ThrowUnexpected();
 
+	std::vector<Block::SystemState::Full> v;
+	proto::FlyClient::Data::DecodedHdrPack::Decode(v, msg);
+
 	// just to be pedantic, AND prevent non-stamped hdrs in pbft-w mode
 	Block::SystemState::ID idLast;
 	v.back().get_ID(idLast);
 	if (!(idLast == t.m_Key.first))
 		ThrowUnexpected();
 
-	for (size_t i = 0; i < v.size(); i++)
-	{
-		NodeProcessor::DataStatus::Enum eStatus = m_This.m_Processor.OnStateSilent(v[i], m_pInfo->m_ID.m_Key, idLast, true);
-		switch (eStatus)
-		{
-		case NodeProcessor::DataStatus::Invalid:
-			// though PoW was already tested, header can still be invalid. For instance, due to improper Timestamp
-			ThrowUnexpected();
-			break;
+	if (!m_This.InsertHdrsPipelined(v, m_pInfo->m_ID.m_Key))
+		ThrowUnexpected();
 
-		case NodeProcessor::DataStatus::Accepted:
-			// no break;
+	m_This.m_HdrRate.OnHdrs(m_This.m_SyncStatus, static_cast<uint32_t>(v.size()));
 
-		default:
-			break; // suppress warning
-		}
-	}
-
-	BEAM_LOG_INFO() << "Hdr pack received " << msg.m_Prefix.m_Number.v << "-" << idLast;
+	BEAM_LOG_INFO() << "Hdr pack received " << msg.m_Prefix.m_Number.v << "-" << idLast << ", " << m_This.m_SyncStatus.m_HdrsPerSec << " hdrs/s";
 
 	ModifyRatingWrtData(sizeof(msg.m_Prefix) + msg.m_vElements.size() * sizeof(msg.m_vElements.front()));
 
@@ -2280,6 +2818,40 @@ void Node::Peer::OnMsg(proto::GetBody&& msg)
 }
 
 void Node::Peer::OnMsg(proto::GetBodyPack&& msg)
+{
+	if (m_This.m_Cfg.m_TestMode.m_FakeBodyPackDelay_ms)
+	{
+		// emulate a slow peer. The requests are answered in order
+		m_lstDelayedBodyPacks.push_back(std::move(msg));
+		if (1 == m_lstDelayedBodyPacks.size())
+			SetTimerDelayedBodyPack();
+		return;
+	}
+
+	SendBodyPack(msg);
+}
+
+void Node::Peer::SetTimerDelayedBodyPack()
+{
+	if (!m_pTimerDelayedBodyPack)
+		m_pTimerDelayedBodyPack = io::Timer::create(io::Reactor::get_Current());
+
+	m_pTimerDelayedBodyPack->start(m_This.m_Cfg.m_TestMode.m_FakeBodyPackDelay_ms, false, [this]() { OnTimerDelayedBodyPack(); });
+}
+
+void Node::Peer::OnTimerDelayedBodyPack()
+{
+	assert(!m_lstDelayedBodyPacks.empty());
+	proto::GetBodyPack msg = std::move(m_lstDelayedBodyPacks.front());
+	m_lstDelayedBodyPacks.pop_front();
+
+	if (!m_lstDelayedBodyPacks.empty())
+		SetTimerDelayedBodyPack();
+
+	SendBodyPack(msg);
+}
+
+void Node::Peer::SendBodyPack(const proto::GetBodyPack& msg)
 {
 	Processor& p = m_This.m_Processor; // alias
 
@@ -2373,6 +2945,7 @@ bool Node::Peer::GetBlock(proto::BodyBuffers& out, const NodeDB::StateID& sid, c
 	switch (msg.m_FlagP)
 	{
 	case proto::BodyBuffers::Recovery1:
+	case proto::BodyBuffers::Compact:
 	case proto::BodyBuffers::Full:
 		pP = &out.m_Perishable;
 		// no break;
@@ -2406,12 +2979,112 @@ bool Node::Peer::GetBlock(proto::BodyBuffers& out, const NodeDB::StateID& sid, c
 			yas::detail::saveRecovery(ser, outp, h);
 		}
 
-		ser & Cast::Down<Block::BodyBase>(block);
-		ser & Cast::Down<TxVectors::Perishable>(block);
+		ser & Cast::Down<Block::BodyBase>(block);
+		ser & Cast::Down<TxVectors::Perishable>(block);
+
+		ser.swap_buf(out.m_Perishable);
+	}
+
+	if (proto::BodyBuffers::Compact == msg.m_FlagP)
+	{
+		Block::Body block;
+
+		Deserializer der;
+		der.reset(out.m_Perishable);
+		der & Cast::Down<Block::BodyBase>(block);
+		der & Cast::Down<TxVectors::Perishable>(block);
+
+		Serializer ser;
+		ser & Cast::Down<Block::BodyBase>(block);
+		ser & block.m_vInputs;
+		ser & block.m_vOutputs.size();
+
+		for (const auto& pOutp : block.m_vOutputs)
+		{
+			// coinbase outputs never pass through the tx pool, send them as-is
+			uint8_t nRef = pOutp->m_Coinbase ? 0 : 1;
+			ser & nRef;
+
+			if (nRef)
+			{
+				// reference the whole output, not just its commitment (the incubation and proofs may differ)
+				ECC::Hash::Value hv;
+				ECC::Hash::Processor().Serialize(*pOutp) >> hv;
+				ser & hv;
+			}
+			else
+				ser & *pOutp;
+		}
+
+		ser.swap_buf(out.m_Perishable);
+	}
+
+	return true;
+}
+
+bool Node::RestoreCompactBody(ByteBuffer& bufP)
+{
+	Block::Body block;
+	size_t nOutputs = 0;
+
+	Deserializer der;
+	der.reset(bufP);
+	der & Cast::Down<Block::BodyBase>(block);
+	der & block.m_vInputs;
+	der & nOutputs;
+
+	if (nOutputs > bufP.size())
+		return false; // each output takes at least 1 byte
+
+	std::map<ECC::Hash::Value, const Output*> mapPool; // filled on demand, keyed by the output hash
+	block.m_vOutputs.resize(nOutputs);
+
+	for (auto& pOutp : block.m_vOutputs)
+	{
+		pOutp = std::make_unique<Output>();
+
+		uint8_t nRef = 0;
+		der & nRef;
+
+		if (!nRef)
+		{
+			der & *pOutp;
+			continue;
+		}
+
+		ECC::Hash::Value hv;
+		der & hv;
+
+		if (mapPool.empty())
+		{
+			for (const auto& x : m_TxPool.m_setTxs)
+				for (const auto& pPoolOutp : x.get_ParentObj().m_pValue->m_vOutputs)
+				{
+					ECC::Hash::Value hvPool;
+					ECC::Hash::Processor().Serialize(*pPoolOutp) >> hvPool;
+					mapPool[hvPool] = pPoolOutp.get();
+				}
+		}
+
+		auto it = mapPool.find(hv);
+		if (mapPool.end() == it)
+			return false;
+
+		// Output is not copyable, clone via serialization
+		Serializer ser;
+		ser & *it->second;
 
-		ser.swap_buf(out.m_Perishable);
+		auto buf = ser.buffer();
+		Deserializer der2;
+		der2.reset(buf.first, buf.second);
+		der2 & *pOutp;
 	}
 
+	Serializer ser;
+	ser & Cast::Down<Block::BodyBase>(block);
+	ser & Cast::Down<TxVectors::Perishable>(block);
+
+	ser.swap_buf(bufP);
 	return true;
 }
 
@@ -2429,13 +3102,42 @@ void Node::Peer::OnMsg(proto::Body&& msg)
 	if (!t.m_Key.second)
 		ThrowUnexpected();
 
-	ModifyRatingWrtData(msg.m_Body.m_Eternal.size() + msg.m_Body.m_Perishable.size());
+	size_t nSize = msg.m_Body.m_Eternal.size() + msg.m_Body.m_Perishable.size();
+	ModifyRatingWrtData(nSize);
 
 	const Block::SystemState::ID& id = t.m_Key.first;
 	auto num = id.m_Number;
 
 	Processor& p = m_This.m_Processor; // alias
 
+	if (t.m_bCompact)
+	{
+		if (!m_This.RestoreCompactBody(msg.m_Body.m_Perishable))
+		{
+			BEAM_LOG_INFO() << id << " compact body can't be restored from the tx pool, requesting full";
+
+			t.m_bNoCompact = true;
+			OnFirstTaskDone(); // the task is still needed, will be reassigned
+			return;
+		}
+
+		m_This.m_nCompactBodies++;
+
+		uint32_t dt_ms = m_This.m_BodyPropagation.OnReceived(t.m_TimeAssigned_ms);
+		BEAM_LOG_INFO() << id << " compact body restored, received " << nSize << " bytes, propagation " << dt_ms << " ms";
+	}
+	else
+	{
+		if (num.v)
+		{
+			if (t.m_sidTrgRequested.m_Number.v > num.v)
+				m_This.m_BodyRate.OnBodies(m_This.m_SyncStatus, 1, nSize); // part of a range being synced, not a new tip
+
+			uint32_t dt_ms = m_This.m_BodyPropagation.OnReceived(t.m_TimeAssigned_ms);
+			BEAM_LOG_INFO() << id << " body received, " << nSize << " bytes, propagation " << dt_ms << " ms";
+		}
+	}
+
 	NodeProcessor::DataStatus::Enum eStatus = num.v ?
 		ShouldAcceptBodyPack() ?
 			p.OnBlock(id, msg.m_Body.m_Perishable, msg.m_Body.m_Eternal, m_pInfo->m_ID.m_Key) :
@@ -2470,6 +3172,7 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 			msg.m_Bodies[i].m_Perishable.size();
 	}
 	ModifyRatingWrtData(nSize);
+	m_This.m_BodyRate.OnBodies(m_This.m_SyncStatus, static_cast<uint32_t>(msg.m_Bodies.size()), nSize);
 
 	NodeProcessor::DataStatus::Enum eStatus = NodeProcessor::DataStatus::Rejected;
 	if (!msg.m_Bodies.empty() && ShouldAcceptBodyPack())
@@ -2477,7 +3180,8 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 		const uint64_t* pPtr = p.get_CachedRows(t.m_sidTrgRequested, hCountExtra);
 		if (pPtr)
 		{
-			BEAM_LOG_INFO() << id << " Block pack received " << id.m_Number.v << "-" << (id.m_Number.v + msg.m_Bodies.size() - 1);
+			uint32_t dt_ms = m_This.m_BodyPropagation.OnReceived(t.m_TimeAssigned_ms);
+			BEAM_LOG_INFO() << id << " Block pack received " << id.m_Number.v << "-" << (id.m_Number.v + msg.m_Bodies.size() - 1) << ", " << m_This.m_SyncStatus.m_BlocksPerSec << " blocks/s, propagation " << dt_ms << " ms";
 
 			eStatus = NodeProcessor::DataStatus::Accepted;
 
@@ -2487,6 +3191,12 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 				sid.m_Row = pPtr[hCountExtra - n];
 				sid.m_Number.v = id.m_Number.v + n;
 
+				if (NodeDB::StateFlags::Functional & p.get_DB().GetStateFlags(sid.m_Row))
+				{
+					m_This.m_nBodyDuplicates++;
+					continue; // already received, the range could be re-requested from another peer
+				}
+
 				const proto::BodyBuffers& bb = msg.m_Bodies[n];
 
 				NodeProcessor::DataStatus::Enum es2 = p.OnBlock(sid, bb.m_Perishable, bb.m_Eternal, m_pInfo->m_ID.m_Key);
@@ -2503,6 +3213,15 @@ void Node::Peer::OnMsg(proto::BodyPack&& msg)
 	OnFirstTaskDone(eStatus);
 }
 
+uint32_t Node::BodyPropagation::OnReceived(uint32_t tRequested_ms)
+{
+	PeerManager::TimePoint tp;
+	m_Last_ms = tp.get() - tRequested_ms;
+	m_Total_ms += m_Last_ms;
+	m_Count++;
+	return m_Last_ms;
+}
+
 void Node::Peer::OnFirstTaskDone(NodeProcessor::DataStatus::Enum eStatus)
 {
 	if (NodeProcessor::DataStatus::Invalid == eStatus)
@@ -3734,12 +4453,51 @@ void Node::Peer::OnMsg(proto::GetProofKernel3&& msg)
 	Send(msgOut);
 }
 
-void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
+void Node::Processor::AppendProofTail(Merkle::Proof& proof, ProofTails::Elem e)
+{
+	// current state only
+	ProofTails::Key key(m_Cursor.m_Row, e);
+	if (m_ProofTails.Append(proof, key))
+		return;
+
+	struct MyProofBuilder
+		:public NodeProcessor::ProofBuilder
+	{
+		using ProofBuilder::ProofBuilder;
+		ProofTails::Elem m_Elem;
+
+		bool get_Utxos(Merkle::Hash& hv) override {
+			return (ProofTails::Elem::Utxos != m_Elem) && ProofBuilder::get_Utxos(hv);
+		}
+		bool get_Shielded(Merkle::Hash& hv) override {
+			return (ProofTails::Elem::Shielded != m_Elem) && ProofBuilder::get_Shielded(hv);
+		}
+		bool get_Assets(Merkle::Hash& hv) override {
+			return (ProofTails::Elem::Assets != m_Elem) && ProofBuilder::get_Assets(hv);
+		}
+		bool get_Contracts(Merkle::Hash& hv) override {
+			return (ProofTails::Elem::Contracts != m_Elem) && ProofBuilder::get_Contracts(hv);
+		}
+	};
+
+	assert((ProofTails::Elem::Kernels != e) && (ProofTails::Elem::Logs != e)); // those are for past states
+
+	size_t iPos = proof.size();
+
+	MyProofBuilder pb(*this, proof);
+	pb.m_Elem = e;
+	pb.GenerateProof();
+
+	m_ProofTails.Save(proof, iPos, key);
+}
+
+void Node::Processor::GenerateProofsUtxo(std::vector<Input::Proof>& vRes, const ECC::Point& comm, Height hMaturityMin, Merkle::Proof* pCommon)
 {
 	struct Traveler :public UtxoTree::ITraveler
 	{
-		proto::ProofUtxo m_Msg;
-		NodeProcessor& m_Proc;
+		std::vector<Input::Proof>& m_vRes;
+		Node::Processor& m_Proc;
+		Merkle::Proof* m_pCommon;
 
 		bool OnLeaf(const RadixTree::Leaf& x) override {
 
@@ -3747,53 +4505,80 @@ void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
 			UtxoTree::Key::Data d;
 			d = v.m_Key;
 
-			Input::Proof& ret = m_Msg.m_Proofs.emplace_back();
+			Input::Proof& ret = m_vRes.emplace_back();
 
 			ret.m_State.m_Count = v.get_Count();
 			ret.m_State.m_Maturity = d.m_Maturity;
 			m_Proc.get_Utxos().get_Proof(ret.m_Proof, *m_pCu);
 
-			struct MyProofBuilder
-				:public NodeProcessor::ProofBuilder
+			if (m_pCommon)
 			{
-				using ProofBuilder::ProofBuilder;
-				bool get_Utxos(Merkle::Hash&) override { return false; }
-			};
-
-			MyProofBuilder pb(m_Proc, ret.m_Proof);
-			pb.GenerateProof();
+				if (m_pCommon->empty())
+					m_Proc.AppendProofTail(*m_pCommon, ProofTails::Elem::Utxos);
+			}
+			else
+				m_Proc.AppendProofTail(ret.m_Proof, ProofTails::Elem::Utxos);
 
-			return m_Msg.m_Proofs.size() < Input::Proof::s_EntriesMax;
+			return m_vRes.size() < Input::Proof::s_EntriesMax;
 		}
 
-		Traveler(NodeProcessor& np) :m_Proc(np) {}
+		Traveler(std::vector<Input::Proof>& vRes, Node::Processor& np, Merkle::Proof* pCommon)
+			:m_vRes(vRes)
+			,m_Proc(np)
+			,m_pCommon(pCommon)
+		{
+		}
 	};
 
-	Processor& p = m_This.m_Processor;
-	Traveler t(p);
+	Traveler t(vRes, *this, pCommon);
+
+	UtxoTree::Cursor cu;
+	t.m_pCu = &cu;
+
+	// bounds
+	UtxoTree::Key kMin, kMax;
+
+	UtxoTree::Key::Data d;
+	d.m_Commitment = comm;
+	d.m_Maturity = hMaturityMin;
+	kMin = d;
+	d.m_Maturity = Height(-1);
+	kMax = d;
+
+	t.m_pBound[0] = kMin.V.m_pData;
+	t.m_pBound[1] = kMax.V.m_pData;
+
+	get_Utxos().Traverse(t);
+}
 
+void Node::Peer::OnMsg(proto::GetProofUtxo&& msg)
+{
+	proto::ProofUtxo msgOut;
+
+	Processor& p = m_This.m_Processor;
 	if (!p.IsFastSync())
-	{
-		UtxoTree::Cursor cu;
-		t.m_pCu = &cu;
+		p.GenerateProofsUtxo(msgOut.m_Proofs, msg.m_Utxo, msg.m_MaturityMin, nullptr);
+
+	Send(msgOut);
+}
 
-		// bounds
-		UtxoTree::Key kMin, kMax;
+void Node::Peer::OnMsg(proto::GetProofUtxoBatch&& msg)
+{
+	if (msg.m_Utxos.size() > proto::g_ProofUtxoBatchMaxSize)
+		ThrowUnexpected();
 
-		UtxoTree::Key::Data d;
-		d.m_Commitment = msg.m_Utxo;
-		d.m_Maturity = msg.m_MaturityMin;
-		kMin = d;
-		d.m_Maturity = Height(-1);
-		kMax = d;
+	proto::ProofUtxoBatch msgOut;
 
-		t.m_pBound[0] = kMin.V.m_pData;
-		t.m_pBound[1] = kMax.V.m_pData;
+	Processor& p = m_This.m_Processor;
+	if (!p.IsFastSync())
+	{
+		msgOut.m_Proofs.resize(msg.m_Utxos.size());
 
-		p.get_Utxos().Traverse(t);
+		for (size_t i = 0; i < msg.m_Utxos.size(); i++)
+			p.GenerateProofsUtxo(msgOut.m_Proofs[i], msg.m_Utxos[i], 0, &msgOut.m_Common);
 	}
 
-	Send(t.m_Msg);
+	Send(msgOut);
 }
 
 void Node::Processor::GenerateProofShielded(Merkle::Proof& p, const uintBigFor<TxoID>::Type& mmrIdx)
@@ -3802,16 +4587,7 @@ void Node::Processor::GenerateProofShielded(Merkle::Proof& p, const uintBigFor<T
 	mmrIdx.Export(nIdx);
 
 	m_Mmr.m_Shielded.get_Proof(p, nIdx);
-
-	struct MyProofBuilder
-		:public NodeProcessor::ProofBuilder
-	{
-		using ProofBuilder::ProofBuilder;
-		bool get_Shielded(Merkle::Hash&) override { return false; }
-	};
-
-	MyProofBuilder pb(*this, p);
-	pb.GenerateProof();
+	AppendProofTail(p, ProofTails::Elem::Shielded);
 }
 
 void Node::Peer::OnMsg(proto::GetProofShieldedOutp&& msg)
@@ -3889,16 +4665,7 @@ void Node::Peer::OnMsg(proto::GetProofAsset&& msg)
 				msgOut.m_Info.SetCid(nullptr);
 
 			p.m_Mmr.m_Assets.get_Proof(msgOut.m_Proof, msgOut.m_Info.m_ID - (Rules::get().CA.ForeignEnd + 1));
-
-			struct MyProofBuilder
-				:public NodeProcessor::ProofBuilder
-			{
-				using ProofBuilder::ProofBuilder;
-				bool get_Assets(Merkle::Hash&) override { return false; }
-			};
-
-			MyProofBuilder pb(p, msgOut.m_Proof);
-			pb.GenerateProof();
+			p.AppendProofTail(msgOut.m_Proof, NodeProcessor::ProofTails::Elem::Assets);
 		}
 	}
 
@@ -3920,8 +4687,8 @@ void Node::Peer::OnMsg(proto::GetShieldedList&& msg)
 			msg.m_Count = static_cast<uint32_t>(n);
 
 		msgOut.m_Items.resize(msg.m_Count);
-		p.get_DB().ShieldedRead(msg.m_Id0, &msgOut.m_Items.front(), msg.m_Count);
-		p.get_DB().ShieldedStateRead(msg.m_Id0 + msg.m_Count - 1, &msgOut.m_State1, 1);
+		p.ShieldedRead(msg.m_Id0, &msgOut.m_Items.front(), msg.m_Count);
+		p.ShieldedStateRead(msg.m_Id0 + msg.m_Count - 1, msgOut.m_State1);
 	}
 
 	Send(msgOut);
@@ -4437,6 +5204,68 @@ void Node::Peer::OnMsg(proto::ContractVarsEnum&& msg)
 	Send(wrk.m_Out);
 }
 
+void Node::Peer::OnMsg(proto::ContractVarsEnumAt&& msg)
+{
+	Processor& p = m_This.m_Processor;
+	if (msg.m_Height >= p.m_Cursor.m_hh.m_Height)
+	{
+		proto::ContractVarsEnum msg2;
+		msg2.m_KeyMin = std::move(msg.m_KeyMin);
+		msg2.m_KeyMax = std::move(msg.m_KeyMax);
+		msg2.m_bSkipMin = msg.m_bSkipMin;
+
+		OnMsg(std::move(msg2));
+		return;
+	}
+
+	if (!p.IsContractHistory(msg.m_Height))
+	{
+		Send(proto::DataMissing());
+		return;
+	}
+
+	struct Walker
+		:public NodeProcessor::IContractVarsWalker
+	{
+		Peer& m_This;
+		proto::ContractVarsEnumAt& m_In;
+		proto::ContractVars m_Out;
+		Serializer m_Ser;
+
+		Walker(Peer& x, proto::ContractVarsEnumAt& msgIn)
+			:m_This(x)
+			,m_In(msgIn)
+		{}
+
+		bool OnVar(const Blob& key, const Blob& val) override
+		{
+			if (m_In.m_bSkipMin && (key == Blob(m_In.m_KeyMin)))
+				return true; // skip
+
+			m_Ser
+				& key.n
+				& val.n;
+
+			m_Ser.WriteRaw(key.p, key.n);
+			m_Ser.WriteRaw(val.p, val.n);
+
+			if (m_This.IsChocking(m_Ser.buffer().second))
+			{
+				m_Out.m_bMore = true;
+				return false;
+			}
+
+			return true;
+		}
+	};
+
+	Walker wlk(*this, msg);
+	p.EnumContractVarsAt(wlk, msg.m_KeyMin, msg.m_KeyMax, msg.m_Height);
+
+	wlk.m_Ser.swap_buf(wlk.m_Out.m_Result);
+	Send(wlk.m_Out);
+}
+
 void Node::Peer::OnMsg(proto::ContractLogsEnum&& msg)
 {
 	struct Wrk
@@ -4529,16 +5358,7 @@ void Node::Peer::OnMsg(proto::GetContractVar&& msg)
 				NodeProcessor::OnCorrupted();
 
 			t.get_Proof(msgOut.m_Proof, cu);
-
-			struct MyProofBuilder
-				:public NodeProcessor::ProofBuilder
-			{
-				using ProofBuilder::ProofBuilder;
-				bool get_Contracts(Merkle::Hash&) override { return false; }
-			};
-
-			MyProofBuilder pb(p, msgOut.m_Proof);
-			pb.GenerateProof();
+			m_This.m_Processor.AppendProofTail(msgOut.m_Proof, NodeProcessor::ProofTails::Elem::Contracts);
 		}
 	}
 
@@ -4598,7 +5418,7 @@ void Node::Server::OnAccepted(io::TcpStream::Ptr&& newStream, int errorCode)
 	{
 		BEAM_LOG_DEBUG() << "New peer connected: " << newStream->address();
 		Peer* p = get_ParentObj().AllocPeer(newStream->peer_address());
-		p->Accept(std::move(newStream));
+		p->Accept(get_ParentObj().m_IoShards, std::move(newStream));
 		p->m_Flags |= Peer::Flags::Accepted;
 		p->SecureConnect();
 	}
@@ -5369,19 +6189,101 @@ void Node::PeerMan::PeerInfoPlus::DetachStrict()
 	m_Live.m_p = nullptr;
 }
 
-bool Node::GenerateRecoveryInfo(const char* szPath)
+// shielded in/outs (starting from nMin), assets and the rest. Common for full and delta recovery
+template <typename TSer>
+void RecoveryWriteTail(TSer& ser, NodeProcessor& p, Block::Number nMin)
 {
-	if (!m_Processor.BuildCwp())
-		return false; // no info yet
+	const Rules& r = Rules::get();
+
+	// shielded in/outs
+	struct MyKrnWalker
+		:public NodeProcessor::KrnWalkerShielded
+	{
+		TSer& m_Ser;
+		MyKrnWalker(TSer& ser) :m_Ser(ser) {}
+
+		bool OnKrnEx(const TxKernelShieldedInput& krn) override
+		{
+			uint8_t nFlags = 0;
+
+			m_Ser & m_Height;
+			m_Ser & nFlags;
+			m_Ser & krn.m_SpendProof.m_SpendPk;
+			return true;
+		}
+
+		bool OnKrnEx(const TxKernelShieldedOutput& krn) override
+		{
+			Asset::Proof::Ptr pAsset;
+
+			uint8_t nFlags = RecoveryInfo::Flags::Output;
+			if (krn.m_Txo.m_pAsset)
+			{
+				pAsset.swap(Cast::NotConst(krn).m_Txo.m_pAsset);
+				nFlags |= RecoveryInfo::Flags::HadAsset;
+			}
+
+			m_Ser & m_Height;
+			m_Ser & nFlags;
+			m_Ser & krn.m_Txo;
+			m_Ser & krn.get_Msg();
+
+			if (pAsset && Rules::get().IsPastFork_<3>(m_Height))
+				m_Ser & pAsset->m_hGen;
+
+			return true;
+		}
+
+	} wlk(ser);
+
+	Block::NumberRange nr;
+	nr.m_Min = nMin;
+	nr.m_Max = p.m_Cursor.m_Full.m_Number;
+
+	p.EnumKernels(wlk, nr);
+
+	ser & MaxHeight; // terminator
+
+	// assets
+	Asset::Full ai;
+	ai.m_ID = 0;
+
+	while (p.get_DB().AssetGetNext(ai))
+	{
+		if (!r.IsPastFork_<6>(p.m_Cursor.m_hh.m_Height))
+			ai.SetCid(nullptr);
+
+		ser & ai;
+	}
+
+	ser & (Asset::s_MaxCount + 1); // terminator
 
-	typedef yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> MySerializer;
+	if (r.IsPastFork_<3>(p.m_Cursor.m_hh.m_Height))
+	{
+		p.EnsureCursorKernels();
+
+		Merkle::Hash hv;
+		NodeProcessor::Evaluator ev(p);
+
+		BEAM_VERIFY(ev.get_Contracts(hv));
+		ser & hv;
 
+		BEAM_VERIFY(ev.get_KL(hv));
+		ser & hv;
+	}
+}
+
+template <typename TSer>
+void RecoveryWriteFull(TSer& ser, NodeProcessor& p)
+{
 	struct MyTraveler
 		:public RadixTree::ITraveler
 	{
-		RecoveryInfo::Writer m_Writer;
+		TSer& m_Ser;
 		NodeDB* m_pDB;
 
+		MyTraveler(TSer& ser) :m_Ser(ser) {}
+
 		bool OnLeaf(const RadixTree::Leaf& x) override
 		{
 			const UtxoTree::MyLeaf& n = Cast::Up<UtxoTree::MyLeaf>(x);
@@ -5420,106 +6322,143 @@ bool Node::GenerateRecoveryInfo(const char* szPath)
 
 			Height hCreateHeight = d.m_Maturity - outp.get_MinMaturity(0);
 
-			MySerializer ser(m_Writer.m_Stream);
-			ser & hCreateHeight;
-
-			yas::detail::saveRecovery(ser, outp, hCreateHeight);
+			m_Ser & hCreateHeight;
+			yas::detail::saveRecovery(m_Ser, outp, hCreateHeight);
 		}
 	};
 
-	MyTraveler ctx;
-	ctx.m_pDB = &m_Processor.get_DB();
+	MyTraveler ctx(ser);
+	ctx.m_pDB = &p.get_DB();
+
+	p.get_Utxos().Traverse(ctx);
+
+	const Rules& r = Rules::get();
+
+	if (r.IsPastFork_<2>(p.m_Cursor.m_hh.m_Height))
+	{
+		ser & MaxHeight; // terminator
+		RecoveryWriteTail(ser, p, p.FindAtivePastHeight(r.pForks[2].m_Height));
+	}
+}
+
+bool Node::GenerateRecoveryInfo(const char* szPath)
+{
+	if (!m_Processor.BuildCwp())
+		return false; // no info yet
 
 	try
 	{
-		ctx.m_Writer.Open(szPath, m_Processor.m_Cwp, m_Processor.m_Cursor.m_hh.m_Height);
-		m_Processor.get_Utxos().Traverse(ctx);
+		RecoveryInfo::Writer w;
+		w.Open(szPath, m_Processor.m_Cwp, m_Processor.m_Cursor.m_hh.m_Height);
 
-		const Rules& r = Rules::get();
+		yas::binary_oarchive<std::FStream, SERIALIZE_OPTIONS> ser(w.m_Stream);
+		RecoveryWriteFull(ser, m_Processor);
+	}
+	catch (const std::exception& ex)
+	{
+		BEAM_LOG_ERROR() << ex.what();
+		return false;
+	}
 
-		if (r.IsPastFork_<2>(m_Processor.m_Cursor.m_hh.m_Height))
-		{
-			MySerializer ser(ctx.m_Writer.m_Stream);
-			ser & MaxHeight; // terminator
+	return true;
+}
 
-			// shielded in/outs
-			struct MyKrnWalker
-				:public NodeProcessor::KrnWalkerShielded
-			{
-				MySerializer& m_Ser;
-				MyKrnWalker(MySerializer& ser) :m_Ser(ser) {}
+bool Node::GenerateRecoveryInfo(ByteBuffer& buf)
+{
+	if (!m_Processor.BuildCwp())
+		return false; // no info yet
 
-				bool OnKrnEx(const TxKernelShieldedInput& krn) override
-				{
-					uint8_t nFlags = 0;
+	try
+	{
+		Serializer ser;
+		RecoveryInfo::Writer::WriteHeader(ser, m_Processor.m_Cwp, m_Processor.m_Cursor.m_hh.m_Height);
+		RecoveryWriteFull(ser, m_Processor);
 
-					m_Ser & m_Height;
-					m_Ser & nFlags;
-					m_Ser & krn.m_SpendProof.m_SpendPk;
-					return true;
-				}
+		ser.swap_buf(buf);
+	}
+	catch (const std::exception& ex)
+	{
+		BEAM_LOG_ERROR() << ex.what();
+		return false;
+	}
 
-				bool OnKrnEx(const TxKernelShieldedOutput& krn) override
-				{
-					Asset::Proof::Ptr pAsset;
+	return true;
+}
 
-					uint8_t nFlags = RecoveryInfo::Flags::Output;
-					if (krn.m_Txo.m_pAsset)
-					{
-						pAsset.swap(Cast::NotConst(krn).m_Txo.m_pAsset);
-						nFlags |= RecoveryInfo::Flags::HadAsset;
-					}
+bool Node::GenerateRecoveryDelta(ByteBuffer& buf, Height hPrev)
+{
+	if (!m_Processor.BuildCwp())
+		return false; // no info yet
 
-					m_Ser & m_Height;
-					m_Ser & nFlags;
-					m_Ser & krn.m_Txo;
-					m_Ser & krn.get_Msg();
+	struct MyWalker
+		:public NodeProcessor::ITxoWalker_Unspent
+	{
+		Serializer* m_pSer;
 
-					if (pAsset && Rules::get().IsPastFork_<3>(m_Height))
-						m_Ser & pAsset->m_hGen;
+		bool OnTxo(const NodeDB::WalkerTxo&, Height hCreate, Output& outp) override
+		{
+			*m_pSer & hCreate;
+			yas::detail::saveRecovery(*m_pSer, outp, hCreate);
+			return true;
+		}
+	};
 
-					return true;
-				}
+	try
+	{
+		Serializer ser;
+		RecoveryInfo::Writer::WriteDeltaHeader(ser, m_Processor.m_Cwp, m_Processor.m_Cursor.m_hh.m_Height, hPrev);
 
-			} wlk(ser);
+		Block::NumberRange nr;
+		nr.m_Min.v = m_Processor.FindAtivePastHeight(hPrev).v + 1;
+		nr.m_Max = m_Processor.m_Cursor.m_Full.m_Number;
 
-			Block::NumberRange nr;
-			nr.m_Min = m_Processor.FindAtivePastHeight(r.pForks[2].m_Height);
-			nr.m_Max = m_Processor.m_Cursor.m_Full.m_Number;
+		// created in range and still unspent
+		MyWalker wlk;
+		wlk.m_pSer = &ser;
+		m_Processor.EnumTxos(wlk, nr);
 
-			m_Processor.EnumKernels(wlk, nr);
+		ser & MaxHeight; // terminator
 
-			ser & MaxHeight; // terminator
+		// spent in range, created before it
+		TxoID id0 = m_Processor.get_TxosBefore(nr.m_Min);
+		std::vector<NodeDB::StateInput> vIns;
 
-			// assets
-			Asset::Full ai;
-			ai.m_ID = 0;
+		for (Block::Number n = nr.m_Min; n.v <= nr.m_Max.v; n.v++)
+		{
+			m_Processor.get_DB().get_StateInputs(m_Processor.FindActiveAtStrict(n), vIns);
+			Height h = m_Processor.Num2Height(n);
 
-			while (m_Processor.get_DB().AssetGetNext(ai))
+			for (const auto& inp : vIns)
 			{
-				if (!r.IsPastFork_<6>(m_Processor.m_Cursor.m_hh.m_Height))
-					ai.SetCid(nullptr);
+				if (inp.get_ID() >= id0)
+					continue;
 
-				ser & ai;
-			}
+				UtxoTree::Key::Data d;
+				inp.Get(d.m_Commitment);
+				d.m_Maturity = m_Processor.GetInputMaturity(inp.get_ID()); // needed to locate the spent UTXO
 
-			ser & (Asset::s_MaxCount + 1); // terminator
+				ser & h;
+				ser & d.m_Commitment;
+				ser & d.m_Maturity;
+			}
+		}
 
-			if (r.IsPastFork_<3>(m_Processor.m_Cursor.m_hh.m_Height))
-			{
-				m_Processor.EnsureCursorKernels();
+		ser & MaxHeight; // terminator
 
-				Merkle::Hash hv;
-				NodeProcessor::Evaluator ev(m_Processor);
+		Merkle::Hash hv;
+		NodeProcessor::Evaluator ev(m_Processor);
+		BEAM_VERIFY(ev.get_Utxos(hv));
+		ser & hv;
 
-				BEAM_VERIFY(ev.get_Contracts(hv));
-				ser & hv;
+		const Rules& r = Rules::get();
 
-				BEAM_VERIFY(ev.get_KL(hv));
-				ser & hv;
-			}
+		if (r.IsPastFork_<2>(m_Processor.m_Cursor.m_hh.m_Height))
+		{
+			Block::Number nMin = m_Processor.FindAtivePastHeight(r.pForks[2].m_Height);
+			RecoveryWriteTail(ser, m_Processor, std::max(nMin, nr.m_Min));
 		}
 
+		ser.swap_buf(buf);
 	}
 	catch (const std::exception& ex)
 	{
@@ -5831,6 +6770,7 @@ void Node::Validator::OnRolledBack()
 {
 	m_hAnchor = MaxHeight;
 	m_iRound = 0;
+	m_Speculative.m_Valid = false;
 	KillTimer();
 	// wait till the next state
 }
@@ -5935,6 +6875,13 @@ void Node::Validator::OnNewRound()
 	SetTimer(tNow_ms, rt.m_t1);
 
 	m_iRound = rt.m_iRound;
+	m_Latency.Reset(tNow_ms);
+
+	if (m_Speculative.m_Valid && (m_Speculative.m_iRound != m_iRound))
+	{
+		PBFT_LOG(DEBUG, "speculative proposal discarded");
+		m_Speculative.m_Valid = false;
+	}
 
 	PBFT_LOG(INFO, "round start dt=" << (rt.m_t1 - rt.m_t0));
 
@@ -5984,6 +6931,7 @@ void Node::Validator::OnNewStateInternal()
 	m_hAnchor = p.m_Cursor.m_hh.m_Height;
 
 	m_FutureCandidate.m_State = Proposal::State::None;
+	m_Speculative.m_Valid = false;
 	m_State = State::None;
 
 	m_wTotal = 0;
@@ -6442,18 +7390,31 @@ void Node::Validator::GenerateProposal()
 	}
 	else
 	{
-		// theoretically can generate it before receiving enough NotCommitted msgs, but no reason to do it
-		if (!ShouldAcceptProposal())
+		if (!m_Speculative.m_Valid)
 		{
-			PBFT_LOG(DEBUG, "not ready to propose");
-			return;
+			// assemble it now, even if not ready to propose yet. This hides the block assembly time behind the vote collection
+			if (!CreateProposal(m_Speculative.m_Proposal))
+			{
+				PBFT_LOG(WARNING, "Block generation failed, can't make a proposal!");
+				return;
+			}
+
+			m_Speculative.m_iRound = m_iRound;
+			m_Speculative.m_Valid = true;
 		}
 
-		if (!CreateProposal())
+		assert(m_Speculative.m_iRound == m_iRound);
+
+		if (!ShouldAcceptProposal())
 		{
-			PBFT_LOG(WARNING, "Block generation failed, can't make a proposal!");
+			PBFT_LOG(DEBUG, "not ready to propose, block assembled");
 			return;
 		}
+
+		rd.m_Proposal = std::move(m_Speculative.m_Proposal);
+		m_Speculative.m_Valid = false;
+
+		rd.SetHashes();
 	}
 
 	rd.m_Proposal.m_State = Proposal::State::Received;
@@ -6978,6 +7939,9 @@ void Node::Validator::OnProposalReceived(uint32_t iR, const Peer* pSrc)
 	assert(Proposal::State::Received == rd.m_Proposal.m_State);
 
 	PBFT_LOG(INFO, "proposal received " << rd.m_Proposal.m_hv << ", iR=" << iR);
+
+	if (!iR && !m_Latency.m_tProposal_ms)
+		m_Latency.m_tProposal_ms = get_RefTime_ms();
 	Broadcast(rd.m_Proposal.m_Msg, pSrc);
 }
 
@@ -7067,6 +8031,14 @@ void Node::Validator::CheckState(uint32_t iR)
 
 	PBFT_LOG(INFO, "quorum reached " << id.m_Hash);
 
+	if (!iR)
+	{
+		uint64_t t0 = m_Latency.m_tStart_ms;
+		PBFT_LOG(INFO, "round latency: proposal=" << RoundLatency::get_Delta(t0, m_Latency.m_tProposal_ms)
+			<< " ms, committed=" << RoundLatency::get_Delta(t0, m_Latency.m_tCommitted_ms)
+			<< " ms, quorum=" << RoundLatency::get_Delta(t0, get_RefTime_ms()) << " ms");
+	}
+
 	const Rules& r = Rules::get();
 
 	if (r.m_Pbft.m_Whitelist.m_NumRequired)
@@ -7167,6 +8139,7 @@ void Node::Validator::CheckStateCurrent()
 
 		PBFT_LOG(INFO, "committed");
 		m_State = State::Committed;
+		m_Latency.m_tCommitted_ms = get_RefTime_ms();
 		m_pMe->m_hvCommitted = rd.m_Proposal.m_hv;
 	}
 
@@ -7348,7 +8321,7 @@ void Node::Validator::CreateProposalMd(NodeProcessor::BlockContext& bc)
 	}
 }
 
-bool Node::Validator::CreateProposal()
+bool Node::Validator::CreateProposal(Proposal& trg)
 {
 	// In PBFT mode miner/owner keys are not used, since the block contains neither subsidy nor UTXO collecting fees
 	auto& kdfDummy = *get_ParentObj().m_Keys.m_pGeneric;
@@ -7373,11 +8346,9 @@ bool Node::Validator::CreateProposal()
 
 	if (bRes)
 	{
-		auto& rdcurr = m_pR[0];
-		bc.m_Hdr.get_Hash(rdcurr.m_Proposal.m_hv);
-		rdcurr.m_Proposal.m_Msg.m_Hdr = std::move(bc.m_Hdr);
-		rdcurr.m_Proposal.m_Msg.m_Body = std::move(bc.m_Body);
-		rdcurr.SetHashes();
+		bc.m_Hdr.get_Hash(trg.m_hv);
+		trg.m_Msg.m_Hdr = std::move(bc.m_Hdr);
+		trg.m_Msg.m_Body = std::move(bc.m_Body);
 	}
 
 	return bRes;
@@ -17,6 +17,7 @@
 #include "processor.h"
 #include "utility/io/timer.h"
 #include "core/proto.h"
+#include "core/io_shards.h"
 #include "core/block_crypt.h"
 #include "core/shielded.h"
 #include "core/peer_manager.h"
@@ -72,7 +73,8 @@ struct Node
 			uint32_t m_PeersDbFlush_ms = 1000 * 60; // 1 minute
 		} m_Timeout;
 
-		uint32_t m_MaxConcurrentBlocksRequest = 18;
+		uint32_t m_MaxConcurrentBodyPacks = 4; // body packs requested in parallel (from different peers), ahead of the first missing blocks
+		uint32_t m_MaxConcurrentHdrPacks = 4; // hdr packs requested in parallel (from different peers)
 		uint32_t m_MaxPoolTransactions = 100 * 1000;
 		uint32_t m_MaxDeferredTransactions = 100 * 1000;
 		uint32_t m_MiningThreads = 0; // by default disabled
@@ -83,12 +85,16 @@ struct Node
 		bool m_LogTraficUsage = false;
 
 		bool m_PreferOnlineMining = true;
+		bool m_CompactBlocks = true; // request new blocks in compact form, outputs are restored from the tx pool
 
 		// Number of verification threads for CPU-hungry cryptography. Currently used for block validation only.
 		// 0: single threaded
 		// negative: number of cores minus number of mining threads.
 		int m_VerificationThreads = 0;
 
+		// Number of I/O threads serving the inbound connections (socket I/O, decryption, framing). 0: everything in the node thread
+		uint32_t m_IoThreads = 0;
+
 		struct RollbackLimit
 		{
 			uint32_t m_Max = 60; // artificial restriction on how much the node will rollback automatically
@@ -126,12 +132,16 @@ struct Node
 			size_t m_MaxBodyPackSize = 1024 * 1024 * 5;
 			uint32_t m_MaxBodyPackCount = 3000;
 
+			uint32_t m_BodyPackTime_ms = 1000 * 4; // requested body packs are sized w.r.t. the measured peer throughput, to be received within this time
+			uint32_t m_StragglerFactor = 3; // the first missing pack is re-requested from another peer if it's late by this factor
+
 		} m_BandwidthCtl;
 
 		struct TestMode {
 			// for testing only!
 			uint32_t m_FakePowSolveTime_ms = 0;
 			uint32_t m_TimeDrift_ms = 0;
+			uint32_t m_FakeBodyPackDelay_ms = 0; // body packs are served with this delay
 
 		} m_TestMode;
 
@@ -156,6 +166,7 @@ struct Node
 		{
 			std::string m_sPathOutput; // directory with (back)slash and optionally a common prefix
 			uint32_t m_Granularity = 30; // block interval for newer recovery generation
+			uint32_t m_Deltas = 0; // max num of delta files (changes since the previous file) between the full ones. 0 - full only
 
 		} m_Recovery;
 
@@ -214,6 +225,10 @@ struct Node
 		uint64_t m_Done;
 		uint64_t m_Total;
 
+		uint32_t m_HdrsPerSec; // headers download rate, 0 if no headers are being synced
+		uint32_t m_BlocksPerSec; // blocks download rate, 0 if no blocks are being synced
+		uint32_t m_BytesPerSec; // blocks download throughput
+
 		bool operator == (const SyncStatus&) const;
 
 		void ToRelative(uint64_t hDone0);
@@ -226,14 +241,30 @@ struct Node
 	bool m_UpdatedFromPeers = false;
 	bool m_PostStartSynced = false;
 
+	// diagnostics
+	uint32_t m_nBodyRerequests = 0; // late body ranges re-requested from another peer
+	uint32_t m_nBodyDuplicates = 0; // blocks received more than once, skipped
+	uint32_t m_nCompactBodies = 0; // new blocks restored from the compact bodies
+
+	struct BodyPropagation
+	{
+		// time from the request to the fully restored body (or the whole pack)
+		uint32_t m_Last_ms = 0;
+		uint64_t m_Total_ms = 0;
+		uint32_t m_Count = 0;
+
+		uint32_t OnReceived(uint32_t tRequested_ms);
+	} m_BodyPropagation;
+
 	bool GenerateRecoveryInfo(const char*);
+	bool GenerateRecoveryInfo(ByteBuffer&); // in-memory
+	bool GenerateRecoveryDelta(ByteBuffer&, Height hPrev); // in-memory, changes since the prev recovery at hPrev
 	void PrintTxos();
 	void PrintRollbackStats();
 
 	void RefreshCongestions(); // call explicitly if manual rollback or forbidden state is modified
 
-	bool DecodeAndCheckHdrs(std::vector<Block::SystemState::Full>&, const proto::HdrPack&);
-	static bool DecodeAndCheckHdrsImpl(std::vector<Block::SystemState::Full>&, const proto::HdrPack&, ExecutorMT&);
+	bool InsertHdrsPipelined(const std::vector<Block::SystemState::Full>&, const PeerID&); // verifies PoW and inserts the states
 
 	uint8_t OnTransaction(Transaction::Ptr&&, std::unique_ptr<Merkle::Hash>&&, const PeerID*, bool bFluff, std::ostream* pExtraInfo);
 
@@ -283,6 +314,8 @@ private:
 
 		void GenerateProofStateStrict(Merkle::HardProof&, Block::Number);
 		void GenerateProofShielded(Merkle::Proof&, const uintBigFor<TxoID>::Type& mmrIdx);
+		void GenerateProofsUtxo(std::vector<Input::Proof>&, const ECC::Point&, Height hMaturityMin, Merkle::Proof* pCommon);
+		void AppendProofTail(Merkle::Proof&, ProofTails::Elem);
 
 		bool m_bFlushPending = false;
 		io::Timer::Ptr m_pFlushTimer;
@@ -318,6 +351,8 @@ private:
 		Block::Number m_n0; // those 2 are fast-sync params at the moment of task assignment
 		Block::Number m_nTxoLo;
 		Peer* m_pOwner;
+		bool m_bCompact; // requested in compact form
+		bool m_bNoCompact; // compact body couldn't be restored, request the full one
 
 		bool operator < (const Task& t) const { return (m_Key < t.m_Key); }
 	};
@@ -327,6 +362,43 @@ private:
 
 	uint32_t m_nTasksPackHdr = 0;
 	uint32_t m_nTasksPackBody = 0;
+	uint32_t m_nTasksBody = 0; // assigned body requests (packs)
+
+	SyncStatus m_SyncStatusReported; // to the observer
+
+	struct HdrsVerifyTask;
+
+	struct HdrRate
+	{
+		uint32_t m_t0_ms = 0;
+		uint32_t m_Count = 0;
+
+		void OnHdrs(SyncStatus&, uint32_t nCount);
+		void Reset(SyncStatus&);
+	} m_HdrRate;
+
+	struct BodyRate
+	{
+		uint32_t m_t0_ms = 0;
+		uint32_t m_Count = 0;
+		uint64_t m_Size = 0;
+		uint32_t m_SizePerBlock = 0; // moving average, 0 if unknown yet
+
+		void OnBodies(SyncStatus&, uint32_t nCount, uint64_t nSize);
+		void Reset(SyncStatus&);
+	} m_BodyRate;
+
+	// Body packs scheduling. Each peer downloads a single pack at a time, sized w.r.t. its throughput.
+	// Subsequent ranges are requested from other peers in parallel, the late first missing range is re-requested from another peer.
+	io::Timer::Ptr m_pTimerBodies;
+	bool m_bTimerBodies = false;
+
+	void PlanBodyPacks();
+	void CheckBodyStragglers();
+	void OnTimerBodies();
+	uint32_t get_BodyPackCount(const Peer&) const;
+	void TrimBodyPack(proto::GetBodyPack&, const Task&, uint32_t nMax);
+	Task* CreateBodyTask(const Block::SystemState::ID&, const NodeDB::StateID& sidTrg);
 
 	TaskList m_lstTasksUnassigned;
 	TaskSet m_setTasks;
@@ -336,6 +408,7 @@ private:
 
 	void TryAssignTask(Task&);
 	bool TryAssignTask(Task&, Peer&);
+	bool RestoreCompactBody(ByteBuffer& bufP);
 	void DeleteUnassignedTask(Task&);
 
 	void InitKeys();
@@ -343,6 +416,24 @@ private:
 	void RefreshAccounts();
 	struct AccountRefreshCtx;
 	void MaybeGenerateRecovery();
+	void OnRecoveryWritten();
+
+	struct RecoveryWriter
+	{
+		// recovery files are serialized in memory, and written asynchronously
+		std::thread m_Thread;
+		io::AsyncEvent::Ptr m_pEvt;
+		ByteBuffer m_Buf;
+		std::string m_sPath;
+		Height m_Height = 0;
+		bool m_Full = false; // or delta
+		bool m_Ok = false; // set by the thread
+		bool m_Orphaned = false; // rolled back meanwhile
+
+		bool IsBusy() const { return m_Thread.joinable(); }
+		void Write();
+
+	} m_RecoveryWriter;
 
 	struct Wanted
 	{
@@ -578,6 +669,23 @@ private:
 		io::Timer::Ptr m_pTimerRequest;
 		io::Timer::Ptr m_pTimerPeers;
 
+		struct DataRate
+		{
+			uint32_t m_Bps = 0; // measured body download throughput, 0 if unknown yet
+			uint32_t m_Rtt_ms = 0; // measured request latency
+			uint32_t m_tLast_ms = 0; // last response
+
+			void OnResponse(uint32_t dt_ms, size_t nSize, bool bBulk);
+			uint32_t get_Expected_ms(uint64_t nSize, uint32_t nBps) const;
+		} m_DataRate;
+
+		uint32_t get_BodyBps() const; // measured, or estimated from the rating
+
+		std::deque<proto::GetBodyPack> m_lstDelayedBodyPacks; // test mode only
+		io::Timer::Ptr m_pTimerDelayedBodyPack;
+		void SetTimerDelayedBodyPack();
+		void OnTimerDelayedBodyPack();
+
 		Peer(Node& n) :m_This(n) {}
 
 		void TakeTasks();
@@ -598,6 +706,7 @@ private:
 		void OnChocking();
 		void SetTxCursor(TxPool::Fluff::Element::Send*);
 		bool GetBlock(proto::BodyBuffers&, const NodeDB::StateID&, const proto::GetBodyPack&, bool bActive);
+		void SendBodyPack(const proto::GetBodyPack&);
 
 		bool IsChocking(size_t nExtra = 0);
 		bool ShouldAssignTasks();
@@ -657,6 +766,7 @@ private:
 		void OnMsg(proto::GetProofKernel2&&) override;
 		void OnMsg(proto::GetProofKernel3&&) override;
 		void OnMsg(proto::GetProofUtxo&&) override;
+		void OnMsg(proto::GetProofUtxoBatch&&) override;
 		void OnMsg(proto::GetProofShieldedOutp&&) override;
 		void OnMsg(proto::GetProofShieldedInp&&) override;
 		void OnMsg(proto::GetProofAsset&&) override;
@@ -674,6 +784,7 @@ private:
 		void OnMsg(proto::BlockFinalization&&) override;
 		void OnMsg(proto::GetStateSummary&&) override;
 		void OnMsg(proto::ContractVarsEnum&&) override;
+		void OnMsg(proto::ContractVarsEnumAt&&) override;
 		void OnMsg(proto::ContractLogsEnum&&) override;
 		void OnMsg(proto::GetContractVar&&) override;
 		void OnMsg(proto::GetContractLogProof&&) override;
@@ -713,6 +824,8 @@ private:
 		IMPLEMENT_GET_PARENT_OBJ(Node, m_Server)
 	} m_Server;
 
+	proto::IoShards m_IoShards;
+
 	struct Beacon
 	{
 		struct OutCtx;
@@ -983,6 +1096,25 @@ private:
 
 		Proposal m_FutureCandidate;
 
+		// Proposal assembled by the leader ahead of time, while still waiting for the not-committed votes.
+		// Valid only for the round (and tip) it was built for, discarded on round/state change.
+		struct Speculative
+		{
+			Proposal m_Proposal;
+			uint64_t m_iRound = 0;
+			bool m_Valid = false;
+		} m_Speculative;
+
+		struct RoundLatency
+		{
+			uint64_t m_tStart_ms = 0;
+			uint64_t m_tProposal_ms = 0;
+			uint64_t m_tCommitted_ms = 0;
+
+			void Reset(uint64_t tNow_ms) { *this = RoundLatency(); m_tStart_ms = tNow_ms; }
+			static uint64_t get_Delta(uint64_t t0_ms, uint64_t t1_ms) { return t1_ms ? (t1_ms - t0_ms) : 0; }
+		} m_Latency;
+
 		Height m_hAnchor;
 		uint64_t m_iRound;
 		uint64_t m_wTotal;
@@ -1005,7 +1137,7 @@ private:
 		void CheckState(uint32_t iR);
 		bool SelectMultisigValidators(Bitmask<Block::Pbft::s_MaxValidators>& msk);
 		bool ShouldAcceptProposal() const;
-		bool CreateProposal();
+		bool CreateProposal(Proposal&);
 		void CreateProposalMd(NodeProcessor::BlockContext&);
 		void Sign(ECC::Signature&, const Merkle::Hash&);
 		void MakeFullHdr(Block::SystemState::Full&, const Block::SystemState::Sequence::Element&) const;
@@ -171,6 +171,8 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 	m_Mmr.m_Shielded.m_Count += m_Extra.m_ShieldedOutputs;
 
 	InitializeMapped(szPath);
+	InitializeShieldedImage(szPath);
+	InitializeBodyArchive(szPath, sp.m_ArchiveSegment);
 	m_Extra.m_Txos = get_TxosBefore(Block::Number(m_Cursor.m_Full.m_Number.v + 1));
 
 	bool bRebuildNonStd = false;
@@ -200,6 +202,15 @@ void NodeProcessor::Initialize(const char* szPath, const StartParams& sp, ILongA
 		m_DB.ParamIntSet(NodeDB::ParamID::Flags1, nFlags1 & ~NodeDB::Flags1::PendingRebuildNonStd);
 	}
 
+	if (!m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+		m_DB.ParamDelSafe(NodeDB::ParamID::HeightContractHist);
+	else
+	{
+		// if unknown - assume the history is recorded from now on
+		if (MaxHeight == m_DB.ParamIntGetDef(NodeDB::ParamID::HeightContractHist, MaxHeight))
+			m_DB.ParamIntSet(NodeDB::ParamID::HeightContractHist, m_Cursor.m_hh.m_Height);
+	}
+
 	TestDefinitionStrict();
 
 	CommitDB();
@@ -316,6 +327,390 @@ void NodeProcessor::InitializeMapped(const char* sz)
 		m_Mapped.m_Contract.Toggle(wlk.m_Key, wlk.m_Val, true);
 }
 
+void NodeProcessor::ShieldedImage::Close()
+{
+	m_Points.Close();
+	m_States.Close();
+}
+
+void NodeProcessor::InitializeShieldedImage(const char* sz)
+{
+	const uint32_t nSigPoints = 0x53680001;
+	const uint32_t nSigStates = 0x53680002;
+
+	std::string sPath;
+	get_MappingPath(sPath, sz, "-shielded-outs.bin");
+	bool bValid = m_ShieldedImage.m_Points.Open(sPath.c_str(), nSigPoints, sizeof(ECC::Point::Storage));
+
+	get_MappingPath(sPath, sz, "-shielded-states.bin");
+	if (!m_ShieldedImage.m_States.Open(sPath.c_str(), nSigStates, sizeof(ECC::Hash::Value)))
+		bValid = false;
+
+	TxoID nTotal = m_Extra.m_ShieldedOutputs;
+	TxoID nValid = 0;
+
+	if (bValid)
+	{
+		nValid = std::min(m_ShieldedImage.m_Points.get_Count(), m_ShieldedImage.m_States.get_Count());
+		std::setmin(nValid, nTotal); // the image may be ahead of the DB if the last commit was lost
+
+		if (nValid)
+		{
+			// the state hash is cumulative, it's enough to compare the last one
+			ECC::Hash::Value hv;
+			m_DB.ShieldedStateRead(nValid - 1, &hv, 1);
+
+			if (hv != *m_ShieldedImage.m_States.get_As<ECC::Hash::Value>(nValid - 1))
+			{
+				BEAM_LOG_WARNING() << "Shielded image mismatch, rebuilding";
+				nValid = 0;
+			}
+		}
+	}
+
+	m_ShieldedImage.m_Points.Resize(nTotal);
+	m_ShieldedImage.m_States.Resize(nTotal);
+
+	if (nValid < nTotal)
+	{
+		BEAM_LOG_INFO() << "Shielded image: loading " << (nTotal - nValid) << " elements";
+
+		TxoID n = nTotal - nValid;
+		m_DB.ShieldedRead(nValid, m_ShieldedImage.m_Points.get_As<ECC::Point::Storage>(nValid), n);
+		m_DB.ShieldedStateRead(nValid, m_ShieldedImage.m_States.get_As<ECC::Hash::Value>(nValid), n);
+	}
+}
+
+void NodeProcessor::ShieldedAppend(const ECC::Point::Storage& pt, const ECC::Hash::Value& hv)
+{
+	TxoID n = m_Extra.m_ShieldedOutputs;
+
+	m_DB.ShieldedResize(n + 1, n);
+	m_DB.ShieldedWrite(n, &pt, 1);
+	m_DB.ShieldedStateResize(n + 1, n);
+	m_DB.ShieldedStateWrite(n, &hv, 1);
+
+	if (m_ShieldedImage.IsOpen())
+	{
+		assert(m_ShieldedImage.m_Points.get_Count() == n);
+
+		m_ShieldedImage.m_Points.Resize(n + 1);
+		*m_ShieldedImage.m_Points.get_As<ECC::Point::Storage>(n) = pt;
+		m_ShieldedImage.m_States.Resize(n + 1);
+		*m_ShieldedImage.m_States.get_As<ECC::Hash::Value>(n) = hv;
+	}
+}
+
+void NodeProcessor::ShieldedPop()
+{
+	TxoID n = m_Extra.m_ShieldedOutputs;
+	assert(n);
+
+	m_DB.ShieldedResize(n - 1, n);
+	m_DB.ShieldedStateResize(n - 1, n);
+
+	if (m_ShieldedImage.IsOpen())
+	{
+		m_ShieldedImage.m_Points.Resize(n - 1);
+		m_ShieldedImage.m_States.Resize(n - 1);
+	}
+
+	// the last batch is no more complete
+	auto& m = m_ShieldedPrepared.m_Map;
+	m.erase(m.lower_bound((n - 1) / ShieldedPrepared::Batch::s_Size), m.end());
+}
+
+void NodeProcessor::InitializeBodyArchive(const char* sz, uint64_t nSegmentMax)
+{
+	BodyArchive& ba = m_BodyArchive;
+	get_MappingPath(ba.m_sPrefix, sz, "-archive-");
+	ba.m_nSegmentMax = nSegmentMax;
+
+	std::vector<uint32_t> v;
+	m_DB.ArchiveEnumSegments(v);
+
+	// the newest segments may have no live entries, so the tail is tracked explicitly
+	ba.m_iTail = static_cast<uint32_t>(m_DB.ParamIntGetDef(NodeDB::ParamID::ArchiveTail));
+	if (!v.empty())
+		std::setmax(ba.m_iTail, v.back());
+
+	// segments appended after the last commit (if it was rolled back) are still on disk
+	for (std::string sPath; ; ba.m_iTail++)
+	{
+		ba.get_Path(sPath, ba.m_iTail + 1);
+
+		std::FStream fs;
+		if (!fs.Open(sPath.c_str(), true))
+			break;
+	}
+
+	// sealed segments, including those that have no live entries left
+	for (uint32_t i = 0; i < ba.m_iTail; i++)
+	{
+		std::string sPath;
+		ba.get_Path(sPath, i);
+
+		std::FStream fs;
+		if (fs.Open(sPath.c_str(), true))
+			ba.m_setSealed.insert(i);
+	}
+
+	m_DB.m_pArchive = &ba;
+}
+
+void NodeProcessor::BodyArchive::get_Path(std::string& sPath, uint32_t iSegment) const
+{
+	sPath = m_sPrefix + std::to_string(iSegment) + ".bin";
+}
+
+MappedLog& NodeProcessor::BodyArchive::get_Segment(uint32_t iSegment)
+{
+	const uint32_t nSig = 0x41726301;
+
+	MappedLog& seg = m_mapSegments[iSegment];
+	if (!seg.IsOpen())
+	{
+		std::string sPath;
+		get_Path(sPath, iSegment);
+		seg.Open(sPath.c_str(), nSig);
+	}
+
+	return seg;
+}
+
+void NodeProcessor::BodyArchive::Read(const NodeDB::ArchiveEntry& ae, ByteBuffer& buf)
+{
+	MappedLog& seg = get_Segment(ae.m_iSegment);
+	if (ae.m_Offset + ae.m_Size > seg.get_Size())
+	{
+		CorruptionException exc;
+		exc.m_sErr = "body archive";
+		throw exc;
+	}
+
+	const uint8_t* p = seg.get_At(ae.m_Offset, ae.m_Size);
+	buf.assign(p, p + ae.m_Size);
+}
+
+void NodeProcessor::BodyArchive::Append(NodeDB::ArchiveEntry& ae, const Blob& blob)
+{
+	MappedLog* pSeg = &get_Segment(m_iTail);
+	if (pSeg->get_Size() && (pSeg->get_Size() + blob.n > m_nSegmentMax))
+	{
+		pSeg->Flush();
+		m_setSealed.insert(m_iTail);
+		pSeg = &get_Segment(++m_iTail);
+	}
+
+	ae.m_iSegment = m_iTail;
+	ae.m_Size = blob.n;
+	ae.m_Offset = pSeg->Append(blob.p, blob.n);
+}
+
+void NodeProcessor::BodyArchive::Flush()
+{
+	for (auto& x : m_mapSegments)
+		if (x.second.IsOpen())
+			x.second.Flush();
+}
+
+void NodeProcessor::BodyArchive::DropCompacted()
+{
+	for (uint32_t iSegment : m_vDrop)
+	{
+		auto it = m_mapSegments.find(iSegment);
+		if (m_mapSegments.end() != it)
+		{
+			it->second.Close();
+			m_mapSegments.erase(it);
+		}
+
+		std::string sPath;
+		get_Path(sPath, iSegment);
+		DeleteFile(sPath.c_str());
+	}
+
+	m_vDrop.clear();
+}
+
+void NodeProcessor::BodyArchive::Close()
+{
+	for (auto& x : m_mapSegments)
+		x.second.Close();
+
+	m_mapSegments.clear();
+}
+
+Height NodeProcessor::ArchiveBodies()
+{
+	if (!m_BodyArchive.m_nSegmentMax)
+		return 0;
+
+	// incrementally, for the existing DB the backlog is moved in portions
+	const uint64_t nMaxBlocks = 0x400;
+
+	Block::Number num(m_DB.ParamIntGetDef(NodeDB::ParamID::NumberArchive, 1));
+	Block::Number numEnd(std::min(m_Extra.m_Fossil.v + 1, num.v + nMaxBlocks));
+	if (num.v >= numEnd.v)
+		return 0;
+
+	Height hRet = 0;
+	ByteBuffer bb;
+
+	for (; num.v < numEnd.v; num.v++)
+	{
+		uint64_t row = FindActiveAtStrict(num);
+
+		NodeDB::ArchiveEntry ae;
+		if (m_DB.ArchiveGet(row, ae))
+			continue;
+
+		bb.clear();
+		m_DB.GetStateBlock(row, nullptr, &bb, nullptr);
+		if (bb.empty())
+			continue;
+
+		m_BodyArchive.Append(ae, bb);
+		m_DB.ArchiveMove(row, ae);
+		hRet++;
+	}
+
+	m_DB.ParamIntSet(NodeDB::ParamID::NumberArchive, num.v);
+
+	CompactBodyArchive();
+
+	m_DB.ParamIntSet(NodeDB::ParamID::ArchiveTail, m_BodyArchive.m_iTail);
+
+	return hRet;
+}
+
+void NodeProcessor::CompactBodyArchive()
+{
+	// at most one sealed segment per call. Relocate its live entries to the tail if it's less than half-used
+	BodyArchive& ba = m_BodyArchive;
+
+	for (auto it = ba.m_setSealed.begin(); ba.m_setSealed.end() != it; it++)
+	{
+		uint32_t iSegment = *it;
+
+		uint64_t nLive = m_DB.ArchiveGetLive(iSegment);
+		if (nLive * 2 >= ba.get_Segment(iSegment).get_Size())
+			continue;
+
+		std::vector<std::pair<uint64_t, NodeDB::ArchiveEntry> > vEntries;
+
+		NodeDB::WalkerArchive wlk;
+		for (m_DB.ArchiveEnum(wlk, iSegment); wlk.MoveNext(); )
+			vEntries.emplace_back(wlk.m_Row, wlk.m_Entry);
+
+		ByteBuffer bb;
+		for (auto& x : vEntries)
+		{
+			ba.Read(x.second, bb);
+			ba.Append(x.second, bb);
+			m_DB.ArchiveSet(x.first, x.second);
+		}
+
+		BEAM_LOG_INFO() << "Body archive segment " << iSegment << " compacted, relocated " << vEntries.size();
+
+		ba.m_setSealed.erase(it);
+		ba.m_vDrop.push_back(iSegment); // after the commit
+		break;
+	}
+}
+
+void NodeProcessor::PrepareShieldedBatches(const Sigma::CmList::PreparedBatch** pp, uint64_t iBatch0, uint32_t nBatches)
+{
+	typedef ShieldedPrepared::Batch Batch;
+
+	struct MyTask
+		:public Executor::TaskSync
+	{
+		struct Entry
+		{
+			uint32_t m_iIdx;
+			Sigma::CmListVec m_Lst;
+			std::unique_ptr<Batch> m_pB;
+		};
+
+		std::vector<Entry> m_vec;
+
+		void Exec(Executor::Context& ctx) override
+		{
+			uint32_t i0, nCount;
+			ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_vec.size()));
+
+			for (; nCount--; i0++)
+			{
+				Entry& e = m_vec[i0];
+				e.m_Lst.Prepare(*e.m_pB, 0);
+			}
+		}
+	} t;
+
+	auto& m = m_ShieldedPrepared.m_Map;
+
+	for (uint32_t i = 0; i < nBatches; i++)
+	{
+		pp[i] = nullptr;
+
+		uint64_t iBatch = iBatch0 + i;
+		if ((iBatch + 1) * Batch::s_Size > m_Extra.m_ShieldedOutputs)
+			break; // incomplete
+
+		auto it = m.find(iBatch);
+		if (m.end() != it)
+			pp[i] = it->second.get();
+		else
+		{
+			auto& e = t.m_vec.emplace_back();
+			e.m_iIdx = i;
+			e.m_Lst.m_vec.resize(Batch::s_Size);
+			ShieldedRead(iBatch * Batch::s_Size, &e.m_Lst.m_vec.front(), Batch::s_Size);
+			e.m_pB = std::make_unique<Batch>();
+		}
+	}
+
+	if (!t.m_vec.empty())
+	{
+		get_Executor().ExecAll(t);
+
+		for (auto& e : t.m_vec)
+		{
+			pp[e.m_iIdx] = e.m_pB.get();
+			m[iBatch0 + e.m_iIdx] = std::move(e.m_pB);
+		}
+	}
+
+	while ((m.size() > ShieldedPrepared::s_MaxBatches) && (m.begin()->first < iBatch0))
+		m.erase(m.begin());
+}
+
+const ECC::Point::Storage* NodeProcessor::get_ShieldedPtr(TxoID id0, uint64_t nCount) const
+{
+	if (!m_ShieldedImage.IsOpen() || !nCount || (id0 + nCount > m_ShieldedImage.m_Points.get_Count()))
+		return nullptr;
+
+	return m_ShieldedImage.m_Points.get_As<ECC::Point::Storage>(id0);
+}
+
+void NodeProcessor::ShieldedRead(TxoID id0, ECC::Point::Storage* p, uint64_t nCount)
+{
+	const ECC::Point::Storage* pSrc = get_ShieldedPtr(id0, nCount);
+	if (pSrc)
+		std::copy(pSrc, pSrc + nCount, p);
+	else
+		m_DB.ShieldedRead(id0, p, nCount);
+}
+
+void NodeProcessor::ShieldedStateRead(TxoID id, ECC::Hash::Value& hv)
+{
+	if (m_ShieldedImage.IsOpen() && (id < m_ShieldedImage.m_States.get_Count()))
+		hv = *m_ShieldedImage.m_States.get_As<ECC::Hash::Value>(id);
+	else
+		m_DB.ShieldedStateRead(id, &hv, 1);
+}
+
 void NodeProcessor::TestDefinitionStrict()
 {
 	if (!TestDefinition())
@@ -356,7 +751,7 @@ int My_strcmpi(const char* sz1, const char* sz2)
 	return 0;
 }
 
-void NodeProcessor::get_MappingPath(std::string& sPath, const char* sz)
+void NodeProcessor::get_MappingPath(std::string& sPath, const char* sz, const char* szSuffix)
 {
 	// derive mapping path from db path
 	sPath = sz;
@@ -367,7 +762,7 @@ void NodeProcessor::get_MappingPath(std::string& sPath, const char* sz)
 	if ((sPath.size() >= nSufix) && !My_strcmpi(sPath.c_str() + sPath.size() - nSufix, szSufix))
 		sPath.resize(sPath.size() - nSufix);
 
-	sPath += "-utxo-image.bin";
+	sPath += szSuffix;
 }
 
 bool NodeProcessor::InitMapping(const char* sz, bool bForceReset)
@@ -457,8 +852,12 @@ void NodeProcessor::CommitMappingAndDB()
 		m_DB.ParamSet(NodeDB::ParamID::MappingStamp, nullptr, &blob);
 	}
 
+	m_BodyArchive.Flush(); // must be durable before the DB refers to it
+
 	m_DbTx.Commit();
 
+	m_BodyArchive.DropCompacted();
+
 	if (bFlushMapping)
 		m_Mapped.FlushStrict(us);
 }
@@ -466,7 +865,11 @@ void NodeProcessor::CommitMappingAndDB()
 void NodeProcessor::Vacuum()
 {
 	if (m_DbTx.IsInProgress())
+	{
+		m_BodyArchive.Flush();
 		m_DbTx.Commit();
+		m_BodyArchive.DropCompacted();
+	}
 
 	BEAM_LOG_INFO() << "DB compacting...";
 	m_DB.Vacuum();
@@ -489,11 +892,18 @@ void NodeProcessor::RollbackDB()
 	if (m_DbTx.IsInProgress())
 	{
 		m_DbTx.Rollback();
+
+		// compaction is undone as well
+		for (uint32_t iSegment : m_BodyArchive.m_vDrop)
+			m_BodyArchive.m_setSealed.insert(iSegment);
+		m_BodyArchive.m_vDrop.clear();
 	}
 }
 
 void NodeProcessor::InitCursor(bool bMovingUp, const NodeDB::StateID& sid)
 {
+	m_ProofTails.Reset();
+
 	if (sid.m_Number.v)
 	{
 		m_Cursor.m_Row = sid.m_Row;
@@ -1100,17 +1510,82 @@ struct NodeProcessor::MultiShieldedContext
 
 private:
 
-	Sigma::CmListVec m_Lst;
+	typedef Sigma::CmList::PreparedBatch PreparedBatch;
+	static const uint32_t s_PreparedPerChunk = s_Chunk / PreparedBatch::s_Size;
+	const PreparedBatch* m_ppPrepared[s_PreparedPerChunk];
+
+	const PreparedBatch* get_PreparedAt(uint32_t iBatch) const
+	{
+		return (iBatch < s_PreparedPerChunk) ? m_ppPrepared[iBatch] : nullptr;
+	}
+
+	struct CmListVec
+		:public Sigma::CmListVec
+	{
+		const PreparedBatch* get_Prepared(uint32_t iBatch) override
+		{
+			return get_ParentObj().get_PreparedAt(iBatch);
+		}
+
+		IMPLEMENT_GET_PARENT_OBJ(MultiShieldedContext, m_Lst)
+	} m_Lst;
 
 	bool IsValid(const TxKernelShieldedInput&, Height hScheme, std::vector<ECC::Scalar::Native>& vBuf, ECC::InnerProduct::BatchContext&);
 
+	struct CmListMapped
+		:public Sigma::CmList
+	{
+		const ECC::Point::Storage* m_p;
+		uint32_t m_Count;
+
+		const PreparedBatch* get_Prepared(uint32_t iBatch) override
+		{
+			return get_ParentObj().get_PreparedAt(iBatch);
+		}
+
+		IMPLEMENT_GET_PARENT_OBJ(MultiShieldedContext, m_LstMapped)
+
+		bool get_At(ECC::Point::Storage& res, uint32_t iIdx) override
+		{
+			if (iIdx >= m_Count)
+				return false;
+
+			res = m_p[iIdx];
+			return true;
+		}
+	} m_LstMapped;
+
+	Sigma::CmList* m_pLst = &m_Lst;
+
 	Sigma::CmList& get_List() override
 	{
-		return m_Lst;
+		return *m_pLst;
 	}
 
 	void PrepareList(NodeProcessor& np, const Node& n) override
 	{
+		static_assert(!(s_Chunk % PreparedBatch::s_Size), "");
+		uint32_t iBatch0 = n.m_Min / PreparedBatch::s_Size;
+		uint32_t iBatch1 = (n.m_Max + PreparedBatch::s_Size - 1) / PreparedBatch::s_Size;
+
+		for (uint32_t i = 0; i < iBatch0; i++)
+			m_ppPrepared[i] = nullptr;
+		for (uint32_t i = iBatch1; i < s_PreparedPerChunk; i++)
+			m_ppPrepared[i] = nullptr;
+
+		np.PrepareShieldedBatches(m_ppPrepared + iBatch0, n.m_ID.m_Value / PreparedBatch::s_Size + iBatch0, iBatch1 - iBatch0);
+
+		// use the shielded image directly, if available
+		const ECC::Point::Storage* p = np.get_ShieldedPtr(n.m_ID.m_Value + n.m_Min, n.m_Max - n.m_Min);
+		if (p)
+		{
+			m_LstMapped.m_p = p - n.m_Min;
+			m_LstMapped.m_Count = n.m_Max;
+			m_pLst = &m_LstMapped;
+			return;
+		}
+
+		m_pLst = &m_Lst;
 		m_Lst.m_vec.resize(s_Chunk); // will allocate if empty
 		np.get_DB().ShieldedRead(n.m_ID.m_Value + n.m_Min, &m_Lst.m_vec.front() + n.m_Min, n.m_Max - n.m_Min);
 	}
@@ -1240,7 +1715,7 @@ void NodeProcessor::MultiShieldedContext::Prepare(const TxVectors::Eternal& txve
 
 			auto nStatePos = v.m_WindowEnd - 1;
 			if (nStatePos < m_pProc->m_Extra.m_ShieldedOutputs)
-				m_pProc->get_DB().ShieldedStateRead(nStatePos, &hv, 1);
+				m_pProc->ShieldedStateRead(nStatePos, hv);
 			else
 				hv = Zero;
 
@@ -2025,6 +2500,8 @@ Height NodeProcessor::PruneOld()
 	if (IsBigger2(m_Cursor.m_Full.m_Number.v, m_Extra.m_Fossil.v, (uint64_t) Rules::get().MaxRollback))
 		hRet += RaiseFossil(Block::Number(m_Cursor.m_Full.m_Number.v - Rules::get().MaxRollback));
 
+	hRet += ArchiveBodies();
+
 	if (IsBigger2(m_Cursor.m_Full.m_Number.v, m_Extra.m_TxoLo.v, m_Horizon.m_Local.Lo))
 		hRet += RaiseTxoLo(Block::Number(m_Cursor.m_Full.m_Number.v - m_Horizon.m_Local.Lo));
 
@@ -2364,6 +2841,27 @@ void NodeProcessor::ProofBuilderHard::OnProof(Merkle::Hash& hv, bool bNewOnRight
 	m_Proof.back() = hv;
 }
 
+bool NodeProcessor::ProofTails::Append(Merkle::Proof& proof, const Key& key) const
+{
+	auto it = m_Map.find(key);
+	if (m_Map.end() == it)
+		return false;
+
+	const Merkle::Proof& tail = it->second;
+	proof.insert(proof.end(), tail.begin(), tail.end());
+	return true;
+}
+
+void NodeProcessor::ProofTails::Save(const Merkle::Proof& proof, size_t iPos, const Key& key)
+{
+	assert(iPos <= proof.size());
+
+	if (m_Map.size() >= s_MaxEntries)
+		m_Map.clear(); // rarely happens, only kernel/log proofs for many different past states
+
+	m_Map[key].assign(proof.begin() + iPos, proof.end());
+}
+
 struct NodeProcessor::ProofBuilder_PrevState
 	:public ProofBuilder
 {
@@ -2469,8 +2967,16 @@ Height NodeProcessor::get_ProofKernel(Merkle::Proof* pProof, TxKernel::Ptr* ppRe
 				}
 			};
 
-			MyProofBuilder pb(*this, *pProof, sid);
-			pb.GenerateProof();
+			ProofTails::Key key(sid.m_Row, ProofTails::Elem::Kernels);
+			if (!m_ProofTails.Append(*pProof, key))
+			{
+				size_t iPos = pProof->size();
+
+				MyProofBuilder pb(*this, *pProof, sid);
+				pb.GenerateProof();
+
+				m_ProofTails.Save(*pProof, iPos, key);
+			}
 		}
 	}
 
@@ -2480,6 +2986,81 @@ Height NodeProcessor::get_ProofKernel(Merkle::Proof* pProof, TxKernel::Ptr* ppRe
 	return h;
 }
 
+bool NodeProcessor::IsContractHistory(Height h)
+{
+	if (!m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+		return false;
+
+	if (NodeDB::Flags1::PendingRebuildNonStd & m_DB.ParamIntGetDef(NodeDB::ParamID::Flags1))
+		return false; // not populated yet
+
+	return h >= m_DB.ParamIntGetDef(NodeDB::ParamID::HeightContractHist, MaxHeight);
+}
+
+bool NodeProcessor::get_ContractVarAt(ByteBuffer& res, const Blob& key, Height h)
+{
+	if (h < m_Cursor.m_hh.m_Height)
+	{
+		// the earliest modification above the height has the value at that height
+		NodeDB::ContractHist::Walker wlk;
+		if (m_DB.ContractHistFind(wlk, key, h))
+		{
+			wlk.m_Entry.m_ValOld.Export(res);
+			return !res.empty();
+		}
+	}
+
+	Blob val;
+	NodeDB::Recordset rs;
+	if (!m_DB.ContractDataFind(key, val, rs))
+	{
+		res.clear();
+		return false;
+	}
+
+	val.Export(res);
+	return true;
+}
+
+bool NodeProcessor::EnumContractVarsAt(IContractVarsWalker& wlk, const Blob& kMin, const Blob& kMax, Height h)
+{
+	NodeDB::WalkerContractData wlkD;
+	m_DB.ContractDataEnum(wlkD, kMin, kMax);
+	bool bD = wlkD.MoveNext();
+
+	NodeDB::ContractHist::Walker wlkH;
+	bool bH = false;
+	if (h < m_Cursor.m_hh.m_Height)
+	{
+		m_DB.ContractHistEnum(wlkH, kMin, kMax, h);
+		bH = wlkH.MoveNext();
+	}
+
+	while (bD || bH)
+	{
+		int n = bD ? (bH ? wlkD.m_Key.cmp(wlkH.m_Entry.m_Key) : -1) : 1;
+		if (n < 0)
+		{
+			// not modified since
+			if (!wlk.OnVar(wlkD.m_Key, wlkD.m_Val))
+				return false;
+
+			bD = wlkD.MoveNext();
+		}
+		else
+		{
+			if (wlkH.m_Entry.m_ValOld.n && !wlk.OnVar(wlkH.m_Entry.m_Key, wlkH.m_Entry.m_ValOld))
+				return false;
+
+			if (!n)
+				bD = wlkD.MoveNext();
+			bH = wlkH.MoveNext();
+		}
+	}
+
+	return true;
+}
+
 bool NodeProcessor::get_ProofContractLog(Merkle::Proof& proof, const HeightPos& pos)
 {
 	if (!pos.m_Height)
@@ -2514,6 +3095,12 @@ bool NodeProcessor::get_ProofContractLog(Merkle::Proof& proof, const HeightPos&
 	NodeDB::StateID sid;
 	FindAtivePastHeight(sid, pos.m_Height);
 
+	ProofTails::Key key(sid.m_Row, ProofTails::Elem::Logs);
+	if (m_ProofTails.Append(proof, key))
+		return true;
+
+	size_t iPos = proof.size();
+
 	struct MyProofBuilder
 		:public ProofBuilder_PrevState
 	{
@@ -2544,6 +3131,7 @@ bool NodeProcessor::get_ProofContractLog(Merkle::Proof& proof, const HeightPos&
 	}
 
 	pb.GenerateProof();
+	m_ProofTails.Save(proof, iPos, key);
 
 	return true;
 }
@@ -2574,6 +3162,19 @@ struct NodeProcessor::BlockInterpretCtx
 	uint32_t m_ContractLogs = 0;
 	std::vector<Merkle::Hash> m_vLogs;
 
+	bool m_SaveHist = false; // maintain contract vars history
+
+	struct DeferredSig
+	{
+		std::vector<ECC::Point::Native> m_vPts;
+		ECC::Hash::Value m_hv;
+		ECC::Signature m_Sig;
+	};
+
+	std::vector<DeferredSig>* m_pvDeferredSigs = nullptr; // if set - contract sigs are collected, and batch-verified in parallel after the block is interpreted
+	bool VerifyDeferredSigs();
+	uint32_t m_ContractHist = 0;
+
 	ByteBuffer m_Rollback;
 
 	Merkle::Hash m_hvDependentCtx;
@@ -2897,7 +3498,10 @@ bool NodeProcessor::HandleTreasury(const Blob& blob)
 
 	std::vector<ContractInvokeExtraInfo> vC;
 	if (m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+	{
 		bic.m_pvC = &vC;
+		bic.m_SaveHist = true;
+	}
 
 
 	for (size_t iG = 0; iG < td.m_vGroups.size(); iG++)
@@ -2937,6 +3541,9 @@ bool NodeProcessor::HandleTreasury(const Blob& blob)
 
 			SerializeBuffer sb = ser.buffer();
 			m_DB.TxoAdd(id0, Blob(sb.first, static_cast<uint32_t>(sb.second)));
+
+			if (bic.m_pvC)
+				m_DB.TxoIdxAdd(id0, td.m_vGroups[iG].m_Data.m_vOutputs[i]->m_Commitment);
 		}
 	}
 
@@ -3186,7 +3793,16 @@ bool NodeProcessor::HandleBlockInternal(const HeightHash& id, const Block::Syste
 
 	std::vector<ContractInvokeExtraInfo> vC;
 	if (m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+	{
 		bic.m_pvC = &vC;
+		bic.m_SaveHist = true;
+	}
+
+	// Contract sigs depend on the keys collected during the interpretation, but their verification is context-free.
+	// Defer it, and verify all at once, batched per executor thread. Any failure invalidates the whole block anyway.
+	std::vector<BlockInterpretCtx::DeferredSig> vDeferredSigs;
+	if (bFirstTime)
+		bic.m_pvDeferredSigs = &vDeferredSigs;
 
 	bool bOk = bic.HandleValidatedBlock(block, pPbft);
 	if (!bOk)
@@ -3219,6 +3835,12 @@ bool NodeProcessor::HandleBlockInternal(const HeightHash& id, const Block::Syste
 	{
 		if (bFirstTime)
 		{
+			if (!bic.VerifyDeferredSigs())
+			{
+				BEAM_LOG_WARNING() << id << " contract signature invalid";
+				bOk = false;
+			}
+
 			if (bDefinition)
 			{
 				// check the validity of state description.
@@ -3359,6 +3981,10 @@ bool NodeProcessor::HandleBlockInternal(const HeightHash& id, const Block::Syste
 			ser & x;
 
 			SerializeBuffer sb = ser.buffer();
+
+			if (bic.m_pvC)
+				m_DB.TxoIdxAdd(id0, x.m_Commitment);
+
 			m_DB.TxoAdd(id0++, Blob(sb.first, static_cast<uint32_t>(sb.second)));
 		}
 
@@ -3615,6 +4241,9 @@ void NodeProcessor::Recognizer::Recognize(const TxKernelShieldedOutput& v, uint3
 {
 	TxoID nID = m_Extra.m_ShieldedOutputs++;
 
+	if (m_pShieldedCandidates && !m_pShieldedCandidates->count(&v))
+		return;
+
 	assert(m_Handler.m_pAccount);
 	const auto& acc = *m_Handler.m_pAccount;
 
@@ -3853,6 +4482,64 @@ bool NodeProcessor::BlockInterpretCtx::HandleKernelType(const TxKernelEvmInvoke&
 }
 
 
+bool NodeProcessor::BlockInterpretCtx::VerifyDeferredSigs()
+{
+	assert(m_pvDeferredSigs);
+	const auto& v = *m_pvDeferredSigs;
+	if (v.empty())
+		return true;
+
+	struct MyTask
+		:public Executor::TaskSync
+	{
+		const std::vector<DeferredSig>* m_pV;
+		std::vector<uint8_t> m_vFail; // per thread
+
+		static bool VerifyRange(const DeferredSig* p, uint32_t nCount)
+		{
+			// Dedicated batch, flushed right away. The caller (and the executor threads) may be within a foreign batch scope,
+			// in which case the sigs would only be accumulated and not checked
+			ECC::InnerProduct::BatchContextEx<4> bc;
+			ECC::InnerProduct::BatchContext::Scope scope(bc);
+
+			for (uint32_t i = 0; i < nCount; i++)
+				if (!bvm2::ProcessorContract::IsSigValid(p[i].m_vPts, p[i].m_hv, p[i].m_Sig))
+					return false;
+
+			return bc.Flush();
+		}
+
+		void Exec(Executor::Context& ctx) override
+		{
+			uint32_t i0, nCount;
+			ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_pV->size()));
+
+			if (nCount && !VerifyRange(&m_pV->front() + i0, nCount))
+				m_vFail[ctx.m_iThread] = 1;
+		}
+	};
+
+	// few sigs are not worth the executor round-trip (which also waits for the block verification tasks in flight)
+	const size_t nMinParallel = 16;
+	if (v.size() < nMinParallel)
+		return MyTask::VerifyRange(&v.front(), static_cast<uint32_t>(v.size()));
+
+	// one batch per thread, each flushed on its own, any failure invalidates the block
+	Executor& ex = m_Proc.get_Executor();
+
+	MyTask t;
+	t.m_pV = &v;
+	t.m_vFail.resize(ex.get_Threads());
+
+	ex.ExecAll(t);
+
+	for (auto x : t.m_vFail)
+		if (x)
+			return false;
+
+	return true;
+}
+
 bool NodeProcessor::BlockInterpretCtx::BvmProcessor::EnsureNoVars(const bvm2::ContractID& cid)
 {
 	Blob key(cid);
@@ -4576,21 +5263,16 @@ bool NodeProcessor::BlockInterpretCtx::HandleKernelType(const TxKernelShieldedOu
 			ECC::Point::Storage pt_s;
 			pt.Export(pt_s);
 
-			// Append to cmList
-			m_Proc.m_DB.ShieldedResize(m_Proc.m_Extra.m_ShieldedOutputs + 1, m_Proc.m_Extra.m_ShieldedOutputs);
-			m_Proc.m_DB.ShieldedWrite(m_Proc.m_Extra.m_ShieldedOutputs, &pt_s, 1);
-
-			// Append state hash
+			// Append to cmList, with the state hash
 			ECC::Hash::Value hvState;
 			if (m_Proc.m_Extra.m_ShieldedOutputs)
-				m_Proc.m_DB.ShieldedStateRead(m_Proc.m_Extra.m_ShieldedOutputs - 1, &hvState, 1);
+				m_Proc.ShieldedStateRead(m_Proc.m_Extra.m_ShieldedOutputs - 1, hvState);
 			else
 				hvState = Zero;
 
 			ShieldedTxo::UpdateState(hvState, pt_s);
 
-			m_Proc.m_DB.ShieldedStateResize(m_Proc.m_Extra.m_ShieldedOutputs + 1, m_Proc.m_Extra.m_ShieldedOutputs);
-			m_Proc.m_DB.ShieldedStateWrite(m_Proc.m_Extra.m_ShieldedOutputs, &hvState, 1);
+			m_Proc.ShieldedAppend(pt_s, hvState);
 		}
 
 		if (!m_SkipDefinition)
@@ -4616,10 +5298,7 @@ bool NodeProcessor::BlockInterpretCtx::HandleKernelType(const TxKernelShieldedOu
 		ValidateUniqueNoDup(blobKey, nullptr);
 
 		if (!m_Temporary)
-		{
-			m_Proc.m_DB.ShieldedResize(m_Proc.m_Extra.m_ShieldedOutputs - 1, m_Proc.m_Extra.m_ShieldedOutputs);
-			m_Proc.m_DB.ShieldedStateResize(m_Proc.m_Extra.m_ShieldedOutputs - 1, m_Proc.m_Extra.m_ShieldedOutputs);
-		}
+			m_Proc.ShieldedPop();
 
 		if (!m_SkipDefinition)
 			m_Proc.m_Mmr.m_Shielded.ShrinkTo(m_Proc.m_Mmr.m_Shielded.m_Count - 1);
@@ -4909,6 +5588,8 @@ bool NodeProcessor::BlockInterpretCtx::HandleBlockElement(const Input& v)
 		t.m_pBound[0] = kMin.V.m_pData;
 		t.m_pBound[1] = kMax.V.m_pData;
 
+		m_Proc.m_Mapped.m_Utxo.EnsureReserve(); // the path may be cloned, if shared with a snapshot
+
 		if (m_Proc.m_Mapped.m_Utxo.Traverse(t))
 		{
 			if (m_pTxErrorInfo)
@@ -4928,6 +5609,9 @@ bool NodeProcessor::BlockInterpretCtx::HandleBlockElement(const Input& v)
 			m_Proc.m_Mapped.m_Utxo.Delete(cu);
 		else
 		{
+			m_Proc.m_Mapped.m_Utxo.MakeWritable(cu);
+			p = &Cast::Up<UtxoTree::MyLeaf>(cu.get_Leaf());
+
 			nID = m_Proc.m_Mapped.m_Utxo.PopID(*p);
 			cu.InvalidateElement();
 			m_Proc.m_Mapped.m_Utxo.OnDirty();
@@ -5416,7 +6100,16 @@ bool NodeProcessor::BlockInterpretCtx::BvmProcessor::Invoke(const bvm2::Contract
 		}
 
 		if (!m_Bic.m_AlreadyValidated)
-			CheckSigs(krn.m_Commitment, krn.m_Signature);
+		{
+			if (m_Bic.m_pvDeferredSigs)
+			{
+				auto& ds = m_Bic.m_pvDeferredSigs->emplace_back();
+				PrepareSigs(ds.m_vPts, ds.m_hv, krn.m_Commitment);
+				ds.m_Sig = krn.m_Signature;
+			}
+			else
+				CheckSigs(krn.m_Commitment, krn.m_Signature);
+		}
 
 		bRes = true;
 
@@ -6054,7 +6747,19 @@ void NodeProcessor::BlockInterpretCtx::Storage::DataSaveWithRecovery(BlobMap::En
 			DataDel(key, e.m_Data);
 		}
 
-		Ser ser(get_ParentObj());
+		auto& bic = get_ParentObj(); // alias
+		if (bic.m_SaveHist && !bic.m_Temporary)
+		{
+			NodeDB::ContractHist::Entry x;
+			x.m_Pos.m_Height = bic.m_Height;
+			x.m_Pos.m_Pos = bic.m_ContractHist++;
+			x.m_Key = key;
+			x.m_ValOld = e.m_Data;
+			x.m_ValNew = data;
+			bic.m_Proc.m_DB.ContractHistInsert(x);
+		}
+
+		Ser ser(bic);
 		ser & nTag;
 		ser & key.n;
 		ser.WriteRaw(key.p, key.n);
@@ -6395,6 +7100,10 @@ void NodeProcessor::BlockInterpretCtx::Storage::UndoVars()
 
 				IPbftHandler* pPbft = (Rules::Consensus::Pbft == Rules::get().m_Consensus) ? bic.m_Proc.get_PbftHandler() : nullptr;
 
+				// Note: during reorg the history counter is not restored, the whole history above the target height is deleted afterwards.
+				if (bic.m_SaveHist && !bic.m_Temporary && bic.m_ContractHist)
+					bic.m_Proc.m_DB.ContractHistDelFrom(HeightPos(bic.m_Height, --bic.m_ContractHist));
+
 				if (RecoveryTag::Delete == nTag)
 				{
 					if (pPbft)
@@ -6613,6 +7322,7 @@ void NodeProcessor::RollbackTo(Block::Number num)
 		EnumTxos(wlk2, nr);
 
 		m_DB.TxoDelFrom(id0);
+		m_DB.TxoIdxDelFrom(id0);
 
 		// undo inputs, Kernels, shielded elements, and cursor
 		ByteBuffer bbE, bbR;
@@ -6701,6 +7411,7 @@ void NodeProcessor::RollbackTo(Block::Number num)
 		m_DB.AssetEvtsDeleteFrom(h + 1);
 		m_DB.ShieldedOutpDelFrom(h + 1);
 		m_DB.KrnInfoDelFrom(h + 1);
+		m_DB.ContractHistDelFrom(HeightPos(h + 1));
 
 		if (!TestDefinition())
 			OnCorrupted();
@@ -8165,26 +8876,110 @@ bool NodeProcessor::ITxoWalker_Unspent::OnTxo(const NodeDB::WalkerTxo& wlk, Heig
 
 void NodeProcessor::InitializeUtxos()
 {
+	// Outputs are collected in batches, decoded in parallel, and inserted into the tree in the key order.
+	// Sorted insertion keeps the tree traversal local, and the IDs of the same key are still pushed in ascending order.
 	struct Walker
-		:public ITxoWalker_UnspentNaked
+		:public ITxoWalker
 	{
+		struct Entry
+		{
+			TxoID m_ID;
+			Height m_Height;
+			uint32_t m_nNaked;
+			uint8_t m_pNaked[s_TxoNakedMax];
+			Output m_Outp;
+			UtxoTree::Key m_Key;
+		};
+
 		NodeProcessor& m_This;
-		Walker(NodeProcessor& x) :m_This(x) {}
+		std::vector<Entry> m_vBatch;
+		std::vector<uint32_t> m_vOrder;
+		uint32_t m_Count = 0;
+
+		Walker(NodeProcessor& x) :m_This(x)
+		{
+			m_vBatch.resize(0x4000);
+			m_vOrder.resize(m_vBatch.size());
+		}
+
+		struct MyTask
+			:public Executor::TaskSync
+		{
+			Walker* m_pThis;
+
+			void Exec(Executor::Context& ctx) override
+			{
+				uint32_t i0, nCount;
+				ctx.get_Portion(i0, nCount, m_pThis->m_Count);
+
+				for (uint32_t i = 0; i < nCount; i++)
+				{
+					Entry& e = m_pThis->m_vBatch[i0 + i];
+
+					e.m_Outp.m_Incubation = 0; // naked outputs have no other optional fields
+
+					Deserializer der;
+					der.reset(e.m_pNaked, e.m_nNaked);
+					der & e.m_Outp;
+
+					UtxoTree::Key::Data d;
+					d.m_Commitment = e.m_Outp.m_Commitment;
+					d.m_Maturity = e.m_Outp.get_MinMaturity(e.m_Height);
+					e.m_Key = d;
+				}
+			}
+		};
 
 		bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate) override
 		{
 			m_This.InitializeUtxosProgress(wlk.m_ID, m_pLa->m_Total);
-			return ITxoWalker_UnspentNaked::OnTxo(wlk, hCreate);
+
+			if (wlk.m_SpendHeight != MaxHeight)
+				return true;
+
+			Entry& e = m_vBatch[m_Count];
+			e.m_ID = wlk.m_ID;
+			e.m_Height = hCreate;
+
+			Blob val = wlk.m_Value;
+			TxoToNaked(e.m_pNaked, val); // always written into the buffer
+			e.m_nNaked = val.n;
+
+			if (++m_Count == m_vBatch.size())
+				Flush();
+
+			return true;
 		}
 
-		bool OnTxo(const NodeDB::WalkerTxo& wlk, Height hCreate, Output& outp) override
+		void Flush()
 		{
-			m_This.m_Extra.m_Txos = wlk.m_ID;
-			BlockInterpretCtx bic(m_This, hCreate, true);
-			if (!bic.HandleBlockElement(outp))
-				OnCorrupted();
+			if (!m_Count)
+				return;
 
-			return true;
+			MyTask t;
+			t.m_pThis = this;
+			m_This.get_Executor().ExecAll(t);
+
+			for (uint32_t i = 0; i < m_Count; i++)
+				m_vOrder[i] = i;
+
+			// entries are already in the ID order, stable sort preserves it for equal keys
+			std::stable_sort(m_vOrder.begin(), m_vOrder.begin() + m_Count, [this](uint32_t a, uint32_t b) {
+				return m_vBatch[a].m_Key.V < m_vBatch[b].m_Key.V;
+			});
+
+			for (uint32_t i = 0; i < m_Count; i++)
+			{
+				Entry& e = m_vBatch[m_vOrder[i]];
+
+				m_This.m_Extra.m_Txos = e.m_ID;
+				BlockInterpretCtx bic(m_This, e.m_Height, true);
+				if (!bic.HandleBlockElement(e.m_Outp))
+					OnCorrupted();
+			}
+
+			m_This.m_Extra.m_Txos = m_vBatch[m_Count - 1].m_ID + 1;
+			m_Count = 0;
 		}
 	};
 
@@ -8194,6 +8989,7 @@ void NodeProcessor::InitializeUtxos()
 	wlk.m_pLa = &la;
 
 	EnumTxos(wlk);
+	wlk.Flush();
 }
 
 bool NodeProcessor::GetBlock(const NodeDB::StateID& sid, ByteBuffer* pEthernal, ByteBuffer* pPerishable, Block::Number n0, Block::Number nLo1, Block::Number nHi1, bool bActive)
@@ -8397,8 +9193,37 @@ void NodeProcessor::RecentStates::Push(uint64_t rowID, const Block::SystemState:
 	e.m_State = s;
 }
 
+void NodeProcessor::RebuildTxoIdx()
+{
+	m_DB.TxoIdxDelFrom(0);
+
+	if (!m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+		return;
+
+	LongAction la("Indexing Txos...", m_Extra.m_Txos, m_pExternalHandler);
+
+	NodeDB::WalkerTxo wlk;
+	for (m_DB.EnumTxos(wlk, 0); wlk.MoveNext(); )
+	{
+		// serialized Output starts with flags (bit 0 is Y) followed by X
+		if (wlk.m_Value.n < sizeof(ECC::uintBig) + 1)
+			OnCorrupted();
+
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(wlk.m_Value.p);
+
+		ECC::Point pt;
+		pt.m_Y = 1 & p[0];
+		memcpy(pt.m_X.m_pData, p + 1, pt.m_X.nBytes);
+
+		m_DB.TxoIdxAdd(wlk.m_ID, pt);
+		la.OnProgress(wlk.m_ID);
+	}
+}
+
 void NodeProcessor::RebuildNonStd()
 {
+	RebuildTxoIdx();
+
 	Height h0 = Rules::get().pForks[2].m_Height;
 	if (m_Cursor.m_hh.m_Height < h0)
 		return; // no non-std data
@@ -8415,11 +9240,19 @@ void NodeProcessor::RebuildNonStd()
 	m_DB.AssetEvtsDeleteFrom(0);
 	m_DB.UniqueDeleteAll();
 	m_DB.KrnInfoDelFrom(0);
+	m_DB.ContractHistDelFrom(HeightPos(0));
 
 	m_Mmr.m_Assets.ResizeTo(0);
 	m_Mmr.m_Shielded.ResizeTo(0);
 	m_Extra.m_ShieldedOutputs = 0;
 
+	if (m_ShieldedImage.IsOpen())
+	{
+		m_ShieldedImage.m_Points.Resize(0);
+		m_ShieldedImage.m_States.Resize(0);
+	}
+	m_ShieldedPrepared.m_Map.clear();
+
 	static_assert(NodeDB::StreamType::StatesMmr == 0);
 	m_DB.StreamsDelAll(static_cast<NodeDB::StreamType::Enum>(1), NodeDB::StreamType::count);
 
@@ -8441,6 +9274,7 @@ void NodeProcessor::RebuildNonStd()
 			BlockInterpretCtx::ChangesFlush cf(m_This);
 
 			m_pBic->m_pvC = m_pvC;
+			bic.m_SaveHist = !!m_pvC;
 			bic.m_AlreadyValidated = true;
 			bic.m_Rollback.swap(m_Rollback); // optimization
 
@@ -8498,7 +9332,11 @@ void NodeProcessor::RebuildNonStd()
 	}
 
 	std::vector<ContractInvokeExtraInfo> vC;
-	wlk.m_pvC = m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo) ? &vC : nullptr;
+	if (m_DB.ParamIntGetDef(NodeDB::ParamID::RichContractInfo))
+	{
+		wlk.m_pvC = &vC;
+		m_DB.ParamIntSet(NodeDB::ParamID::HeightContractHist, 0); // replayed from the first height the contracts may exist
+	}
 
 	wlk.m_pLa = &la;
 
@@ -8711,6 +9549,7 @@ bool NodeProcessor::Mapped::Open(const char* sz, const Stamp& s)
 
 void NodeProcessor::Mapped::Close()
 {
+	m_Utxo.OnClose();
 	m_Utxo.m_RootOffset = 0; // prevent cleanup
 	m_Contract.m_RootOffset = 0;
 	m_Mapping.Close();
@@ -8734,14 +9573,35 @@ void NodeProcessor::Mapped::FlushStrict(const Stamp& s)
 	h.m_Stamp = s;
 }
 
+void NodeProcessor::Mapped::EnsureReserve(uint32_t iBank, uint32_t nSize, uint32_t nMinFree)
+{
+	if (m_Mapping.IsReserved(iBank, nMinFree))
+		return;
+
+	if (m_Utxo.m_pCow)
+	{
+		// the mapping may move
+		std::unique_lock<std::shared_mutex> scope(m_Utxo.m_pCow->m_Mutex);
+		m_Mapping.EnsureReserve(iBank, nSize, nMinFree);
+	}
+	else
+		m_Mapping.EnsureReserve(iBank, nSize, nMinFree);
+}
+
 void NodeProcessor::Mapped::Utxo::EnsureReserve()
 {
+	FreeRetired();
+
+	// with copy-on-write a single modification may clone the whole path, and the sibling
+	uint32_t nJoints = m_pCow ? (Key::s_Bits + 1) : 1;
+	uint32_t nOther = m_pCow ? 3 : 1;
+
 	try
 	{
-		get_ParentObj().m_Mapping.EnsureReserve(Type::UtxoLeaf, sizeof(MyLeaf), 1);
-		get_ParentObj().m_Mapping.EnsureReserve(Type::HashJoint, sizeof(MyJoint), 1);
-		get_ParentObj().m_Mapping.EnsureReserve(Type::UtxoQueue, sizeof(MyLeaf::IDQueue), 1);
-		get_ParentObj().m_Mapping.EnsureReserve(Type::UtxoNode, sizeof(MyLeaf::IDNode), 1);
+		get_ParentObj().EnsureReserve(Type::UtxoLeaf, sizeof(MyLeaf), nOther);
+		get_ParentObj().EnsureReserve(Type::HashJoint, sizeof(MyJoint), nJoints);
+		get_ParentObj().EnsureReserve(Type::UtxoQueue, sizeof(MyLeaf::IDQueue), nOther);
+		get_ParentObj().EnsureReserve(Type::UtxoNode, sizeof(MyLeaf::IDNode), 1);
 	}
 	catch (const std::exception& e)
 	{
@@ -8764,42 +9624,207 @@ intptr_t NodeProcessor::Mapped::Utxo::get_Base() const
 
 RadixTree::Leaf* NodeProcessor::Mapped::Utxo::CreateLeaf()
 {
-	return get_ParentObj().Allocate<MyLeaf>(Type::UtxoLeaf);
+	MyLeaf* p = get_ParentObj().Allocate<MyLeaf>(Type::UtxoLeaf);
+	OnAllocated(p);
+	return p;
 }
 
 void NodeProcessor::Mapped::Utxo::DeleteEmptyLeaf(Leaf* p)
 {
-	get_ParentObj().m_Mapping.Free(Type::UtxoLeaf, p);
+	Release(Type::UtxoLeaf, p);
 }
 
 RadixTree::Joint* NodeProcessor::Mapped::Utxo::CreateJoint()
 {
-	return get_ParentObj().Allocate<MyJoint>(Type::HashJoint);
+	MyJoint* p = get_ParentObj().Allocate<MyJoint>(Type::HashJoint);
+	OnAllocated(p);
+	return p;
 }
 
 void NodeProcessor::Mapped::Utxo::DeleteJoint(Joint* p)
 {
-	get_ParentObj().m_Mapping.Free(Type::HashJoint, p);
+	Release(Type::HashJoint, p);
 }
 
 UtxoTree::MyLeaf::IDQueue* NodeProcessor::Mapped::Utxo::CreateIDQueue()
 {
-	return get_ParentObj().Allocate<MyLeaf::IDQueue>(Type::UtxoQueue);
+	MyLeaf::IDQueue* p = get_ParentObj().Allocate<MyLeaf::IDQueue>(Type::UtxoQueue);
+	OnAllocated(p);
+	return p;
 }
 
 void NodeProcessor::Mapped::Utxo::DeleteIDQueue(MyLeaf::IDQueue* p)
 {
-	get_ParentObj().m_Mapping.Free(Type::UtxoQueue, p);
+	Release(Type::UtxoQueue, p);
 }
 
 UtxoTree::MyLeaf::IDNode* NodeProcessor::Mapped::Utxo::CreateIDNode()
 {
-	return get_ParentObj().Allocate<MyLeaf::IDNode>(Type::UtxoNode);
+	MyLeaf::IDNode* p = get_ParentObj().Allocate<MyLeaf::IDNode>(Type::UtxoNode);
+	OnAllocated(p);
+	return p;
 }
 
 void NodeProcessor::Mapped::Utxo::DeleteIDNode(MyLeaf::IDNode* p)
 {
-	get_ParentObj().m_Mapping.Free(Type::UtxoNode, p);
+	Release(Type::UtxoNode, p);
+}
+
+bool NodeProcessor::Mapped::Utxo::IsShared(const void* p) const
+{
+	return m_pCow && !m_setPrivate.count(get_ParentObj().m_Mapping.get_Offset(p));
+}
+
+void NodeProcessor::Mapped::Utxo::OnAllocated(const void* p)
+{
+	if (m_pCow)
+		m_setPrivate.insert(get_ParentObj().m_Mapping.get_Offset(p));
+}
+
+void NodeProcessor::Mapped::Utxo::Release(uint32_t iBank, void* p)
+{
+	MappedFile& m = get_ParentObj().m_Mapping;
+
+	if (m_pCow)
+	{
+		MappedFile::Offset off = m.get_Offset(p);
+		if (!m_setPrivate.erase(off))
+		{
+			// may be referenced by a snapshot
+			Retired& x = m_vRetired.emplace_back();
+			x.m_Offset = off;
+			x.m_iBank = iBank;
+			x.m_iSnapshot = m_iLastSnapshot;
+			return;
+		}
+	}
+
+	m.Free(iBank, p);
+}
+
+void NodeProcessor::Mapped::Utxo::FreeRetired()
+{
+	if (!m_pCow)
+		return;
+
+	uint64_t nReleased = m_pCow->m_nReleased;
+	if (nReleased == m_nReleasedSeen)
+		return;
+	m_nReleasedSeen = nReleased;
+
+	uint64_t iMinLive = std::numeric_limits<uint64_t>::max();
+	{
+		std::unique_lock<std::mutex> scope(m_pCow->m_mxLive);
+		if (!m_pCow->m_setLive.empty())
+			iMinLive = *m_pCow->m_setLive.begin();
+	}
+
+	MappedFile& m = get_ParentObj().m_Mapping;
+	size_t iDst = 0;
+
+	for (size_t i = 0; i < m_vRetired.size(); i++)
+	{
+		const Retired& x = m_vRetired[i];
+		if (x.m_iSnapshot < iMinLive)
+			m.Free(x.m_iBank, &m.get_At<uint8_t>(x.m_Offset));
+		else
+			m_vRetired[iDst++] = x;
+	}
+
+	m_vRetired.resize(iDst);
+
+	if (std::numeric_limits<uint64_t>::max() == iMinLive)
+	{
+		// no more snapshots
+		m_setPrivate.clear();
+		m_pCow.reset();
+		m_nReleasedSeen = 0;
+	}
+}
+
+void NodeProcessor::Mapped::Utxo::AddSnapshot(UtxoSnapshot& s)
+{
+	FreeRetired();
+
+	if (!m_pCow)
+	{
+		m_pCow = std::make_shared<UtxoCow>();
+		m_pCow->m_pMapping = &get_ParentObj().m_Mapping;
+	}
+
+	m_setPrivate.clear(); // from now on all the existing objects are shared
+
+	s.m_pCow = m_pCow;
+	s.m_iSnapshot = ++m_iLastSnapshot;
+	s.m_RootOffset = m_RootOffset;
+
+	std::unique_lock<std::mutex> scope(m_pCow->m_mxLive);
+	m_pCow->m_setLive.insert(s.m_iSnapshot);
+}
+
+void NodeProcessor::Mapped::Utxo::OnClose()
+{
+	if (!m_pCow)
+		return;
+
+	{
+		std::unique_lock<std::shared_mutex> scope(m_pCow->m_Mutex);
+		m_pCow->m_pMapping = nullptr; // invalidate the snapshots
+	}
+
+	// no readers anymore
+	MappedFile& m = get_ParentObj().m_Mapping;
+	for (const auto& x : m_vRetired)
+		m.Free(x.m_iBank, &m.get_At<uint8_t>(x.m_Offset));
+
+	m_vRetired.clear();
+	m_setPrivate.clear();
+	m_pCow.reset();
+	m_nReleasedSeen = 0;
+}
+
+NodeProcessor::UtxoSnapshot::Lock::Lock(const UtxoSnapshot& s)
+	:m_This(s)
+	,m_Lock(s.m_pCow->m_Mutex)
+{
+}
+
+bool NodeProcessor::UtxoSnapshot::Lock::IsValid() const
+{
+	return m_This.m_pCow->m_pMapping != nullptr;
+}
+
+intptr_t NodeProcessor::UtxoSnapshot::get_Base() const
+{
+	assert(m_pCow->m_pMapping); // must be locked and valid
+	return reinterpret_cast<intptr_t>(m_pCow->m_pMapping->get_Base());
+}
+
+NodeProcessor::UtxoSnapshot::~UtxoSnapshot()
+{
+	m_RootOffset = 0; // not owned
+
+	if (m_pCow)
+	{
+		{
+			std::unique_lock<std::mutex> scope(m_pCow->m_mxLive);
+			m_pCow->m_setLive.erase(m_iSnapshot);
+		}
+
+		m_pCow->m_nReleased++;
+	}
+}
+
+std::shared_ptr<NodeProcessor::UtxoSnapshot> NodeProcessor::CreateUtxoSnapshot()
+{
+	auto pRet = std::make_shared<UtxoSnapshot>();
+
+	Mapped::Utxo& t = m_Mapped.m_Utxo;
+	t.get_Hash(pRet->m_Hash); // all the nodes must be clean, the snapshot never modifies them
+	pRet->m_ID = m_Cursor.get_ID();
+
+	t.AddSnapshot(*pRet);
+	return pRet;
 }
 
 intptr_t NodeProcessor::Mapped::Contract::get_Base() const
@@ -8811,8 +9836,8 @@ void NodeProcessor::Mapped::Contract::EnsureReserve()
 {
 	try
 	{
-		get_ParentObj().m_Mapping.EnsureReserve(Type::HashJoint, sizeof(MyJoint), 1);
-		get_ParentObj().m_Mapping.EnsureReserve(Type::HashLeaf, sizeof(MyLeaf), 1);
+		get_ParentObj().EnsureReserve(Type::HashJoint, sizeof(MyJoint), 1);
+		get_ParentObj().EnsureReserve(Type::HashLeaf, sizeof(MyLeaf), 1);
 	}
 	catch (const std::exception& e)
 	{
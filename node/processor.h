@@ -23,6 +23,8 @@
 #include "../utility/containers.h"
 #include "db.h"
 #include "txpool.h"
+#include <shared_mutex>
+#include <unordered_set>
 
 namespace beam {
 
@@ -44,6 +46,20 @@ class NodeProcessor
 
 	NodeDB::Transaction m_DbTx;
 
+public:
+	struct UtxoSnapshot;
+private:
+
+	struct UtxoCow
+	{
+		// shared by the UTXO tree and its snapshots
+		std::shared_mutex m_Mutex; // the snapshot readers hold it shared. Exclusive while the mapping is resized or closed
+		const MappedFile* m_pMapping = nullptr; // reset once closed
+
+		std::mutex m_mxLive;
+		std::set<uint64_t> m_setLive;
+		std::atomic<uint64_t> m_nReleased{ 0 };
+	};
 
 	class Mapped
 	{
@@ -79,9 +95,29 @@ class NodeProcessor
 			friend class Mapped;
 
 			void OnDirty() override { get_ParentObj().OnDirty(); }
+			bool IsShared(const void*) const override;
 
 			void EnsureReserve();
 
+			// Copy-on-write, while there are live snapshots. Objects are tracked by offsets, the mapping may move
+			std::shared_ptr<UtxoCow> m_pCow;
+			uint64_t m_iLastSnapshot = 0;
+			uint64_t m_nReleasedSeen = 0;
+			std::unordered_set<MappedFile::Offset> m_setPrivate; // allocated after the last snapshot
+
+			struct Retired {
+				MappedFile::Offset m_Offset;
+				uint32_t m_iBank;
+				uint64_t m_iSnapshot; // the last snapshot that may reference it
+			};
+			std::vector<Retired> m_vRetired;
+
+			void OnAllocated(const void*);
+			void Release(uint32_t iBank, void*);
+			void FreeRetired();
+			void OnClose();
+			void AddSnapshot(UtxoSnapshot&);
+
 			IMPLEMENT_GET_PARENT_OBJ(Mapped, m_Utxo)
 		} m_Utxo;
 
@@ -108,6 +144,7 @@ class NodeProcessor
 		} m_Contract;
 
 		void OnDirty();
+		void EnsureReserve(uint32_t iBank, uint32_t nSize, uint32_t nMinFree); // waits for the snapshot readers if the mapping grows
 
 		typedef Merkle::Hash Stamp;
 
@@ -135,6 +172,65 @@ class NodeProcessor
 
 	Mapped m_Mapped;
 
+	struct ShieldedImage
+	{
+		// Mirror of the shielded outputs list and the cumulative state hashes (DB streams), for direct range access.
+		// The DB remains authoritative, the image is verified against it on open, and rebuilt if necessary.
+		MappedArray m_Points; // ECC::Point::Storage
+		MappedArray m_States; // ECC::Hash::Value
+
+		bool IsOpen() const { return m_Points.IsOpen(); }
+		void Close();
+
+		~ShieldedImage() { Close(); }
+
+	} m_ShieldedImage;
+
+	void InitializeShieldedImage(const char*);
+	void ShieldedAppend(const ECC::Point::Storage&, const ECC::Hash::Value&);
+	void ShieldedPop();
+
+	struct BodyArchive
+		:public NodeDB::IArchive
+	{
+		// Segment files with the eternal bodies of the fossil blocks, indexed by the DB.
+		// Segments are flushed before the DB commit, and the compacted ones are removed only after it.
+		std::string m_sPrefix;
+		std::map<uint32_t, MappedLog> m_mapSegments; // opened on demand
+		std::set<uint32_t> m_setSealed;
+		std::vector<uint32_t> m_vDrop;
+		uint32_t m_iTail = 0;
+		uint64_t m_nSegmentMax = 0; // if 0 - new bodies are not archived, existing segments are still used
+
+		void get_Path(std::string&, uint32_t iSegment) const;
+		MappedLog& get_Segment(uint32_t);
+		void Read(const NodeDB::ArchiveEntry&, ByteBuffer&) override;
+		void Append(NodeDB::ArchiveEntry&, const Blob&);
+		void Flush();
+		void DropCompacted();
+		void Close();
+
+		~BodyArchive() { Close(); }
+
+	} m_BodyArchive;
+
+	void InitializeBodyArchive(const char*, uint64_t nSegmentMax);
+	Height ArchiveBodies();
+	void CompactBodyArchive();
+
+	struct ShieldedPrepared
+	{
+		// Prepared (precomputed) complete batches of the shielded list, reused across sigma verifications.
+		// Evicted from the oldest, invalidated on rollback.
+		typedef Sigma::CmList::PreparedBatch Batch;
+		static const uint32_t s_MaxBatches = 0x80; // 128KB each
+
+		std::map<uint64_t, std::unique_ptr<Batch> > m_Map; // key: batch index
+
+	} m_ShieldedPrepared;
+
+	void PrepareShieldedBatches(const Sigma::CmList::PreparedBatch** pp, uint64_t iBatch0, uint32_t nBatches);
+
 	size_t m_nReserveBlockSizeForFees = 0;
 
 	struct InputAux {
@@ -154,6 +250,7 @@ class NodeProcessor
 	uint64_t RaiseTxoHi(Block::Number);
 	void Vacuum();
 	void RebuildNonStd();
+	void RebuildTxoIdx();
 	void InitializeUtxos();
 	bool TestDefinition();
 	void TestDefinitionStrict();
@@ -185,9 +282,6 @@ class NodeProcessor
 	static void TxoToNaked(uint8_t* pBuf, Blob&);
 	static bool TxoIsNaked(const Blob&);
 
-	Height GetInputMaturity(TxoID);
-
-	TxoID get_TxosBefore(Block::Number);
 	TxoID FindBlockByTxoID(NodeDB::StateID&, TxoID id0); // returns the Txos at state end
 	TxoID FindHeightByTxoID(Height&, TxoID id0);
 
@@ -271,13 +365,15 @@ public:
 		};
 		uint8_t m_RichInfoFlags = 0;
 		Blob m_RichParser = Blob(nullptr, 0);
+
+		uint64_t m_ArchiveSegment = 0; // max size of the block body archive segment. If 0 - the cold bodies remain in the DB
 	};
 
 	void Initialize(const char* szPath);
 	void Initialize(const char* szPath, const StartParams&, ILongAction* pExternalHandler = nullptr);
 
 	static bool ExtractTreasury(const Blob&, Treasury::Data&);
-	static void get_MappingPath(std::string&, const char*);
+	static void get_MappingPath(std::string&, const char*, const char* szSuffix = "-utxo-image.bin");
 
 	NodeProcessor();
 	virtual ~NodeProcessor();
@@ -482,8 +578,42 @@ public:
 	// use only for data retrieval for peers
 	NodeDB& get_DB() { return m_DB; }
 	UtxoTree& get_Utxos() { return m_Mapped.m_Utxo; }
+
+	// Read-only snapshot of the UTXO tree, can be used from other threads while the processor keeps going.
+	// The nodes modified after it are copied-on-write, the originals are freed once all the snapshots that may reference them are released.
+	// Access it only under the Lock. It's invalidated if the processor is closed.
+	struct UtxoSnapshot
+		:public UtxoTree
+	{
+		Block::SystemState::ID m_ID;
+		Merkle::Hash m_Hash;
+
+		class Lock
+		{
+			const UtxoSnapshot& m_This;
+			std::shared_lock<std::shared_mutex> m_Lock;
+		public:
+			Lock(const UtxoSnapshot&);
+			bool IsValid() const;
+		};
+
+		~UtxoSnapshot();
+
+	private:
+		friend class NodeProcessor;
+		std::shared_ptr<UtxoCow> m_pCow;
+		uint64_t m_iSnapshot = 0;
+
+		intptr_t get_Base() const override;
+	};
+
+	std::shared_ptr<UtxoSnapshot> CreateUtxoSnapshot();
 	RadixHashOnlyTree& get_Contracts() { return m_Mapped.m_Contract; }
 
+	const ECC::Point::Storage* get_ShieldedPtr(TxoID id0, uint64_t nCount) const; // direct access, if the image is available
+	void ShieldedRead(TxoID id0, ECC::Point::Storage*, uint64_t nCount);
+	void ShieldedStateRead(TxoID, ECC::Hash::Value&);
+
 	struct Evaluator
 		:public Block::SystemState::Evaluator
 	{
@@ -545,9 +675,43 @@ public:
 
 	struct ProofBuilder_PrevState;
 
+	struct ProofTails
+	{
+		// The definition proof part appended to each element proof depends only on the state and the proven element.
+		// Cached per state row, reset whenever the cursor moves.
+		enum struct Elem : uint8_t {
+			Utxos,
+			Kernels,
+			Logs,
+			Shielded,
+			Assets,
+			Contracts,
+		};
+
+		typedef std::pair<uint64_t, Elem> Key;
+		std::map<Key, Merkle::Proof> m_Map;
+
+		static const size_t s_MaxEntries = 0x100;
+
+		bool Append(Merkle::Proof&, const Key&) const;
+		void Save(const Merkle::Proof&, size_t iPos, const Key&);
+		void Reset() { m_Map.clear(); }
+
+	} m_ProofTails;
+
 	Height get_ProofKernel(Merkle::Proof*, TxKernel::Ptr*, NodeDB::StateID&, const Merkle::Hash& idKrn, const HeightPos* pPos);
 	bool get_ProofContractLog(Merkle::Proof&, const HeightPos&);
 
+	struct IContractVarsWalker
+	{
+		virtual bool OnVar(const Blob& key, const Blob& val) = 0; // return false to stop enumeration
+	};
+
+	// Contract vars state at the specified height. Heights below the cursor need the contract vars history, which is maintained in rich info mode
+	bool IsContractHistory(Height); // if the history is complete down to this height
+	bool get_ContractVarAt(ByteBuffer&, const Blob& key, Height);
+	bool EnumContractVarsAt(IContractVarsWalker&, const Blob& kMin, const Blob& kMax, Height); // returns false if stopped
+
 	void CommitDB();
 	void RollbackDB();
 
@@ -623,6 +787,8 @@ public:
 	void RescanAccounts(uint32_t nRecent);
 
 	uint64_t FindActiveAtStrict(Block::Number);
+	TxoID get_TxosBefore(Block::Number);
+	Height GetInputMaturity(TxoID); // of the spent UTXO, relatively heavy
 
 	Height Num2Height(const NodeDB::StateID&);
 	Height Num2Height(Block::Number);
@@ -831,6 +997,9 @@ public:
 
 		HeightPos m_Pos; // incremented when event is added
 
+		// optional: shielded outputs prefiltered by the caller (i.e. tickets tested in parallel). Others are only counted
+		const std::set<const TxKernelShieldedOutput*>* m_pShieldedCandidates = nullptr;
+
 		template <typename TEvt, typename TKey>
 		void AddEvent(const TEvt&, const TKey&);
 
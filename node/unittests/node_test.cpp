@@ -602,6 +602,36 @@ namespace beam
 		db.ShieldedResize(1, nShielded);
 		db.ShieldedResize(0, 1);
 
+		// mapped array, as used for the shielded image
+		{
+			std::string sPath = std::string(sz) + "-arr.bin";
+			DeleteFile(sPath.c_str());
+
+			const uint32_t nSig = 0x1234;
+			MappedArray arr;
+			verify_test(!arr.Open(sPath.c_str(), nSig, sizeof(ECC::Point::Storage))); // new
+
+			pts.Init();
+			arr.Resize(100000);
+			std::copy(pts.m_pArr, pts.m_pArr + _countof(pts.m_pArr), arr.get_As<ECC::Point::Storage>(99990));
+			arr.Resize(99995); // truncate
+
+			arr.Close();
+			verify_test(arr.Open(sPath.c_str(), nSig, sizeof(ECC::Point::Storage)));
+			verify_test(arr.get_Count() == 99995);
+
+			ZeroObject(pts.m_pArr);
+			std::copy(arr.get_As<ECC::Point::Storage>(99990), arr.get_As<ECC::Point::Storage>(99990) + 5, pts.m_pArr);
+			verify_test(pts.IsValid(0, 5, 0));
+
+			arr.Close();
+			verify_test(!arr.Open(sPath.c_str(), nSig, sizeof(ECC::Hash::Value))); // incompatible
+			verify_test(!arr.get_Count());
+
+			arr.Close();
+			DeleteFile(sPath.c_str());
+		}
+
 		ECC::uintBig k1 = 223U;
 		Blob val(nullptr, 0);
 
@@ -767,6 +797,45 @@ namespace beam
 		verify_test(wlkCdl.MoveNext());
 		verify_test(!wlkCdl.MoveNext());
 
+		// contract vars history
+		NodeDB::ContractHist::Entry che;
+		che.m_Key = hvKey;
+		che.m_ValOld = Blob(nullptr, 0);
+		che.m_ValNew = hvVal;
+		che.m_Pos = HeightPos(20, 0);
+		db.ContractHistInsert(che);
+
+		che.m_Key = hvKey2;
+		che.m_Pos = HeightPos(20, 1);
+		db.ContractHistInsert(che);
+
+		che.m_Key = hvKey;
+		che.m_ValOld = hvVal;
+		che.m_ValNew = hvKey2;
+		che.m_Pos = HeightPos(22, 0);
+		db.ContractHistInsert(che);
+
+		NodeDB::ContractHist::Walker wlkCh;
+		verify_test(db.ContractHistFind(wlkCh, hvKey, 19));
+		verify_test(!wlkCh.m_Entry.m_ValOld.n);
+		verify_test(db.ContractHistFind(wlkCh, hvKey, 20));
+		verify_test(Blob(hvVal) == wlkCh.m_Entry.m_ValOld);
+		verify_test(!db.ContractHistFind(wlkCh, hvKey, 22));
+
+		db.ContractHistEnum(wlkCh, hvKey, hvKey2, 19);
+		verify_test(wlkCh.MoveNext());
+		verify_test(wlkCh.m_Entry.m_Pos.m_Height == 20);
+		verify_test(Blob(hvKey) == wlkCh.m_Entry.m_Key);
+		verify_test(wlkCh.MoveNext());
+		verify_test(Blob(hvKey2) == wlkCh.m_Entry.m_Key);
+		verify_test(!wlkCh.MoveNext());
+
+		db.ContractHistDelFrom(HeightPos(20, 1));
+
+		db.ContractHistEnum(wlkCh, HeightPos(0), HeightPos(MaxHeight));
+		verify_test(wlkCh.MoveNext());
+		verify_test(!wlkCh.MoveNext());
+
 		// Cache
 		{
 			ECC::Hash::Value key1 = 1U;
@@ -873,16 +942,51 @@ namespace beam
 
 			verify_test(db.BridgeGetLastPos().m_Height == 0);
 		}
+
+		{
+			// commitment index. C and -C share the X coordinate, but must not be mixed
+			ECC::Point pt;
+			pt.m_X = 77u;
+			pt.m_Y = 0;
+			db.TxoIdxAdd(3, pt);
+			db.TxoIdxAdd(8, pt);
+
+			pt.m_Y = 1;
+			db.TxoIdxAdd(5, pt);
+
+			std::vector<TxoID> v;
+			db.TxoIdxFind(pt, v);
+			verify_test((v.size() == 1) && (v[0] == 5));
+
+			pt.m_Y = 0;
+			v.clear();
+			db.TxoIdxFind(pt, v);
+			verify_test((v.size() == 2) && (v[0] == 3) && (v[1] == 8));
+
+			db.TxoIdxDelFrom(5);
+			v.clear();
+			db.TxoIdxFind(pt, v);
+			verify_test((v.size() == 1) && (v[0] == 3));
+
+			pt.m_Y = 1;
+			v.clear();
+			db.TxoIdxFind(pt, v);
+			verify_test(v.empty());
+		}
 	}
 
 #ifdef WIN32
 		const char* g_sz = "mytest.db";
 		const char* g_sz2 = "mytest2.db";
 		const char* g_sz3 = "recovery_info";
+		const char* g_sz4 = "mytest4.db";
+		const char* g_sz5 = "mytest5.db";
 #else // WIN32
 		const char* g_sz = "/tmp/mytest.db";
 		const char* g_sz2 = "/tmp/mytest2.db";
 		const char* g_sz3 = "/tmp/recovery_info";
+		const char* g_sz4 = "/tmp/mytest4.db";
+		const char* g_sz5 = "/tmp/mytest5.db";
 #endif // WIN32
 
 	void TestNodeDB()
@@ -1126,13 +1230,61 @@ namespace beam
 	{
 		MyNodeProcessor1 np;
 		np.m_Horizon.m_Branching = 35;
-		np.Initialize(g_sz);
+
+		NodeProcessor::StartParams sp;
+		sp.m_ArchiveSegment = 0x1000; // small, to have several segments
+		np.Initialize(g_sz, sp);
 		np.OnTreasury(g_Treasury);
 
 		const Height hIncubation = 3; // artificial incubation period for outputs.
 
+		std::thread thrSnapshot;
+
 		for (Height h = 1; h <= 96; h++)
 		{
+			if (48 == h)
+			{
+				// verify the UTXO snapshot concurrently, while the processor keeps going
+				auto pSnapshot = np.CreateUtxoSnapshot();
+
+				thrSnapshot = std::thread([pSnapshot]()
+				{
+					NodeProcessor::UtxoSnapshot::Lock lock(*pSnapshot);
+					verify_test(lock.IsValid());
+
+					struct Traveler
+						:public UtxoTree::ITraveler
+					{
+						NodeProcessor::UtxoSnapshot* m_pSnapshot;
+						uint32_t m_Count = 0;
+
+						bool OnLeaf(const RadixTree::Leaf& x) override
+						{
+							Merkle::Proof proof;
+							m_pSnapshot->get_Proof(proof, *m_pCu);
+
+							Merkle::Hash hv;
+							Cast::Up<UtxoTree::MyLeaf>(x).get_Hash(hv);
+							Merkle::Interpret(hv, proof);
+							verify_test(hv == m_pSnapshot->m_Hash);
+
+							m_Count++;
+							return true;
+						}
+					} t;
+
+					UtxoTree::Cursor cu;
+					t.m_pCu = &cu;
+					t.m_pSnapshot = pSnapshot.get();
+					pSnapshot->Traverse(t);
+					verify_test(t.m_Count);
+
+					Merkle::Hash hv;
+					pSnapshot->get_Hash(hv);
+					verify_test(hv == pSnapshot->m_Hash);
+				});
+			}
+
 			while (true)
 			{
 				// Spend it in a transaction
@@ -1178,6 +1330,8 @@ namespace beam
 			blockChain.push_back(std::move(pBlock));
 		}
 
+		thrSnapshot.join();
+
 		for (Block::Number num(1); num.v <= np.m_Cursor.m_Full.m_Number.v; num.v++)
 		{
 			NodeDB::StateID sid;
@@ -1201,8 +1355,19 @@ namespace beam
 				verify_test(x.m_hSpent > num.v);
 			}
 
+			// fossil bodies are moved to the archive, and read transparently
+			NodeDB::ArchiveEntry ae;
+			verify_test(np.get_DB().ArchiveGet(sid.m_Row, ae) == (num.v <= np.m_Extra.m_Fossil.v));
+
+			ByteBuffer bufE;
+			np.get_DB().GetStateBlock(sid.m_Row, nullptr, &bufE, nullptr);
+			verify_test(bufE == blockChain[num.v - 1]->m_Body.m_Eternal);
 		}
 
+		std::vector<uint32_t> vSegs;
+		np.get_DB().ArchiveEnumSegments(vSegs);
+		verify_test(vSegs.size() > 1);
+		verify_test(np.get_DB().ParamIntGetDef(NodeDB::ParamID::ArchiveTail) >= vSegs.back());
 	}
 
 
@@ -1668,7 +1833,7 @@ namespace beam
 			unsigned int m_WaitingCycles;
 
 			Height m_HeightMax;
-			const Height m_HeightTrg = 70;
+			Height m_HeightTrg = 70;
 
 			MyClient()
 			{
@@ -1750,12 +1915,37 @@ namespace beam
 		pReactor->run();
 
 		node.GenerateRecoveryInfo(g_sz3);
+		Height hRecovery = node.get_Processor().m_Cursor.m_hh.m_Height;
+
+		// mine a few more blocks, and generate the delta
+		cl.m_HeightTrg += 10;
+		cl.m_WaitingCycles = 0;
+		pReactor->run();
+
+		verify_test(node.get_Processor().m_Cursor.m_hh.m_Height > hRecovery);
+
+		std::string sDelta = std::string(g_sz3) + ".delta";
+		{
+			ByteBuffer buf;
+			verify_test(node.GenerateRecoveryDelta(buf, hRecovery));
+
+			std::FStream fs;
+			fs.Open(sDelta.c_str(), false, true);
+			fs.write(&buf.front(), buf.size());
+		}
 
 		struct MyParser :public RecoveryInfo::IParser
 		{
 			Key::IPKdf::Ptr m_pOwner1;
 			Key::IPKdf::Ptr m_pOwner2;
 			uint32_t m_nUnrecognized = 0;
+			uint32_t m_nSpent = 0;
+
+			bool OnUtxoSpent(Height, const UtxoTree::Key::Data&) override
+			{
+				m_nSpent++;
+				return true;
+			}
 
 			bool OnUtxo(Height h, const Output& outp) override
 			{
@@ -1777,7 +1967,39 @@ namespace beam
 
 		verify_test(parser.Proceed(g_sz3));
 
+		parser.m_nUnrecognized = 0;
+		verify_test(parser.Proceed(g_sz3, { sDelta }));
+		verify_test(!parser.m_nSpent); // no txs, coinbase outputs only
+
+		{
+			// the delta UTXO root is verified against the set carried forward from the full file
+			ByteBuffer buf;
+			verify_test(node.GenerateRecoveryDelta(buf, hRecovery));
+
+			Merkle::Hash hv;
+			NodeProcessor::Evaluator ev(node.get_Processor());
+			verify_test(ev.get_Utxos(hv));
+
+			auto it = std::search(buf.begin(), buf.end(), hv.m_pData, hv.m_pData + hv.nBytes);
+			verify_test(buf.end() != it);
+			*it ^= 1;
+
+			std::FStream fs;
+			fs.Open(sDelta.c_str(), false, true);
+			fs.write(&buf.front(), buf.size());
+		}
+
+		bool bRejected = false;
+		try {
+			parser.Proceed(g_sz3, { sDelta });
+		}
+		catch (const std::exception&) {
+			bRejected = true;
+		}
+		verify_test(bRejected);
+
 		DeleteFile(g_sz3);
+		DeleteFile(sDelta.c_str());
 	}
 
 	namespace bvm2
@@ -1796,6 +2018,100 @@ namespace beam
 
 	}
 
+	void TestContractSigDeferred()
+	{
+		// contract sigs are verified after the block is interpreted. A block with an invalid one must be rejected
+		MyNodeProcessor1 np;
+		np.Initialize(g_sz);
+		np.OnTreasury(g_Treasury);
+
+		struct Miner
+		{
+			static void Apply(MyNodeProcessor1& np, const NodeProcessor::BlockContext& bc)
+			{
+				np.OnState(bc.m_Hdr, PeerID());
+
+				Block::SystemState::ID id;
+				bc.m_Hdr.get_ID(id);
+				np.OnBlock(id, bc.m_Body.m_Perishable, bc.m_Body.m_Eternal, PeerID());
+				np.TryGoUp();
+			}
+		};
+
+		while (!Rules::get().IsPastFork_<3>(np.m_Cursor.m_hh.m_Height + 1))
+		{
+			NodeProcessor::BlockContext bc(np.m_TxPool, 0, *np.m_Wallet.m_pKdf, *np.m_Wallet.m_pKdf);
+			verify_test(np.GenerateNewBlock(bc));
+			Miner::Apply(np, bc);
+		}
+
+		const Block::Number num0 = np.m_Cursor.m_Full.m_Number;
+
+		{
+			Transaction::Ptr pTx = std::make_shared<Transaction>();
+
+			auto pKrn = std::make_unique<TxKernelContractCreate>();
+			bvm2::Compile(pKrn->m_Data, "vault/contract.wasm", bvm2::Processor::Kind::Contract);
+
+			ECC::Scalar::Native sk;
+			sk.GenRandomNnz();
+			ECC::Point::Native ptFunds(Zero);
+			pKrn->Sign(&sk, 1, ptFunds, nullptr);
+
+			pTx->m_vKernels.push_back(std::move(pKrn));
+			sk = -sk;
+			pTx->m_Offset = sk;
+			pTx->Normalize();
+
+			Transaction::Context ctx;
+			ctx.m_Height = np.m_Cursor.m_hh.m_Height + 1;
+			verify_test(pTx->IsValid(ctx));
+
+			Transaction::KeyType key;
+			pTx->get_Key(key);
+
+			TxPool::Stats stats;
+			stats.From(*pTx, ctx, 0, 0);
+
+			np.m_TxPool.AddValidTx(std::move(pTx), stats, key, TxPool::Fluff::State::Fluffed);
+		}
+
+		for (uint32_t iPass = 0; iPass < 2; iPass++)
+		{
+			const bool bTamper = !iPass;
+
+			NodeProcessor::BlockContext bc(np.m_TxPool, 0, *np.m_Wallet.m_pKdf, *np.m_Wallet.m_pKdf);
+			verify_test(np.GenerateNewBlock(bc));
+
+			if (bTamper)
+			{
+				bool bFound = false;
+				for (size_t i = 0; i < bc.m_Block.m_vKernels.size(); i++)
+				{
+					TxKernel& krn = *bc.m_Block.m_vKernels[i];
+					if (TxKernel::Subtype::ContractCreate != krn.get_Subtype())
+						continue;
+
+					auto& krnC = Cast::Up<TxKernelContractCreate>(krn);
+					krnC.m_Signature.m_k.m_Value.Inc();
+					krnC.CalculateID();
+					bFound = true;
+				}
+				verify_test(bFound);
+
+				// Re-build the header for the tampered block. Within a batch scope the sig is only accumulated, and this batch is never flushed
+				ECC::InnerProduct::BatchContextEx<1> bcSkip;
+				ECC::InnerProduct::BatchContext::Scope scope(bcSkip);
+
+				bc.m_Mode = NodeProcessor::BlockContext::Mode::Finalize;
+				verify_test(np.GenerateNewBlock(bc));
+			}
+
+			Miner::Apply(np, bc);
+			verify_test(np.m_Cursor.m_Full.m_Number.v == num0.v + iPass);
+		}
+	}
+
 	struct PbftTreasuryBuilderBase
 	{
 		Treasury::Data::Group& m_Tg;
@@ -2063,6 +2379,7 @@ namespace beam
 
 			std::set<ECC::Point> m_UtxosBeingSpent;
 			std::list<ECC::Point> m_queProofsExpected;
+			std::list<std::vector<ECC::Point> > m_queProofsBatchExpected;
 			std::list<uint32_t> m_queProofsStateExpected;
 			std::list<uint32_t> m_queProofsKrnExpected;
 			uint32_t m_nChainWorkProofsPending = 0;
@@ -2152,6 +2469,7 @@ namespace beam
 			{
 				return
 					m_queProofsExpected.empty() &&
+					m_queProofsBatchExpected.empty() &&
 					m_queProofsKrnExpected.empty() &&
 					m_queProofsStateExpected.empty() &&
 					m_queProofLogsExpected.empty() &&
@@ -2616,6 +2934,8 @@ namespace beam
 					Send(msgOut2);
 				}
 
+				proto::GetProofUtxoBatch msgBatch;
+
 				for (auto it = m_Wallet.m_MyUtxos.begin(); m_Wallet.m_MyUtxos.end() != it; it++)
 				{
 					const MiniWallet::MyUtxo& utxo = it->second;
@@ -2629,9 +2949,18 @@ namespace beam
 					{
 						Send(msgOut2);
 						m_queProofsExpected.push_back(msgOut2.m_Utxo);
+
+						if (msgBatch.m_Utxos.size() < proto::g_ProofUtxoBatchMaxSize)
+							msgBatch.m_Utxos.push_back(msgOut2.m_Utxo);
 					}
 				}
 
+				if (!msgBatch.m_Utxos.empty())
+				{
+					Send(msgBatch);
+					m_queProofsBatchExpected.push_back(std::move(msgBatch.m_Utxos));
+				}
+
 				for (uint32_t i = 0; i < m_Wallet.m_MyKernels.size(); i++)
 				{
 					const MiniWallet::MyKernel mk = m_Wallet.m_MyKernels[i];
@@ -3396,6 +3725,30 @@ namespace beam
 					fail_test("unexpected proof");
 			}
 
+			void OnMsg(proto::ProofUtxoBatch&& msg) override
+			{
+				if (!m_queProofsBatchExpected.empty())
+				{
+					const std::vector<ECC::Point>& vComm = m_queProofsBatchExpected.front();
+					verify_test(msg.m_Proofs.size() == vComm.size());
+
+					for (uint32_t i = 0; i < vComm.size(); i++)
+					{
+						verify_test(!msg.m_Proofs[i].empty());
+
+						for (auto& p : msg.m_Proofs[i])
+						{
+							p.m_Proof.insert(p.m_Proof.end(), msg.m_Common.begin(), msg.m_Common.end());
+							verify_test(m_vStates.back().IsValidProofUtxo(vComm[i], p));
+						}
+					}
+
+					m_queProofsBatchExpected.pop_front();
+				}
+				else
+					fail_test("unexpected proof");
+			}
+
 			void OnMsg(proto::ProofKernel2&& msg) override
 			{
 				if (!m_queProofsKrnExpected.empty())
@@ -3809,10 +4162,33 @@ namespace beam
 
 		MyParser p;
 		p.Init(cl.m_Wallet.m_pKdf);
+
+		uint32_t t_ms = GetTime_ms();
 		p.Proceed(beam::g_sz3); // check we can rebuild the Live consistently with shielded and assets
+		t_ms = GetTime_ms() - t_ms;
 
 		verify_test((p.m_SpendKeys.size() == 1) && p.m_Utxos && p.m_UtxosCA && p.m_Assets && p.m_ShieldedOuts && p.m_ShieldedIns);
 
+		{
+			// parallel recognition, small batches. Must report the same
+			ExecutorMT_R ex;
+			Executor::Scope scope(ex);
+
+			MyParser p2;
+			p2.Init(cl.m_Wallet.m_pKdf);
+			p2.m_BatchSize = 7;
+
+			uint32_t t2_ms = GetTime_ms();
+			p2.Proceed(beam::g_sz3);
+			t2_ms = GetTime_ms() - t2_ms;
+
+			printf("Recovery parse: %u ms, parallel (%u threads): %u ms\n", t_ms, ex.get_Threads(), t2_ms);
+
+			verify_test(p2.m_SpendKeys == p.m_SpendKeys);
+			verify_test((p2.m_Utxos == p.m_Utxos) && (p2.m_UtxosCA == p.m_UtxosCA) && (p2.m_Assets == p.m_Assets));
+			verify_test((p2.m_ShieldedOuts == p.m_ShieldedOuts) && (p2.m_ShieldedIns == p.m_ShieldedIns));
+		}
+
 		node.PrintTxos();
 
 		NodeProcessor& proc = node.get_Processor();
@@ -3877,6 +4253,63 @@ namespace beam
 		}
 	}
 
+	void TestContractReadCache()
+	{
+		MiniBlockChain cc;
+		cc.Generate(10);
+
+		Block::SystemState::HistoryMap hist;
+		for (uint32_t i = 0; i < 5; i++)
+			hist.AddStates(&cc.m_vStates[i].m_Hdr, 1);
+
+		bvm2::ManagerStd::ReadCache rc;
+
+		bvm2::ManagerStd::ReadCache::Key kVars, kLogs, kLogsOpen;
+		kVars.m_Logs = false;
+		kVars.m_KeyMin.push_back(1);
+		kVars.m_KeyMax.push_back(2);
+
+		kLogs = kVars;
+		kLogs.m_Logs = true;
+		kLogs.m_PosMax.m_Height = hist.m_Map.rbegin()->first;
+
+		kLogsOpen = kLogs;
+		kLogsOpen.m_PosMax.m_Height = MaxHeight;
+
+		auto fnSave = [&](const bvm2::ManagerStd::ReadCache::Key& key)
+		{
+			Merkle::Hash hvTip;
+			verify_test(!rc.Find(key, hist, hvTip));
+			verify_test(hvTip != Zero);
+
+			bvm2::ManagerStd::ReadCache::Items v;
+			v.emplace_back().m_Key.push_back(1);
+			rc.Save(key, hvTip, std::move(v), hist);
+
+			verify_test(rc.Find(key, hist, hvTip));
+		};
+
+		fnSave(kVars);
+		fnSave(kLogs);
+		fnSave(kLogsOpen);
+
+		auto stats = rc.get_Stats();
+		verify_test((stats.m_Entries == 3) && (stats.m_Hits == 3) && (stats.m_Misses == 3));
+
+		// extend the chain: only logs bounded by the old tip survive
+		hist.AddStates(&cc.m_vStates[5].m_Hdr, 1);
+
+		Merkle::Hash hvTip;
+		verify_test(!rc.Find(kVars, hist, hvTip));
+		verify_test(rc.Find(kLogs, hist, hvTip));
+		verify_test(!rc.Find(kLogsOpen, hist, hvTip));
+
+		// reorg: everything is dropped
+		hist.DeleteFrom(cc.m_vStates[4].m_Hdr.get_Height());
+		verify_test(!rc.Find(kLogs, hist, hvTip));
+		verify_test(!rc.get_Stats().m_Entries);
+	}
+
 	void RaiseNumberTo(Node& node, Block::Number h)
 	{
 		while (node.get_Processor().m_Cursor.m_Full.m_Number < h)
@@ -3903,6 +4336,7 @@ namespace beam
 		node.m_Cfg.m_Listen.port(g_Port);
 		node.m_Cfg.m_Listen.ip(INADDR_ANY);
 		node.m_Cfg.m_MiningThreads = 0;
+		node.m_Cfg.m_IoThreads = 2; // inbound connections served by the I/O shards
 		node.m_Cfg.m_Treasury = g_Treasury;
 
 		ECC::SetRandom(node);
@@ -4008,6 +4442,14 @@ namespace beam
 					else
 						m_nProofsExpected++;
 
+					ECC::Point pt;
+					ZeroObject(pt);
+
+					RequestUtxoBatch::Ptr pBatch(new RequestUtxoBatch);
+					pBatch->m_Msg.m_Utxos.resize(i, pt); // unknown utxos, empty results expected
+					net.PostRequest(*pBatch, *this);
+					m_nProofsExpected++;
+
 					RequestKernel::Ptr pKrnl(new RequestKernel);
 					net.PostRequest(*pKrnl, *this);
 
@@ -4469,6 +4911,314 @@ namespace beam
 		}
 	}
 
+	void TestCompactBodies()
+	{
+		// New blocks are requested in compact form, outputs are restored from the tx pool. An output in the pool with the same commitment,
+		// but different otherwise, must not be substituted. The body should be requested in full instead.
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		MiniWallet wallet;
+		ECC::SetRandom(wallet.m_pKdf);
+
+		Node nodeS;
+		nodeS.m_Cfg.m_sPathLocal = g_sz;
+		nodeS.m_Cfg.m_Listen.port(g_Port);
+		nodeS.m_Cfg.m_Listen.ip(INADDR_ANY);
+		nodeS.m_Cfg.m_MiningThreads = 0;
+		nodeS.m_Cfg.m_Treasury = g_Treasury;
+		nodeS.m_Keys.SetSingleKey(wallet.m_pKdf);
+		nodeS.m_Keys.m_pMiner = nodeS.m_Keys.m_pGeneric;
+		nodeS.Initialize();
+		nodeS.m_PostStartSynced = true;
+
+		RaiseNumberTo(nodeS, Block::Number(Rules::get().Maturity.Coinbase + 3));
+
+		Node nodeD;
+		nodeD.m_Cfg.m_sPathLocal = g_sz2;
+		nodeD.m_Cfg.m_MiningThreads = 0;
+		nodeD.m_Cfg.m_Treasury = g_Treasury;
+		verify_test(nodeD.m_Cfg.m_CompactBlocks);
+		ECC::SetRandom(nodeD);
+
+		io::Address& addr = nodeD.m_Cfg.m_Connect.emplace_back();
+		addr.resolve("127.0.0.1");
+		addr.port(g_Port);
+		nodeD.Initialize();
+
+		struct MyRunner
+		{
+			Node* m_pS;
+			Node* m_pD;
+			MiniWallet* m_pWallet;
+
+			Waiter m_W;
+			io::Timer::Ptr m_pTimer;
+			uint32_t m_iPhase = 0;
+			Merkle::Hash m_hvKrn;
+
+			void MakeTx(Transaction::Ptr& pTx, Height hCoinbase, Height h, Height hIncubation)
+			{
+				const Amount fee = 100;
+
+				MiniWallet::MyUtxo utxoIn;
+				utxoIn.m_Cid = CoinID(Rules::get().get_Emission(hCoinbase), hCoinbase, Key::Type::Coinbase);
+
+				MiniWallet::MyUtxo utxoOut;
+				utxoOut.m_Cid = utxoIn.m_Cid;
+				utxoOut.m_Cid.m_Type = Key::Type::Regular;
+				utxoOut.m_Cid.m_Value -= fee;
+
+				pTx = std::make_shared<Transaction>();
+				pTx->m_Offset = Zero;
+
+				m_pWallet->ToInput(utxoIn, *pTx);
+				m_pWallet->MakeTxKernel(*pTx, fee, h);
+				m_pWallet->ToOutput(utxoOut, *pTx, h, hIncubation); // same commitment, regardless to incubation
+
+				pTx->Normalize();
+			}
+
+			static void AddToPool(Node& node, Transaction::Ptr pTx, Height h)
+			{
+				Transaction::Context ctx;
+				ctx.m_Height.m_Min = h + 1;
+				verify_test(pTx->IsValid(ctx));
+
+				Transaction::KeyType key;
+				pTx->get_Key(key);
+
+				TxPool::Stats stats;
+				stats.From(*pTx, ctx, 0, 0);
+
+				node.m_TxPool.AddValidTx(std::move(pTx), stats, key, TxPool::Fluff::State::Fluffed);
+			}
+
+			void MineNext(Height hCoinbase, bool bSameTx)
+			{
+				Height h = m_pS->get_Processor().m_Cursor.m_hh.m_Height;
+
+				Transaction::Ptr pTx;
+				MakeTx(pTx, hCoinbase, h, 0);
+				m_hvKrn = pTx->m_vKernels.front()->get_ID();
+
+				if (bSameTx)
+					AddToPool(*m_pD, pTx, h);
+				else
+				{
+					Transaction::Ptr pTx2;
+					MakeTx(pTx2, hCoinbase, h, 5);
+					verify_test(pTx2->m_vOutputs.front()->m_Commitment == pTx->m_vOutputs.front()->m_Commitment);
+					AddToPool(*m_pD, std::move(pTx2), h);
+				}
+
+				AddToPool(*m_pS, std::move(pTx), h);
+				RaiseNumberTo(*m_pS, Block::Number(m_pS->get_Processor().m_Cursor.m_Full.m_Number.v + 1));
+			}
+
+			void OnTimer()
+			{
+				NodeProcessor& pD = m_pD->get_Processor();
+				if (pD.m_Cursor.m_Full.m_Number.v < m_pS->get_Processor().m_Cursor.m_Full.m_Number.v)
+					return;
+
+				if (m_iPhase)
+					verify_test(pD.get_DB().FindKernel(m_hvKrn) > 0); // the tx is in the block, as mined
+
+				switch (m_iPhase++)
+				{
+				case 0:
+					MineNext(1, true);
+					break;
+
+				case 1:
+					verify_test(1 == m_pD->m_nCompactBodies);
+					verify_test(m_pD->m_BodyPropagation.m_Count); // measured for the restored body
+					MineNext(2, false);
+					break;
+
+				default:
+					verify_test(1 == m_pD->m_nCompactBodies); // rebuild failed, received in full
+					m_pTimer->cancel();
+					m_W.StopSafe(true);
+				}
+			}
+
+		} r;
+
+		r.m_pS = &nodeS;
+		r.m_pD = &nodeD;
+		r.m_pWallet = &wallet;
+
+		r.m_pTimer = io::Timer::create(*pReactor);
+		r.m_pTimer->start(100, true, [&r]() { r.OnTimer(); });
+
+		verify_test(r.m_W.Wait());
+	}
+
+	void TestNodeSyncMultiPeer(bool bFastSync)
+	{
+		// Source S is slow, the synching node D requests the first blocks from it. F1, F2 (with the same chain) join later,
+		// receive the subsequent body ranges, and the late range from S is re-requested from them.
+		io::Reactor::Ptr pReactor(io::Reactor::create());
+		io::Reactor::Scope scope(*pReactor);
+
+		const uint32_t nDelay_ms = 4000;
+
+		Node nodeS;
+		nodeS.m_Cfg.m_sPathLocal = g_sz;
+		nodeS.m_Cfg.m_Listen.port(g_Port);
+		nodeS.m_Cfg.m_Listen.ip(INADDR_ANY);
+		nodeS.m_Cfg.m_MiningThreads = 0;
+		nodeS.m_Cfg.m_Treasury = g_Treasury;
+		ECC::SetRandom(nodeS);
+
+		nodeS.Initialize();
+		nodeS.m_PostStartSynced = true;
+
+		std::vector<BlockPlus::Ptr> vChain;
+		while (nodeS.get_Processor().m_Cursor.m_Full.m_Number.v < 60)
+		{
+			NodeProcessor::BlockContext bc(nodeS.m_TxPool, 0, *nodeS.m_Keys.m_pMiner, *nodeS.m_Keys.m_pMiner);
+			bc.m_pParent = nodeS.m_TxDependent.m_pBest;
+			verify_test(nodeS.get_Processor().GenerateNewBlock(bc));
+			nodeS.get_Processor().OnState(bc.m_Hdr, PeerID());
+
+			Block::SystemState::ID id;
+			bc.m_Hdr.get_ID(id);
+			nodeS.get_Processor().OnBlock(id, bc.m_Body.m_Perishable, bc.m_Body.m_Eternal, PeerID());
+			nodeS.get_Processor().TryGoUp();
+
+			BlockPlus::Ptr pBlock(new BlockPlus);
+			pBlock->m_Hdr = std::move(bc.m_Hdr);
+			pBlock->m_Body = std::move(bc.m_Body);
+			vChain.push_back(std::move(pBlock));
+		}
+
+		nodeS.m_Cfg.m_TestMode.m_FakeBodyPackDelay_ms = nDelay_ms;
+
+		Node nodeD;
+		nodeD.m_Cfg.m_sPathLocal = g_sz2;
+		nodeD.m_Cfg.m_Listen.port(g_Port + 1);
+		nodeD.m_Cfg.m_Listen.ip(INADDR_ANY);
+		nodeD.m_Cfg.m_MiningThreads = 0;
+		nodeD.m_Cfg.m_Treasury = g_Treasury;
+		nodeD.m_Cfg.m_BandwidthCtl.m_MaxBodyPackCount = 8;
+
+		io::Address& addrS = nodeD.m_Cfg.m_Connect.emplace_back();
+		addrS.resolve("127.0.0.1");
+		addrS.port(g_Port);
+
+		if (bFastSync)
+		{
+			nodeD.m_Cfg.m_Horizon.m_Sync.Hi = 10;
+			nodeD.m_Cfg.m_Horizon.m_Sync.Lo = 14;
+			nodeD.m_Cfg.m_Horizon.m_Local = nodeD.m_Cfg.m_Horizon.m_Sync;
+		}
+
+		ECC::SetRandom(nodeD);
+		nodeD.Initialize();
+
+		const char* pPathF[] = { g_sz4, g_sz5 };
+		Node pNodeF[_countof(pPathF)];
+
+		struct MyRunner
+		{
+			std::vector<BlockPlus::Ptr>* m_pChain;
+			Node* m_pS;
+			Node* m_pD;
+			Node* m_pF;
+			const char** m_pPathF;
+			uint32_t m_nF;
+			uint32_t m_nDelay_ms;
+			bool m_bFastSync;
+
+			Waiter m_W;
+			io::Timer::Ptr m_pTimer;
+			uint32_t m_t0_ms;
+			bool m_bSecondary = false;
+
+			void OnTimer()
+			{
+				uint32_t dt_ms = GetTime_ms() - m_t0_ms;
+
+				if (!m_bSecondary)
+				{
+					if (dt_ms < 1000)
+						return; // let D request the first blocks from S
+
+					m_bSecondary = true;
+					for (uint32_t i = 0; i < m_nF; i++)
+						StartSecondary(m_pF[i], m_pPathF[i]);
+				}
+
+				NodeProcessor& pD = m_pD->get_Processor();
+				NodeProcessor& pS = m_pS->get_Processor();
+
+				if (pD.m_Cursor.m_Full.m_Number.v < pS.m_Cursor.m_Full.m_Number.v)
+					return;
+
+				if (dt_ms < m_nDelay_ms + 1000)
+					return; // let the late pack from S arrive too
+
+				verify_test(m_pD->m_nBodyRerequests);
+				verify_test(pD.m_Cursor.m_hh.m_Hash == pS.m_Cursor.m_hh.m_Hash);
+				verify_test(pD.m_Extra.m_Txos == pS.m_Extra.m_Txos); // nothing is applied twice
+
+				if (m_bFastSync)
+					verify_test(!pD.IsFastSync());
+
+				m_pTimer->cancel();
+				m_W.StopSafe(true);
+			}
+
+			void StartSecondary(Node& node, const char* szPath)
+			{
+				node.m_Cfg.m_sPathLocal = szPath;
+				node.m_Cfg.m_MiningThreads = 0;
+				node.m_Cfg.m_Treasury = g_Treasury;
+
+				io::Address& addr = node.m_Cfg.m_Connect.emplace_back();
+				addr.resolve("127.0.0.1");
+				addr.port(g_Port + 1);
+
+				ECC::SetRandom(node);
+				node.Initialize();
+				node.m_PostStartSynced = true;
+
+				NodeProcessor& p = node.get_Processor();
+				for (size_t i = 0; i < m_pChain->size(); i++)
+				{
+					const BlockPlus& bp = *(*m_pChain)[i];
+					p.OnState(bp.m_Hdr, PeerID());
+
+					Block::SystemState::ID id;
+					bp.m_Hdr.get_ID(id);
+					p.OnBlock(id, bp.m_Body.m_Perishable, bp.m_Body.m_Eternal, PeerID());
+				}
+
+				p.TryGoUp();
+				verify_test(p.m_Cursor.m_Full.m_Number.v == m_pChain->size());
+			}
+
+		} r;
+
+		r.m_pChain = &vChain;
+		r.m_pS = &nodeS;
+		r.m_pD = &nodeD;
+		r.m_pF = pNodeF;
+		r.m_pPathF = pPathF;
+		r.m_nF = _countof(pPathF);
+		r.m_nDelay_ms = nDelay_ms;
+		r.m_bFastSync = bFastSync;
+		r.m_t0_ms = GetTime_ms();
+
+		r.m_pTimer = io::Timer::create(*pReactor);
+		r.m_pTimer->start(200, true, [&r]() { r.OnTimer(); });
+
+		verify_test(r.m_W.Wait());
+	}
+
 
 
 }
@@ -4507,6 +5257,7 @@ void TestAll()
 	{
 		beam::TestHalving();
 		beam::TestChainworkProof();
+		beam::TestContractReadCache();
 	}
 
 	// Make sure this test doesn't run in parallel. We have the following potential collisions for Nodes:
@@ -4569,6 +5320,15 @@ void TestAll()
 	r.Shielded.m_ProofMin = { 4, 5 }; // 1K
     r.Evm.Groth2Wei = 10'000'000'000ull;
 
+	if (!bClientProtoOnly)
+	{
+		printf("Contract sigs test...\n");
+		fflush(stdout);
+
+		beam::TestContractSigDeferred();
+		beam::DeleteFile(beam::g_sz);
+	}
+
 	printf("Node <---> Client test (with proofs)...\n");
 	fflush(stdout);
 
@@ -4641,6 +5401,33 @@ void TestAll()
 	beam::TestDependentTxs();
 	beam::DeleteFile(beam::g_sz);
 	beam::DeleteFile(beam::g_sz2);
+
+	printf("Node compact bodies test...\n");
+	fflush(stdout);
+
+	beam::TestCompactBodies();
+	beam::DeleteFile(beam::g_sz);
+	beam::DeleteFile(beam::g_sz2);
+
+	r.MaxRollback = 10; // allow fast-sync on a short chain
+	r.UpdateChecksum();
+
+	for (int iFastSync = 0; iFastSync < 2; iFastSync++)
+	{
+		printf("Node multi-peer sync test%s...\n", iFastSync ? " (fast-sync)" : "");
+		fflush(stdout);
+
+		beam::TestNodeSyncMultiPeer(!!iFastSync);
+
+		const char* pPath[] = { beam::g_sz, beam::g_sz2, beam::g_sz4, beam::g_sz5 };
+		for (size_t i = 0; i < _countof(pPath); i++)
+		{
+			std::string sPath;
+			beam::NodeProcessor::get_MappingPath(sPath, pPath[i]);
+			beam::DeleteFile(sPath.c_str());
+			beam::DeleteFile(pPath[i]);
+		}
+	}
 }
 
 thread_local const beam::Rules* beam::Rules::s_pInstance = nullptr;
@@ -141,6 +141,15 @@ public:
         return _maxMessageTypes;
     }
 
+    /// Size limits for the msg type, false if it's not handled
+    bool get_msg_size_limits(MsgType type, uint32_t& minSize, uint32_t& maxSize) const {
+        if (type >= _maxMessageTypes || !_dispatchTable[type].callback)
+            return false;
+        minSize = _dispatchTable[type].minSize;
+        maxSize = _dispatchTable[type].maxSize;
+        return true;
+    }
+
     /// Called by MsgReader on receiving message header
     bool approve_msg_header(uint64_t fromStream, const MsgHeader& header) {
         ProtocolError error = ProtocolError::no_error;
@@ -84,6 +84,7 @@ namespace beam
         const char* MINING_THREADS = "mining_threads";
         const char* POW_SOLVE_TIME = "pow_solve_time";
         const char* VERIFICATION_THREADS = "verification_threads";
+        const char* IO_THREADS = "io_threads";
         const char* NONCEPREFIX_DIGITS = "nonceprefix_digits";
         const char* NODE_PEER = "peer";
         const char* NODE_PEERS_PERSISTENT = "peers_persistent";
@@ -121,6 +122,7 @@ namespace beam
         const char* CONTRACT_RICH_PARSER = "contract_rich_parser";
         const char* CHECKDB = "check_db";
         const char* VACUUM = "vacuum";
+        const char* BODY_ARCHIVE = "body_archive_segment";
         const char* CRASH = "crash";
         const char* INIT = "init";
         const char* RESTORE = "restore";
@@ -186,11 +188,13 @@ namespace beam
         const char* EXPORT_DATA = "export_data";
         const char* IMPORT_DATA = "import_data";
         const char* IMPORT_EXPORT_PATH = "file_location";
+        const char* IMPORT_RECOVERY_DELTAS = "recovery_deltas";
         const char* IP_WHITELIST = "ip_whitelist";
         const char* FAST_SYNC = "fast_sync";
         const char* GENERATE_RECOVERY_PATH = "generate_recovery";
         const char* RECOVERY_AUTO_PATH = "recovery_auto_path";
         const char* RECOVERY_AUTO_PERIOD = "recovery_auto_period";
+        const char* RECOVERY_AUTO_DELTAS = "recovery_auto_deltas";
         const char* SWAP_INIT = "swap_init";
         const char* SWAP_ACCEPT = "swap_accept";
         const char* SWAP_TOKEN = "swap_token";
@@ -403,6 +407,7 @@ namespace beam
             (cli::POW_SOLVE_TIME, po::value<uint32_t>()->default_value(15 * 1000), "pow solve time. It works if FakePoW is enabled")
 
             (cli::VERIFICATION_THREADS, po::value<int>()->default_value(-1), "number of threads for cryptographic verifications (0 = single thread, -1 = auto)")
+            (cli::IO_THREADS, po::value<uint32_t>()->default_value(0), "number of I/O threads serving inbound connections (0 = serve them in the node thread)")
             (cli::NONCEPREFIX_DIGITS, po::value<unsigned>()->default_value(0), "number of hex digits for nonce prefix for stratum client (0..6)")
             (cli::NODE_PEER, po::value<vector<string>>()->multitoken(), "nodes to connect to")
             (cli::NODE_PEERS_PERSISTENT, po::value<bool>()->default_value(false), "Keep persistent connection to the specified peers, regardless to ratings")
@@ -423,6 +428,7 @@ namespace beam
             (cli::MANUAL_SELECT, po::value<std::string>(), "Explicit correct block selection at the specified height. Auto-rollback below this height if current branch is different")
             (cli::CHECKDB, po::value<bool>()->default_value(false), "DB integrity check")
             (cli::VACUUM, po::value<bool>()->default_value(false), "DB vacuum (compact)")
+            (cli::BODY_ARCHIVE, po::value<uint32_t>()->default_value(0), "move the bodies of old blocks out of the DB into archive files of this max size (MB). 0 - disabled")
             (cli::BBS_ENABLE, po::value<bool>()->default_value(true), "Enable SBBS messaging")
             (cli::CRASH, po::value<int>()->default_value(0), "Induce crash (test proper handling)")
             (cli::OWNER_KEY, po::value<string>(), "Owner viewer key")
@@ -441,6 +447,7 @@ namespace beam
             (cli::GENERATE_RECOVERY_PATH, po::value<string>(), "Recovery file to generate immediately after start")
             (cli::RECOVERY_AUTO_PATH, po::value<string>(), "path and file prefix for recovery auto-generation")
             (cli::RECOVERY_AUTO_PERIOD, po::value<uint32_t>()->default_value(30), "period (in blocks) for recovery auto-generation")
+            (cli::RECOVERY_AUTO_DELTAS, po::value<uint32_t>()->default_value(0), "number of incremental recovery deltas generated between the full recovery files")
             (cli::CONTRACT_RICH_INFO, po::value<bool>(), "Set to save rich contract invocation info")
             (cli::CONTRACT_RICH_PARSER, po::value<std::string>(), "Optional shader to parse contract invocation info")
 
@@ -478,6 +485,7 @@ namespace beam
             (cli::HID_INSTALL_FILE, po::value<string>(), "App image file to install on HID device. If not specified - integrated image will be used")
             (cli::UTXO, po::value<vector<string>>()->multitoken(), "set IDs of specific UTXO to send")
             (cli::IMPORT_EXPORT_PATH, po::value<string>()->default_value("export.dat"), "path to import or export wallet data (should be used with import_data|export_data)")
+            (cli::IMPORT_RECOVERY_DELTAS, po::value<vector<string>>()->multitoken(), "recovery delta files, applied in order on top of the recovery file (should be used with import_recovery)")
             (cli::IGNORE_DICTIONARY, "ignore dictionary for a specific seed phrase validation")
             (cli::NODE_POLL_PERIOD, po::value<Nonnegative<uint32_t>>()->default_value(Nonnegative<uint32_t>(0)), "node poll period in milliseconds. Set to 0 to keep connection forever. Poll period would be no shorter than the expected rate of blocks if it is less then it will be rounded up to block rate value.")
             (cli::PROXY_USE, po::value<bool>()->default_value(false), "use socks5 proxy server for node connection")
@@ -48,6 +48,7 @@ namespace beam
         extern const char* MINING_THREADS;
         extern const char* POW_SOLVE_TIME;
         extern const char* VERIFICATION_THREADS;
+        extern const char* IO_THREADS;
         extern const char* NONCEPREFIX_DIGITS;
         extern const char* NODE_PEER;
         extern const char* NODE_PEERS_PERSISTENT;
@@ -87,6 +88,7 @@ namespace beam
         extern const char* CONTRACT_RICH_PARSER;
         extern const char* CHECKDB;
         extern const char* VACUUM;
+        extern const char* BODY_ARCHIVE;
         extern const char* CRASH;
         extern const char* INIT;
         extern const char* RESTORE;
@@ -154,11 +156,13 @@ namespace beam
         extern const char* IMPORT_ADDRESSES;
         extern const char* IMPORT_DATA;
         extern const char* IMPORT_EXPORT_PATH;
+        extern const char* IMPORT_RECOVERY_DELTAS;
         extern const char* IP_WHITELIST;
         extern const char* FAST_SYNC;
         extern const char* GENERATE_RECOVERY_PATH;
         extern const char* RECOVERY_AUTO_PATH;
         extern const char* RECOVERY_AUTO_PERIOD;
+        extern const char* RECOVERY_AUTO_DELTAS;
         extern const char* SWAP_INIT;
         extern const char* SWAP_ACCEPT;
         extern const char* SWAP_TOKEN;
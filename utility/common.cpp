@@ -42,6 +42,95 @@ void memxor(uint8_t* pDst, const uint8_t* pSrc, size_t n)
 
 namespace beam
 {
+	namespace
+	{
+		struct ObjectPoolTls
+		{
+			static const uint32_t s_Granularity = 16;
+			static const uint32_t s_Classes = 64; // up to 1K
+			static const uint32_t s_MaxCachedBytes = 0x10000; // per class, bounds the memory kept by each thread
+
+			static uint32_t get_MaxCached(uint32_t iClass)
+			{
+				return s_MaxCachedBytes / ((iClass + 1) * s_Granularity);
+			}
+
+			struct Node {
+				Node* m_pNext;
+			};
+
+			Node* m_ppHead[s_Classes] = { };
+			uint32_t m_pCount[s_Classes] = { };
+
+			static thread_local bool s_Dead;
+
+			static uint32_t get_Class(size_t n)
+			{
+				return n ? static_cast<uint32_t>((n - 1) / s_Granularity) : 0;
+			}
+
+			~ObjectPoolTls()
+			{
+				s_Dead = true;
+				for (uint32_t i = 0; i < s_Classes; i++)
+				{
+					while (m_ppHead[i])
+					{
+						Node* p = m_ppHead[i];
+						m_ppHead[i] = p->m_pNext;
+						::operator delete(p);
+					}
+				}
+			}
+		};
+
+		thread_local bool ObjectPoolTls::s_Dead = false;
+		thread_local ObjectPoolTls g_ObjectPool;
+	}
+
+	void* ObjectPool::Alloc(size_t n)
+	{
+		uint32_t iClass = ObjectPoolTls::get_Class(n);
+		if (iClass >= ObjectPoolTls::s_Classes)
+			return ::operator new(n);
+
+		// Always round-up, so that it can be reused for any object of this class.
+		// Even if this thread's pool is already gone, the block may be freed into the pool of another thread
+		const size_t nSize = (iClass + 1) * ObjectPoolTls::s_Granularity;
+		if (ObjectPoolTls::s_Dead)
+			return ::operator new(nSize);
+
+		ObjectPoolTls& x = g_ObjectPool;
+		ObjectPoolTls::Node* p = x.m_ppHead[iClass];
+		if (!p)
+			return ::operator new(nSize);
+
+		x.m_ppHead[iClass] = p->m_pNext;
+		x.m_pCount[iClass]--;
+		return p;
+	}
+
+	void ObjectPool::Free(void* p, size_t n)
+	{
+		if (!p)
+			return;
+
+		uint32_t iClass = ObjectPoolTls::get_Class(n);
+		if ((iClass < ObjectPoolTls::s_Classes) && !ObjectPoolTls::s_Dead)
+		{
+			ObjectPoolTls& x = g_ObjectPool;
+			if (x.m_pCount[iClass] < ObjectPoolTls::get_MaxCached(iClass))
+			{
+				auto* pNode = static_cast<ObjectPoolTls::Node*>(p);
+				pNode->m_pNext = x.m_ppHead[iClass];
+				x.m_ppHead[iClass] = pNode;
+				x.m_pCount[iClass]++;
+				return;
+			}
+		}
+
+		::operator delete(p);
+	}
 
 #ifdef WIN32
 
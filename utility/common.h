@@ -200,6 +200,19 @@ namespace beam
 		COMPARISON_VIA_CMP
 	};
 
+	// Thread-local recycling of small heap objects that are allocated/freed in bulk (block elements, proofs).
+	// Freed blocks are kept in per-size free lists of the freeing thread, and reused by subsequent allocations,
+	// so that deserializing a block mostly reuses the memory released by the previous one.
+	struct ObjectPool
+	{
+		static void* Alloc(size_t);
+		static void Free(void*, size_t);
+	};
+
+#define BEAM_POOLED_ALLOC \
+	static void* operator new(size_t n) { return beam::ObjectPool::Alloc(n); } \
+	static void operator delete(void* p, size_t n) { beam::ObjectPool::Free(p, n); }
+
 	template <typename T>
 	struct TemporarySwap
 	{
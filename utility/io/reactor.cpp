@@ -23,6 +23,7 @@
 
 #ifndef WIN32
 #include <csignal>
+#include <unistd.h>
 #endif // WIN32
 
 #ifndef LOG_VERBOSE_ENABLED
@@ -700,6 +701,29 @@ Result Reactor::tcp_connect_with_proxy(
     return res;
 }
 
+Result Reactor::tcp_import(uv_os_sock_t s, std::unique_ptr<TcpStream>& newStream) {
+    uv_handle_t* h = _handlePool.alloc();
+    ErrorCode errorCode = (ErrorCode)uv_tcp_init(&_loop, (uv_tcp_t*)h);
+    if (errorCode == 0) {
+        errorCode = (ErrorCode)uv_tcp_open((uv_tcp_t*)h, s);
+        if (errorCode == 0) {
+            newStream.reset(stream_connected(new TcpStream(), h));
+            return Ok();
+        }
+        async_close(h);
+    }
+    else {
+        _handlePool.release(h);
+    }
+
+#ifdef WIN32
+    closesocket(s);
+#else // WIN32
+    close(s);
+#endif // WIN32
+    return make_unexpected(errorCode);
+}
+
 void Reactor::cancel_tcp_connect(uint64_t tag) {
     _tcpConnectors->cancel_tcp_connect(tag);
     _proxyConnector->cancel_connection(tag);
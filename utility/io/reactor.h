@@ -94,6 +94,10 @@ public:
 
     void cancel_tcp_connect(uint64_t tag);
 
+    /// Attaches the socket exported from another reactor (see TcpStream::export_socket). Takes ownership of the socket.
+    /// NOTE: Must be called from the reactor's thread
+    Result tcp_import(uv_os_sock_t s, std::unique_ptr<TcpStream>& newStream);
+
 	class Scope
 	{
 		Reactor* m_pPrev;
@@ -195,6 +199,7 @@ private:
     uv_loop_t _loop;
     uv_async_t _stopEvent;
     MemPool<uv_handle_t, sizeof(Handles)> _handlePool;
+    std::vector<char> _readBuffer; // shared by the streams, allocated on the first read. See TcpStream::enable_read()
     bool _creatingInternalObjects=false;
 
     std::unique_ptr<PendingWrites> _pendingWrites;
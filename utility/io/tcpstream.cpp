@@ -16,6 +16,11 @@
 #include "utility/config.h"
 #include "utility/helpers.h"
 #include <assert.h>
+#include <errno.h>
+
+#ifndef WIN32
+#include <unistd.h>
+#endif // WIN32
 
 #define LOG_DEBUG_ENABLED 0
 #include "utility/logger.h"
@@ -31,21 +36,6 @@ TcpStream::~TcpStream() {
     if (_handle) _handle->data = 0;
 }
 
-void TcpStream::alloc_read_buffer() {
-    if (!_readBuffer.base) {
-        if (_readBuffer.len == 0) {
-            _readBuffer.len = config().get_int("io.stream_read_buffer_size", 256*1024, 2048, 1024*1024*16);
-        }
-        _readBuffer.base = (char*)malloc(_readBuffer.len);
-    }
-}
-
-void TcpStream::free_read_buffer() {
-    if (_readBuffer.base) free(_readBuffer.base);
-    _readBuffer.base = 0;
-    _readBuffer.len = 0;
-}
-
 Result TcpStream::enable_read(const TcpStream::Callback& callback) {
     assert(callback);
 
@@ -53,23 +43,24 @@ Result TcpStream::enable_read(const TcpStream::Callback& callback) {
         return make_unexpected(EC_ENOTCONN);
     }
 
-    alloc_read_buffer();
-
+    // All the streams of the reactor read into the same buffer: libuv calls alloc, reads and calls read_cb
+    // synchronously for one stream at a time, and the data is consumed in the callback
     static uv_alloc_cb read_alloc_cb = [](
         uv_handle_t* handle,
         size_t /*suggested_size*/,
         uv_buf_t* buf
     ) {
-        TcpStream* self = reinterpret_cast<TcpStream*>(handle->data);
-        if (self) {
-            *buf = self->_readBuffer;
+        std::vector<char>& v = reinterpret_cast<Reactor*>(handle->loop->data)->_readBuffer;
+        if (v.empty()) {
+            v.resize(config().get_int("io.stream_read_buffer_size", 256*1024, 2048, 1024*1024*16));
         }
+        buf->base = v.data();
+        buf->len = v.size();
     };
 
     ErrorCode errorCode = (ErrorCode)uv_read_start((uv_stream_t*)_handle, read_alloc_cb, read_cb);
     if (errorCode != 0) {
         _callback = Callback();
-        free_read_buffer();
         return make_unexpected(errorCode);
     }
 
@@ -85,7 +76,6 @@ void TcpStream::disable_read() {
             BEAM_LOG_DEBUG() << "uv_read_stop failed,code=" << errorCode;
         }
     }
-    free_read_buffer();
 }
 
 Result TcpStream::write(const SharedBuffer& buf, bool flush) {
@@ -127,6 +117,25 @@ void TcpStream::enable_keepalive(unsigned initialDelaySecs) {
     }
 }
 
+Result TcpStream::export_socket(uv_os_sock_t& s) {
+    if (!is_connected()) return make_unexpected(EC_ENOTCONN);
+#ifdef WIN32
+    (void) s;
+    return make_unexpected(EC_ENOTSUP);
+#else
+    uv_os_fd_t fd;
+    ErrorCode errorCode = (ErrorCode)uv_fileno(_handle, &fd);
+    if (errorCode != 0) return make_unexpected(errorCode);
+
+    s = dup(fd);
+    if (s < 0) return make_unexpected((ErrorCode)uv_translate_sys_error(errno));
+
+    disable_read();
+    async_close();
+    return Ok();
+#endif // WIN32
+}
+
 Result TcpStream::do_write(bool flush) {
     size_t nBytes = _writeBuffer.size();
     if (flush && nBytes > 0) {
@@ -28,7 +28,7 @@ public:
     // 1) call back with sub-chunk of shared memory
     // 2) embed deserializer (protocol-specific) object into stream
 
-    /// errorCode==0 on new data
+    /// errorCode==0 on new data. The data is valid only during the call: the read buffer is shared by the reactor streams
     using Callback = std::function<bool(ErrorCode errorCode, void* data, size_t size)>;
 
     struct State {
@@ -80,6 +80,10 @@ public:
     /// Enables tcp keep-alive
     void enable_keepalive(unsigned initialDelaySecs);
 
+    /// Detaches the socket (duplicated) and closes the stream, so that it can be attached to another reactor.
+    /// See Reactor::tcp_import(). Not supported on Windows
+    Result export_socket(uv_os_sock_t& s);
+
 protected:
     TcpStream();
 
@@ -94,16 +98,12 @@ private:
     friend class Reactor;
     friend class TcpConnectors;
 
-    void alloc_read_buffer();
-    void free_read_buffer();
-
     // sends async write request if flush == true
     Result do_write(bool flush);
 
     // callback from write request
     void on_data_written(ErrorCode errorCode, size_t n);
 
-    uv_buf_t _readBuffer={0, 0};
     BufferChain _writeBuffer;
     Callback _callback;
     State _state;
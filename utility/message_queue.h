@@ -14,64 +14,115 @@
 
 #pragma once
 #include "io/asyncevent.h"
-#include <mutex>
-#include <deque>
+#include <atomic>
 #include <assert.h>
 
 namespace beam {
 
 /// Inter-thread message queue, backend for RX and TX sides (see below)
-/// Current impl (may be changed if performance bottleneck detected):
+/// Current impl:
 /// 1) unlimited size - should be controlled by channel sides explicitly;
-/// 2) std::deque and std::mutex inside
+/// 2) lock-free intrusive MPSC list (D.Vyukov): any number of TX threads, single RX (reactor) thread.
+///    Senders do a single atomic exchange, the receiver doesn't touch shared state except the node links;
+/// 3) wakeups are coalesced: only the first message after the receiver started draining signals the async event
 /// Message type (class T) requirement: default constructible + callable *or* movable (see send() functions)
 template <class T> class MessageQueue {
 public:
+    MessageQueue() :
+        _head(&_stub),
+        _tail(&_stub)
+    {}
+
+    ~MessageQueue() {
+        T msg;
+        while (receive(msg))
+            ;
+        if (_tail != &_stub)
+            delete _tail;
+    }
+
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator = (const MessageQueue&) = delete;
+
     /// Called from sender thread via TX object
     bool send(const T& message) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_rxClosed) return false;
-        _queue.push_back(message);
+        if (_rxClosed.load(std::memory_order_relaxed)) return false;
+        push(new Node(message));
         return true;
     }
 
     /// Called from sender thread via TX object
     bool send(T&& message) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_rxClosed) return false;
-        _queue.push_back(std::move(message));
+        if (_rxClosed.load(std::memory_order_relaxed)) return false;
+        push(new Node(std::move(message)));
         return true;
     }
 
-    /// May be called by both TX and RX
-    size_t current_size() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _queue.size();
+    /// May be called by both TX and RX. Approximate while senders are active
+    size_t current_size() const {
+        return _size.load(std::memory_order_relaxed);
     }
 
     /// Called from receiver thread via RX object
     bool receive(T& message) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_queue.empty()) return false;
-        message = std::move(_queue.front());
-        _queue.pop_front();
+        Node* pTail = _tail;
+        Node* pNext = pTail->_next.load(std::memory_order_acquire);
+        if (!pNext) return false; // empty, or a sender is in the middle of push(). It'll signal anyway
+
+        // pNext becomes the new stub, its payload is consumed
+        message = std::move(pNext->_msg);
+        _tail = pNext;
+        if (pTail != &_stub)
+            delete pTail;
+
+        _size.fetch_sub(1, std::memory_order_relaxed);
         return true;
     }
 
+    /// Called from sender thread after a successful send(). Returns true if the receiver should be woken up
+    bool set_signaled() {
+        return !_signaled.exchange(true, std::memory_order_acq_rel);
+    }
+
+    /// Called from receiver thread before draining the queue.
+    /// Must be an RMW: it's ordered with the senders' exchange in set_signaled(), so either the sender sees the flag cleared
+    /// and signals again, or this exchange reads its 'true' and synchronizes with it, i.e. the subsequent drain sees its node.
+    /// A plain store would leave a store-buffer race on weak memory models (lost wakeup)
+    void reset_signaled() {
+        _signaled.exchange(false, std::memory_order_acq_rel);
+    }
+
     /// Called by RX to indicate that the channel is being closed
     void close_rx() {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _rxClosed = true;
+        _rxClosed.store(true, std::memory_order_relaxed);
     }
 
 private:
-    std::mutex _mutex;
-    // TODO consider spinlock
+    struct Node {
+        std::atomic<Node*> _next;
+        T _msg;
 
-    std::deque<T> _queue;
+        Node() : _next(nullptr) {}
+        explicit Node(const T& msg) : _next(nullptr), _msg(msg) {}
+        explicit Node(T&& msg) : _next(nullptr), _msg(std::move(msg)) {}
+    };
+
+    void push(Node* pNode) {
+        _size.fetch_add(1, std::memory_order_relaxed);
+        Node* pPrev = _head.exchange(pNode, std::memory_order_acq_rel);
+        pPrev->_next.store(pNode, std::memory_order_release);
+    }
 
-    bool _rxClosed=false;
-    // TODO consider atomic flag
+    Node _stub;
+
+    // senders side
+    alignas(64) std::atomic<Node*> _head;
+    std::atomic<size_t> _size{0};
+    std::atomic<bool> _signaled{false};
+    std::atomic<bool> _rxClosed{false};
+
+    // receiver side
+    alignas(64) Node* _tail;
 };
 
 /// Transmitter side of inter-thread channel
@@ -79,20 +130,25 @@ template <class T> class TX {
 public:
 
     bool send(const T& message) {
-        return _queue->send(message) && _asyncEvent();
+        return _queue->send(message) && signal();
     }
 
     bool send(T&& message) {
-        return _queue->send(std::move(message)) && _asyncEvent();
+        return _queue->send(std::move(message)) && signal();
     }
 
     size_t queue_size() {
-        return _queue.current_size();
+        return _queue->current_size();
     }
 
 private:
     template <class> friend class RX; // friend because RX creates TX-es
 
+    /// Posts the async event only if the receiver isn't signaled yet
+    bool signal() {
+        return !_queue->set_signaled() || _asyncEvent();
+    }
+
     /// Ctor called by RX, see friendship
     TX(const std::shared_ptr<MessageQueue<T>>& queue, const io::AsyncEvent::Ptr& asyncEvent) :
         _queue(queue), _asyncEvent(asyncEvent)
@@ -132,7 +188,7 @@ public:
     }
 
     size_t queue_size() {
-        return _queue.current_size();
+        return _queue->current_size();
     }
 
     void close() {
@@ -141,6 +197,9 @@ public:
 
 private:
     void on_receive() {
+        // reset before draining, so that a message pushed after the drain is guaranteed to signal again.
+        // The drain that follows the reset is the re-check: anything published before it is received here
+        _queue->reset_signaled();
         T _msg;
         while (_queue->receive(_msg)) {
             _callback(std::move(_msg));
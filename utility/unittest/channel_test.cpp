@@ -15,6 +15,8 @@
 #include "utility/message_queue.h"
 #include <future>
 #include <iostream>
+#include <thread>
+#include <chrono>
 #include <assert.h>
 
 using namespace std;
@@ -88,7 +90,102 @@ void simplex_channel_test() {
     assert(remote.received == sent);
 }
 
+struct StampedMessage {
+    uint32_t iSender = 0;
+    uint32_t n = 0;
+    std::chrono::steady_clock::time_point t;
+};
+
+void multi_producer_channel_test() {
+    const uint32_t nSenders = 4;
+    const uint32_t nPerSender = 250000;
+
+    SomeAsyncObject remote;
+    std::vector<uint32_t> lastReceived(nSenders, 0);
+    uint32_t nReceived = 0;
+    bool bOrderOk = true;
+
+    RX<StampedMessage> rx(
+        *remote.reactor,
+        [&](StampedMessage&& msg) {
+            // per-sender order must be preserved
+            if (msg.n != lastReceived[msg.iSender] + 1) {
+                bOrderOk = false;
+            }
+            lastReceived[msg.iSender] = msg.n;
+            if (++nReceived == nSenders * nPerSender) {
+                remote.reactor->stop();
+            }
+        }
+    );
+
+    remote.run();
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> senders;
+    for (uint32_t i = 0; i < nSenders; ++i) {
+        senders.emplace_back([&rx, i]() {
+            TX<StampedMessage> tx = rx.get_tx();
+            for (uint32_t n = 1; n <= nPerSender; ++n) {
+                tx.send(StampedMessage{ i, n, {} });
+            }
+        });
+    }
+
+    for (auto& t : senders) {
+        t.join();
+    }
+
+    remote.wait();
+
+    auto dt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+
+    assert(bOrderOk);
+    assert(nReceived == nSenders * nPerSender);
+
+    cout << "Channel throughput: " << nSenders << " senders, " << nReceived << " msgs in " << dt / 1000 << " ms, "
+        << (dt ? (uint64_t(nReceived) * 1000000 / dt) : 0) << " msgs/sec" << endl;
+}
+
+void wakeup_latency_test() {
+    const uint32_t nRounds = 200;
+
+    SomeAsyncObject remote;
+    uint64_t nTotal_us = 0, nMax_us = 0;
+    uint32_t nReceived = 0;
+
+    RX<StampedMessage> rx(
+        *remote.reactor,
+        [&](StampedMessage&& msg) {
+            uint64_t dt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - msg.t).count();
+            nTotal_us += dt;
+            nMax_us = std::max(nMax_us, dt);
+            if (++nReceived == nRounds) {
+                remote.reactor->stop();
+            }
+        }
+    );
+
+    remote.run();
+
+    TX<StampedMessage> tx = rx.get_tx();
+    for (uint32_t n = 1; n <= nRounds; ++n) {
+        // let the receiver go idle, so that each message needs a wakeup
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        tx.send(StampedMessage{ 0, n, std::chrono::steady_clock::now() });
+    }
+
+    remote.wait();
+
+    assert(nReceived == nRounds);
+
+    cout << "Channel wakeup latency: avg " << nTotal_us / nRounds << " us, max " << nMax_us << " us" << endl;
+}
+
 int main() {
     simplex_channel_test();
+    multi_producer_channel_test();
+    wakeup_latency_test();
 }
 
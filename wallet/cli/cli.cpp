@@ -2998,10 +2998,15 @@ namespace
             }
         };
         auto path = vm[cli::IMPORT_EXPORT_PATH].as<string>();
-        return DoWalletFunc(vm, [&path](auto&& vm, auto&& wallet, auto&& walletDB, auto& currentTxID)
+
+        std::vector<std::string> vDeltas;
+        if (vm.count(cli::IMPORT_RECOVERY_DELTAS))
+            vDeltas = vm[cli::IMPORT_RECOVERY_DELTAS].as<std::vector<std::string>>();
+
+        return DoWalletFunc(vm, [&path, &vDeltas](auto&& vm, auto&& wallet, auto&& walletDB, auto& currentTxID)
             {
                 MyProgress progress;
-                walletDB->ImportRecovery(path, *wallet, progress);
+                walletDB->ImportRecovery(path, vDeltas, *wallet, progress);
                 return 1;
             });
     }
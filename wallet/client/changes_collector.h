@@ -17,21 +17,26 @@
 namespace beam::wallet
 {
 
+    // Coalesces the change notifications into per-ID diffs, flushed at most once per flush interval.
+    // Under a sustained load (sync, restore) the consumers get few large batches instead of a flood of small ones.
+    // Reset is a snapshot: it supersedes the pending changes and is delivered immediately.
     template<typename T, typename KeyFunc>
     class ChangesCollector
     {
         using FlushFunc = std::function<void(ChangeAction, const std::vector<T>&)>;
+        using Key = typename std::decay<typename KeyFunc::type>::type;
 
-        struct Comparator
+        struct Entry
         {
-            bool operator()(const T& left, const T& right) const
-            {
-                return KeyFunc()(left) < KeyFunc()(right);
-            }
+            ChangeAction m_Action;
+            T m_Item;
         };
 
-        using ItemsList = std::set<T, Comparator>;
+        using ItemsMap = std::map<Key, Entry>;
     public:
+        static const uint32_t s_FlushInterval_ms = 100;
+        static const size_t s_MaxBacklogFactor = 32; // hard limit on pending changes, in buffer sizes
+
         ChangesCollector(size_t bufferSize, io::Reactor::Ptr reactor, FlushFunc&& flushFunc)
             : m_BufferSize(bufferSize)
             , m_FlushTimer(io::Timer::create(*reactor))
@@ -43,10 +48,10 @@ namespace beam::wallet
         {
             if (action == ChangeAction::Reset)
             {
-                m_NewItems.clear();
-                m_UpdatedItems.clear();
-                m_RemovedItems.clear();
+                m_Items.clear();
+                CancelTimer();
                 m_FlushFunc(action, items);
+                m_LastFlush_ms = GetTime_ms();
                 return;
             }
 
@@ -54,124 +59,135 @@ namespace beam::wallet
             {
                 CollectItem(action, item);
             }
+
+            if (m_Items.size() > m_BufferSize)
+            {
+                // backpressure: don't flush more often than the interval, unless the backlog is too big
+                if ((GetTime_ms() - m_LastFlush_ms >= s_FlushInterval_ms) || (m_Items.size() > m_BufferSize * s_MaxBacklogFactor))
+                {
+                    Flush();
+                }
+            }
         }
 
         void Flush()
         {
-            Flush(ChangeAction::Added, m_NewItems);
-            Flush(ChangeAction::Updated, m_UpdatedItems);
-            Flush(ChangeAction::Removed, m_RemovedItems);
-        }
-
-    private:
+            CancelTimer();
+            m_LastFlush_ms = GetTime_ms();
 
-        void CollectItem(ChangeAction action, const T& item)
-        {
-            m_FlushTimer->cancel();
-            m_FlushTimer->start(100, false, [this]() { Flush(); });
-            switch (action)
+            if (m_Items.empty())
             {
-            case ChangeAction::Added:
-                AddItem(item);
-                break;
-            case ChangeAction::Updated:
-                UpdateItem(item);
-                break;
-            case ChangeAction::Removed:
-                RemoveItem(item);
-                break;
-            default:
-                break;
+                return;
             }
 
-            if (GetChangesCount() > m_BufferSize)
+            std::vector<T> vAdded, vUpdated, vRemoved;
+            for (auto& [key, entry] : m_Items)
             {
-                Flush();
+                switch (entry.m_Action)
+                {
+                case ChangeAction::Added:
+                    vAdded.push_back(std::move(entry.m_Item));
+                    break;
+                case ChangeAction::Updated:
+                    vUpdated.push_back(std::move(entry.m_Item));
+                    break;
+                default:
+                    vRemoved.push_back(std::move(entry.m_Item));
+                }
             }
-        }
+            m_Items.clear();
 
-        void Flush(ChangeAction action, ItemsList& items)
-        {
-            if (!items.empty())
-            {
-                m_FlushFunc(action, std::vector<T>(items.begin(), items.end()));
-                items.clear();
-            }
+            Flush(ChangeAction::Added, vAdded);
+            Flush(ChangeAction::Updated, vUpdated);
+            Flush(ChangeAction::Removed, vRemoved);
         }
 
-        size_t GetChangesCount() const
+        size_t GetPendingCount() const
         {
-            return m_NewItems.size() + m_UpdatedItems.size() + m_RemovedItems.size();
+            return m_Items.size();
         }
 
-        void AddItem(const T& item)
+    private:
+
+        void CollectItem(ChangeAction action, const T& item)
         {
-            // if it was removed do nothing
-            if (m_RemovedItems.find(item) != m_RemovedItems.end())
+            if ((ChangeAction::Added != action) && (ChangeAction::Updated != action) && (ChangeAction::Removed != action))
             {
                 return;
             }
-            m_NewItems.insert(item);
-        }
 
-        void UpdateItem(const T& item)
-        {
-            // if it was removed do nothing
-            if (m_RemovedItems.find(item) != m_RemovedItems.end())
+            if (!m_TimerArmed)
+            {
+                // armed once per batch, so that the flush latency is bounded under a continuous stream of changes
+                m_TimerArmed = true;
+                m_FlushTimer->start(s_FlushInterval_ms, false, [this]() { m_TimerArmed = false; Flush(); });
+            }
+
+            auto [it, isNew] = m_Items.try_emplace(KeyFunc()(item), Entry{ action, item });
+            if (isNew)
             {
                 return;
             }
-            // if it is not in new add it to updated
-            auto it = m_NewItems.find(item);
-            if (it == m_NewItems.end())
+
+            Entry& entry = it->second;
+            switch (action)
             {
-                auto p = m_UpdatedItems.insert(item);
-                if (p.second == false)
+            case ChangeAction::Added:
+                if (ChangeAction::Removed == entry.m_Action)
                 {
-                    UpdateItemValue(item, p.first, m_UpdatedItems);
+                    // was removed and re-added, the consumer still has it
+                    entry.m_Action = ChangeAction::Updated;
+                }
+                entry.m_Item = item;
+                break;
+
+            case ChangeAction::Updated:
+                // if it was removed do nothing, otherwise keep the action and take the latest value
+                if (ChangeAction::Removed != entry.m_Action)
+                {
+                    entry.m_Item = item;
+                }
+                break;
+
+            default: // Removed
+                if (ChangeAction::Added == entry.m_Action)
+                {
+                    // the consumer never saw it
+                    m_Items.erase(it);
+                }
+                else
+                {
+                    entry.m_Action = ChangeAction::Removed;
+                    entry.m_Item = item;
                 }
-            }
-            else
-            {
-                UpdateItemValue(item, it, m_NewItems);
             }
         }
 
-        void RemoveItem(const T& item)
+        void CancelTimer()
         {
-            // if it is in new erase it
-            if (auto it = m_NewItems.find(item); it != m_NewItems.end())
+            if (m_TimerArmed)
             {
-                m_NewItems.erase(it);
-                return;
-            }
-            // else if it is in updated remove and add to removed
-            if (auto it = m_UpdatedItems.find(item); it != m_UpdatedItems.end())
-            {
-                m_UpdatedItems.erase(it);
+                m_TimerArmed = false;
+                m_FlushTimer->cancel();
             }
-            // add to removed
-            m_RemovedItems.insert(item);
         }
 
-        void UpdateItemValue(const T& item, typename ItemsList::iterator& it, ItemsList& items)
+        void Flush(ChangeAction action, const std::vector<T>& items)
         {
-            // MacOS doesn't support 'extract'
-            //auto node = items.extract(it);
-            //node.value() = item;
-            //items.insert(std::move(node));
-            items.erase(it);
-            items.insert(item);
+            if (!items.empty())
+            {
+                m_FlushFunc(action, items);
+            }
         }
 
     private:
         size_t m_BufferSize;
         io::Timer::Ptr m_FlushTimer;
         FlushFunc m_FlushFunc;
+        bool m_TimerArmed = false;
+        uint32_t m_LastFlush_ms = 0;
 
-        ItemsList m_NewItems;
-        ItemsList m_UpdatedItems;
-        ItemsList m_RemovedItems;
+        ItemsMap m_Items;
     };
 
 } // namespace beam::wallet
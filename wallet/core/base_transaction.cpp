@@ -176,6 +176,7 @@ namespace beam::wallet
     void BaseTransaction::Update()
     {
         AsyncContextHolder async(m_Context.GetGateway());
+        IWalletDB::WriteBatch batch(*GetWalletDB());
         try
         {
             m_EventToUpdate.reset();
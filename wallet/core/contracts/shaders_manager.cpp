@@ -37,6 +37,8 @@ namespace beam::wallet {
 
         m_pNetwork = wallet.GetNodeEndpoint();
         assert(m_pNetwork);
+
+        m_pReadCache = &ReadCache::get_Global();
     }
 
     ManagerStdInWallet::~ManagerStdInWallet()
@@ -423,6 +425,12 @@ namespace beam::wallet {
             BEAM_LOG_VERBOSE () << "Shader result: " << std::string_view(result ? *result : std::string()).substr(0, 200);
         }
 
+        if (m_pReadCache)
+        {
+            auto stats = m_pReadCache->get_Stats();
+            BEAM_LOG_DEBUG() << "Shader read cache: hits " << stats.m_Hits << ", misses " << stats.m_Misses << " (" << stats.get_HitRate_pc() << "%), entries " << stats.m_Entries << ", bytes " << stats.m_Bytes;
+        }
+
         if (m_InvokeData.m_vec.empty())
         {
             if (req.doneAll)
@@ -526,6 +526,7 @@ namespace beam::wallet
         if (bSynced)
         {
             AsyncContextHolder holder(*this);
+            IWalletDB::WriteBatch batch(*m_WalletDB);
             action();
         }
         else
@@ -1661,15 +1662,13 @@ namespace beam::wallet
             {
                 RequestBodies(r.m_Msg.m_Block0.v, startHeight + r.m_Res.m_Bodies.size());
             }
-            for (const auto& b : r.m_Res.m_Bodies)
-            {
-                ProcessBody(b, startHeight, recognizer);
+            ProcessBodyPack(r.m_Res.m_Bodies, startHeight, recognizer);
+            startHeight += r.m_Res.m_Bodies.size();
 
-                ++startHeight;
-            }
             assert(GetEventsHeightNext() == startHeight);
 
             m_WalletDB->set_ShieldedOuts(m_Extra.m_ShieldedOutputs);
+            ReportBodyScanProgress();
         }
         catch (const std::exception&)
         {
@@ -1717,9 +1716,8 @@ namespace beam::wallet
         }
     }
 
-    void Wallet::ProcessBody(const proto::BodyBuffers& b, Height h, NodeProcessor::Recognizer& recognizer)
+    void Wallet::DecodeBody(const proto::BodyBuffers& b, Height h, Block::Body& block)
     {
-        Block::Body block;
         Deserializer der;
         der.reset(b.m_Perishable);
 
@@ -1739,6 +1737,12 @@ namespace beam::wallet
 
         der.reset(b.m_Eternal);
         der & Cast::Down<TxVectors::Eternal>(block);
+    }
+
+    void Wallet::ProcessBody(const proto::BodyBuffers& b, Height h, NodeProcessor::Recognizer& recognizer)
+    {
+        Block::Body block;
+        DecodeBody(b, h, block);
         PreprocessBlock(block);
 
         recognizer.m_Pos.m_Height = h;
@@ -1747,6 +1751,152 @@ namespace beam::wallet
         ++m_BlocksDone;
     }
 
+    struct Wallet::BodyScanTask
+        :public Executor::TaskSync
+    {
+        struct Entry
+        {
+            Block::Body m_Body;
+            std::vector<const TxKernelShieldedOutput*> m_vShielded; // tickets recognized
+        };
+
+        const std::vector<proto::BodyBuffers>* m_pBodies;
+        Height m_h0;
+        const NodeProcessor::Account* m_pAcc;
+        std::vector<Entry> m_vRes;
+        std::vector<uint8_t> m_vFail; // per thread
+
+        void Exec(Executor::Context& ctx) override
+        {
+            uint32_t i0, nCount;
+            ctx.get_Portion(i0, nCount, static_cast<uint32_t>(m_vRes.size()));
+
+            try
+            {
+                for (uint32_t i = 0; i < nCount; i++)
+                    Scan(i0 + i);
+            }
+            catch (const std::exception&)
+            {
+                m_vFail[ctx.m_iThread] = 1;
+            }
+        }
+
+        void Scan(uint32_t i)
+        {
+            Height h = m_h0 + i;
+            auto& e = m_vRes[i];
+            DecodeBody((*m_pBodies)[i], h, e.m_Body);
+
+            // drop the outputs that are not ours. The remaining are recovered again by the recognizer
+            auto& vOuts = e.m_Body.m_vOutputs;
+            vOuts.erase(std::remove_if(vOuts.begin(), vOuts.end(), [this, h](const Output::Ptr& pOutp)
+            {
+                CoinID cid;
+                return !pOutp->Recover(h, *m_pAcc->m_pOwner, cid);
+            }), vOuts.end());
+
+            if (!m_pAcc->m_vSh.empty())
+                ScanKernels(e, e.m_Body.m_vKernels);
+        }
+
+        void ScanKernels(Entry& e, const std::vector<TxKernel::Ptr>& vKrn)
+        {
+            for (const auto& pKrn : vKrn)
+            {
+                if (TxKernel::Subtype::ShieldedOutput == pKrn->get_Subtype())
+                {
+                    const auto& krn = Cast::Up<TxKernelShieldedOutput>(*pKrn);
+
+                    for (const auto& vwr : m_pAcc->m_vSh)
+                    {
+                        ShieldedTxo::Data::TicketParams tp;
+                        if (tp.Recover(krn.m_Txo.m_Ticket, vwr))
+                        {
+                            e.m_vShielded.push_back(&krn);
+                            break;
+                        }
+                    }
+                }
+
+                ScanKernels(e, pKrn->m_vNested);
+            }
+        }
+    };
+
+    void Wallet::ProcessBodyPack(const std::vector<proto::BodyBuffers>& vBodies, Height h0, NodeProcessor::Recognizer& recognizer)
+    {
+        if (vBodies.empty())
+            return;
+
+        if (!m_BodyScanStart_ms)
+        {
+            m_BodyScanStart_ms = GetTime_ms();
+            m_BodyScanBlocks0 = m_BlocksDone;
+        }
+
+        // Decoding and trial recovery are context-free, do them in parallel for the whole pack.
+        // Events are then generated serially, in the height order
+        if (!m_pBodyScanExecutor)
+            m_pBodyScanExecutor = std::make_unique<ExecutorMT_R>();
+
+        BodyScanTask t;
+        t.m_pBodies = &vBodies;
+        t.m_h0 = h0;
+        t.m_pAcc = recognizer.m_Handler.m_pAccount;
+        t.m_vRes.resize(vBodies.size());
+        t.m_vFail.resize(m_pBodyScanExecutor->get_Threads());
+
+        m_pBodyScanExecutor->ExecAll(t);
+
+        for (auto bFail : t.m_vFail)
+            if (bFail)
+                throw std::runtime_error("body decode failed");
+
+        std::set<const TxKernelShieldedOutput*> setShielded;
+        recognizer.m_pShieldedCandidates = &setShielded;
+
+        for (size_t i = 0; i < t.m_vRes.size(); i++)
+        {
+            auto& e = t.m_vRes[i];
+            Height h = h0 + i;
+
+            PreprocessBlock(e.m_Body);
+
+            setShielded.clear();
+            setShielded.insert(e.m_vShielded.begin(), e.m_vShielded.end());
+
+            recognizer.m_Pos.m_Height = h;
+            recognizer.RecognizeBlock(e.m_Body, 0, false);
+            SetEventsHeight(h);
+            ++m_BlocksDone;
+        }
+
+        recognizer.m_pShieldedCandidates = nullptr;
+    }
+
+    void Wallet::ReportBodyScanProgress()
+    {
+        if (!m_BodyScanStart_ms)
+            return;
+
+        uint32_t dt_ms = GetTime_ms() - m_BodyScanStart_ms;
+        if (!dt_ms)
+            return;
+
+        uint64_t nDone = m_BlocksDone - m_BodyScanBlocks0;
+        uint32_t nRate = static_cast<uint32_t>(nDone * 1000 / dt_ms);
+
+        uint64_t eta_s = 0;
+        if (nRate && (m_RequestedBlocks > m_BlocksDone))
+            eta_s = (m_RequestedBlocks - m_BlocksDone) / nRate;
+
+        BEAM_LOG_INFO() << "Scanning blocks: " << nRate << " blocks/s, ETA " << eta_s << " s";
+
+        for (const auto sub : m_subscribers)
+            sub->onBodyScanProgress(nRate, eta_s);
+    }
+
     void Wallet::PreprocessBlock(TxVectors::Full& block)
     {
         // In this method we emulate work performed by NodeProcessor::HandleValidatedBlock
@@ -2364,6 +2514,7 @@ namespace beam::wallet
         m_LastSyncTotal = 0;
         m_RequestedBlocks = 0;
         m_BlocksDone = 0;
+        m_BodyScanStart_ms = 0;
 
         SaveKnownState();
     }
@@ -2392,6 +2543,7 @@ namespace beam::wallet
         if (!actionQueue.empty())
         {
             AsyncContextHolder async(*this);
+            IWalletDB::WriteBatch batch(*m_WalletDB); // all the resumed transactions are updated in a single db transaction
             while (!actionQueue.empty())
             {
                 auto& action = actionQueue.front();
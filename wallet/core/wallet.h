@@ -83,6 +83,11 @@ namespace beam::wallet
         // @param total - number of total tasks
         virtual void onSyncProgress(int done, int total) {}
 
+        // Callback for trustless (body-scan) sync speed
+        // @param blocksPerSec - average scan rate
+        // @param eta_s - estimated time remaining, in seconds
+        virtual void onBodyScanProgress(uint32_t blocksPerSec, uint64_t eta_s) {}
+
         // Callback for wallet own(trusted) node connection
         // @param id - connected node peer id
         // @param connected - true if node has connected otherwise false
@@ -277,6 +282,9 @@ namespace beam::wallet
         void UpdateOnNextTip(BaseTransaction::Ptr tx);
         void SaveKnownState();
         void ProcessBody(const proto::BodyBuffers& b, Height h, NodeProcessor::Recognizer& recoginzer);
+        static void DecodeBody(const proto::BodyBuffers& b, Height h, Block::Body& block);
+        void ProcessBodyPack(const std::vector<proto::BodyBuffers>& vBodies, Height h0, NodeProcessor::Recognizer& recognizer);
+        void ReportBodyScanProgress();
         void PreprocessBlock(TxVectors::Full& block);
         void RequestBodies();
         void RequestTreasury();
@@ -543,6 +551,8 @@ namespace beam::wallet
         size_t m_LastSyncTotal;
         size_t m_RequestedBlocks = 0;
         size_t m_BlocksDone = 0;
+        uint32_t m_BodyScanStart_ms = 0;
+        size_t m_BodyScanBlocks0 = 0;
         uint32_t m_OwnedNodesOnline;
 
         std::vector<IWalletObserver*> m_subscribers;
@@ -558,6 +568,8 @@ namespace beam::wallet
         bool m_IsTreasuryHandled = false;
         std::map<ECC::Point, Height> m_Commitments;
         bool m_IsCommitmentsCached = false;
+        struct BodyScanTask;
+        std::unique_ptr<ExecutorMT_R> m_pBodyScanExecutor; // trial recovery during the body-scan sync
 
         // the queue of actions to be performed after wallet synchronization
         using ActionQueue = std::queue<OnSyncAction>;
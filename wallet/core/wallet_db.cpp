@@ -41,7 +41,9 @@ namespace fs = std::filesystem;
 #include "core/uintBig.h"
 #include "utility/test_helpers.h"
 #include <queue>
+#include <list>
 #include <unordered_map>
+#include <string_view>
 #include <boost/algorithm/string.hpp>
 
 #include "base_transaction.h"
@@ -590,6 +592,67 @@ namespace beam::wallet
 
     namespace sqlite
     {
+        // LRU cache of the prepared statements of a connection, keyed by the SQL text.
+        // Statements are taken out of the cache while in use, so that the same request may be nested
+        struct StatementCache
+        {
+            static const size_t s_MaxSize = 256;
+
+            typedef std::list<std::pair<std::string, sqlite3_stmt*> > List;
+            List m_Lru; // most recently used first
+            std::unordered_map<std::string_view, List::iterator> m_Map; // keys point to the list strings
+
+            ~StatementCache()
+            {
+                Clear();
+            }
+
+            sqlite3_stmt* Take(const char* sql)
+            {
+                auto it = m_Map.find(sql);
+                if (m_Map.end() == it)
+                    return nullptr;
+
+                auto itL = it->second;
+                sqlite3_stmt* stm = itL->second;
+
+                m_Map.erase(it);
+                m_Lru.erase(itL);
+                return stm;
+            }
+
+            void Put(sqlite3_stmt* stm)
+            {
+                sqlite3_reset(stm);
+                sqlite3_clear_bindings(stm);
+
+                const char* sql = sqlite3_sql(stm);
+                if (!sql || m_Map.count(sql))
+                {
+                    sqlite3_finalize(stm); // nested duplicate
+                    return;
+                }
+
+                m_Lru.emplace_front(sql, stm);
+                m_Map.emplace(m_Lru.front().first, m_Lru.begin());
+
+                if (m_Lru.size() > s_MaxSize)
+                {
+                    m_Map.erase(m_Lru.back().first);
+                    sqlite3_finalize(m_Lru.back().second);
+                    m_Lru.pop_back();
+                }
+            }
+
+            void Clear()
+            {
+                m_Map.clear();
+                for (auto& x : m_Lru)
+                    sqlite3_finalize(x.second);
+                m_Lru.clear();
+            }
+        };
+
         struct Statement
         {
             Statement(const WalletDB* db, const char* sql, bool privateDB = false)
@@ -597,8 +660,7 @@ namespace beam::wallet
                 , _db(privateDB ? db->m_PrivateDB : db->_db)
                 , _stm(nullptr)
             {
-                int ret = sqlite3_prepare_v2(_db, sql, -1, &_stm, nullptr);
-                throwIfError(ret, _db);
+                Prepare(*db, sql, privateDB);
             }
 
             Statement(WalletDB* db, const char* sql, bool privateDB = false)
@@ -610,8 +672,7 @@ namespace beam::wallet
                 {
                     _walletDB->onPrepareToModify();
                 }
-                int ret = sqlite3_prepare_v2(_db, sql, -1, &_stm, nullptr);
-                throwIfError(ret, _db);
+                Prepare(*db, sql, privateDB);
             }
 
             void Reset()
@@ -954,12 +1015,29 @@ namespace beam::wallet
 
             ~Statement()
             {
-                sqlite3_finalize(_stm);
+                if (_cache && _stm)
+                    _cache->Put(_stm);
+                else
+                    sqlite3_finalize(_stm);
             }
         private:
+            void Prepare(const WalletDB& db, const char* sql, bool privateDB)
+            {
+                _cache = (privateDB && (db.m_PrivateDB != db._db)) ? db.m_pPrivateStmCache.get() : db.m_pStmCache.get();
+                if (_cache)
+                    _stm = _cache->Take(sql);
+
+                if (!_stm)
+                {
+                    int ret = sqlite3_prepare_v2(_db, sql, -1, &_stm, nullptr);
+                    throwIfError(ret, _db);
+                }
+            }
+
             WalletDB* _walletDB;
             sqlite3 * _db;
             sqlite3_stmt* _stm;
+            StatementCache* _cache = nullptr;
             std::vector<ByteBuffer> _buffers;
         };
 
@@ -2703,6 +2781,10 @@ namespace beam::wallet
             TxParameterID::TransactionType,
             TxParameterID::CreateTime}
     {
+        m_pStmCache = std::make_unique<sqlite::StatementCache>();
+        if (m_PrivateDB != _db)
+            m_pPrivateStmCache = std::make_unique<sqlite::StatementCache>();
+
         if (m_Initialized && !storage::getVar(*this, LAST_READ_IM_ID, m_lastReadIMId))
             m_lastReadIMId = 0;
     }
@@ -2723,6 +2805,10 @@ namespace beam::wallet
                 }
                 m_DbTransaction.reset();
             }
+            // cached statements must be finalized before closing
+            m_pStmCache.reset();
+            m_pPrivateStmCache.reset();
+
             BEAM_VERIFY(SQLITE_OK == sqlite3_close(_db));
             if (m_PrivateDB && _db != m_PrivateDB)
             {
@@ -2896,6 +2982,11 @@ namespace beam::wallet
 	}
 
 	bool IWalletDB::ImportRecovery(const std::string& path, INegotiatorGateway& gateway, IRecoveryProgress& prog)
+	{
+		return ImportRecovery(path, {}, gateway, prog);
+	}
+
+	bool IWalletDB::ImportRecovery(const std::string& path, const std::vector<std::string>& vDeltas, INegotiatorGateway& gateway, IRecoveryProgress& prog)
 	{
         struct MyParser
             :public RecoveryInfo::IRecognizer
@@ -2959,6 +3050,36 @@ namespace beam::wallet
                 return true;
             }
 
+            bool OnUtxoSpentRecognized(Height h, const CoinID& cid, const UtxoTree::Key::Data& d) override
+            {
+                // reported by the deltas only
+                Coin c;
+                c.m_ID = cid;
+                if (!m_This.findCoin(c))
+                    return true; // was filtered-out
+
+                std::setmin(c.m_spentHeight, h);
+
+                BEAM_LOG_INFO() << "CoinID: " << c.m_ID << " Spent, Height=" << h;
+
+                m_This.saveCoin(c);
+
+                proto::Event::Utxo evt;
+                evt.m_Flags = 0;
+                evt.m_Cid = cid;
+                evt.m_Commitment = d.m_Commitment;
+                evt.m_Maturity = d.m_Maturity;
+
+                Serializer ser;
+                ser & evt.s_Type;
+                ser & evt;
+
+                const NodeProcessor::EventKey::Utxo& key = d.m_Commitment;
+                m_This.insertEvent(h, Blob(ser.buffer().first, static_cast<uint32_t>(ser.buffer().second)), Blob(&key, sizeof(NodeProcessor::EventKey::Utxo)));
+
+                return true;
+            }
+
             typedef std::map<ECC::Point, ShieldedTxo::BaseKey> ShieldedSpendKeyMap;
             ShieldedSpendKeyMap m_mapShielded;
 
@@ -3022,7 +3143,11 @@ namespace beam::wallet
         MyParser p(*this, gateway, prog);
         p.Init(get_OwnerKdf());
 
-        if (p.Proceed(path.c_str()))
+        // trial recovery is done in parallel, the recognized coins are still reported in order
+        ExecutorMT_R ex;
+        Executor::Scope scope(ex);
+
+        if (p.Proceed(path.c_str(), vDeltas))
         {
             storage::setTreasuryHandled(*this, true);
             set_ShieldedOuts(p.m_ShieldedOuts);
@@ -5827,6 +5952,9 @@ namespace beam::wallet
     void WalletDB::onFlushTimer()
     {
         m_IsFlushPending = false;
+        if (m_WriteBatch)
+            return; // the timer is restarted at the end of the batch
+
         if (m_DbTransaction)
         {
             m_DbTransaction->commit();
@@ -5851,6 +5979,22 @@ namespace beam::wallet
         }
     }
 
+    void WalletDB::BeginWriteBatch()
+    {
+        m_WriteBatch++;
+    }
+
+    void WalletDB::EndWriteBatch()
+    {
+        assert(m_WriteBatch);
+        if (--m_WriteBatch)
+            return;
+
+        // don't commit here (nor throw from the batch destructor). The flush timer commits all the modifications at once on its next tick
+        if (m_DbTransaction)
+            onModified();
+    }
+
     void WalletDB::notifyCoinsChanged(ChangeAction action, const vector<Coin>& items)
     {
         if (items.empty() && action != ChangeAction::Reset)
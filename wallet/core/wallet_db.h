@@ -480,6 +480,8 @@ namespace beam::wallet
 
 		// returns false if callback asked to stop verification.
 		bool ImportRecovery(const std::string& path, INegotiatorGateway& gateway, IRecoveryProgress&);
+		// the delta files are applied in order on top of the full one
+		bool ImportRecovery(const std::string& path, const std::vector<std::string>& vDeltas, INegotiatorGateway& gateway, IRecoveryProgress&);
 
         // Allocates new Key ID, used for generation of the blinding factor
         // Will return the next id starting from a random base created during wallet initialization
@@ -652,6 +654,17 @@ namespace beam::wallet
         virtual void set_AppData(const Blob& name, const Blob&, const Blob*) {}
         virtual void ClearAppData(const Blob& name) {}
 
+        // Write batching (group commit). Modifications made within the outermost scope are never split: the flush timer doesn't commit while it's active, and commits them together with the rest on its next tick
+        virtual void BeginWriteBatch() {}
+        virtual void EndWriteBatch() {}
+
+        struct WriteBatch
+        {
+            IWalletDB& m_DB;
+            WriteBatch(IWalletDB& db) :m_DB(db) { m_DB.BeginWriteBatch(); }
+            ~WriteBatch() { m_DB.EndWriteBatch(); }
+        };
+
        private:
            bool get_CommitmentSafe(ECC::Point& comm, const CoinID&, IPrivateKeyKeeper2*);
     };
@@ -659,6 +672,7 @@ namespace beam::wallet
     namespace sqlite
     {
         struct Statement;
+        struct StatementCache;
         struct Transaction;
     }  // namespace sqlite
 
@@ -874,6 +888,8 @@ namespace beam::wallet
         void onModified();
         void onFlushTimer();
         void onPrepareToModify();
+        void BeginWriteBatch() override;
+        void EndWriteBatch() override;
         void MigrateCoins();
         boost::optional<TxDescription> getTxImpl(const TxID& txId, sqlite::Statement& stm) const;
         bool getTxParameterImpl(const TxID& txID, SubTxID subTxID, TxParameterID paramID, ByteBuffer& blob, sqlite::Statement& stm) const;
@@ -909,6 +925,9 @@ namespace beam::wallet
         io::Timer::Ptr m_FlushTimer;
         bool m_IsFlushPending;
         std::unique_ptr<sqlite::Transaction> m_DbTransaction;
+        uint32_t m_WriteBatch = 0; // nesting depth
+        std::unique_ptr<sqlite::StatementCache> m_pStmCache;
+        std::unique_ptr<sqlite::StatementCache> m_pPrivateStmCache; // if the private db is separate
         std::vector<IWalletDbObserver*> m_subscribers;
         const std::set<TxParameterID> m_mandatoryTxParams;
         boost::optional<WalletID> m_widDefaultAddr;
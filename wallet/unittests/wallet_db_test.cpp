@@ -1146,6 +1146,46 @@ void TestTxParameters()
     WALLET_CHECK(p == p2);
 }
 
+void TestTxCreationPerformance()
+{
+    cout << "\nWallet database tx creation benchmark\n";
+    auto db = createSqliteWalletDB();
+
+    const uint32_t nCount = 1000;
+    helpers::StopWatch sw;
+    sw.start();
+
+    for (uint32_t i = 0; i < nCount; ++i)
+    {
+        // roughly what the tx state machine does on creation, within one update
+        IWalletDB::WriteBatch batch(*db);
+
+        TxID txID = { };
+        memcpy(txID.data(), &i, sizeof(i));
+
+        TxDescription tx(txID);
+        tx.m_amount = 1000 + i;
+        tx.m_createTime = 123456 + i;
+        tx.m_minHeight = 134;
+        tx.m_sender = true;
+        tx.m_status = TxStatus::Pending;
+        db->saveTx(tx);
+
+        WALLET_CHECK(storage::setTxParameter(*db, txID, TxParameterID::Status, TxStatus::InProgress, false));
+        WALLET_CHECK(storage::setTxParameter(*db, txID, TxParameterID::Fee, Amount(100), false));
+        WALLET_CHECK(storage::setTxParameter(*db, txID, TxParameterID::MinHeight, Height(134), false));
+        WALLET_CHECK(storage::setTxParameter(*db, txID, TxParameterID::MaxHeight, Height(1134), false));
+
+        Amount amount = 0;
+        WALLET_CHECK(storage::getTxParameter(*db, txID, TxParameterID::Amount, amount) && (amount == 1000 + i));
+    }
+
+    sw.stop();
+    cout << "Created " << nCount << " txs in " << sw.milliseconds() << " ms, " << (nCount * 1000000ULL / std::max<uint64_t>(sw.microseconds(), 1)) << " tx/s\n";
+
+    WALLET_CHECK(db->getTxHistory(TxType::Simple).size() == nCount);
+}
+
 void TestSelect3()
 {
     cout << "\nWallet database coin selection 3 test\n";
@@ -1734,6 +1774,7 @@ int main()
     TestAddresses();
     TestExportImportTx();
     TestTxParameters();
+    TestTxCreationPerformance();
     TestWalletMessages();
     TestNotifications();
     TestExchangeRates();
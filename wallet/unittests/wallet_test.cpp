@@ -3767,6 +3767,18 @@ namespace
         {
             stopReactor();
         }
+
+        void onAddressesChanged(ChangeAction action, const std::vector<WalletAddress>& addresses) override
+        {
+            if (ChangeAction::Added == action)
+            {
+                m_AddressesAdded += addresses.size();
+                m_AddressBatches++;
+            }
+        }
+
+        std::atomic<size_t> m_AddressesAdded{ 0 };
+        std::atomic<size_t> m_AddressBatches{ 0 };
     };
 
     void TestClient()
@@ -3813,6 +3825,10 @@ namespace
         startEvent->post();
 
         mainReactor->run();
+
+        // all the new addresses must be delivered, coalesced into few batches
+        WALLET_CHECK(client.m_AddressesAdded >= 50);
+        WALLET_CHECK(client.m_AddressBatches < client.m_AddressesAdded);
     }
 
     void TestSendingWithWalletID()